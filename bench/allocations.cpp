@@ -0,0 +1,61 @@
+#include "harness.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Counts the heap allocations by replacing the global allocation functions,
+// the array, sized and nothrow forms defer to these ones.
+
+namespace
+{
+	std::atomic<uint64_t> g_allocation_count(0);
+	std::atomic<uint64_t> g_allocated_bytes(0);
+}
+
+void* operator new(size_t size)
+{
+	g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+	g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+	if (void* p = std::malloc(size == 0 ? 1 : size))
+		return p;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+	std::free(p);
+}
+
+namespace bench
+{
+	uint64_t allocation_count()
+	{
+		return g_allocation_count.load(std::memory_order_relaxed);
+	}
+
+	uint64_t allocated_bytes()
+	{
+		return g_allocated_bytes.load(std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,125 @@
+#include "harness.hpp"
+
+#include <json_lite_async.hpp>
+
+// Many slow connections served by one thread: each connection receives a 2 KB message in
+// 64 byte segments and every read suspends until the event loop resumes it, round robin.
+// Buffering the whole message before `Json::parse()` keeps every partial text in memory,
+// `async_parse()` parses each segment as it arrives and keeps only its read buffer.
+// Built when the compiler supports C++20 coroutines.
+
+#ifdef JSON_LITE_ASYNC
+
+#include <cstdio>
+#include <deque>
+
+using json_lite::Json;
+
+namespace
+{
+	const size_t connection_count = 1000;
+	const size_t segment_size = 64;
+
+	// the coroutines waiting for their next segment
+	std::deque<std::coroutine_handle<>> g_ready;
+
+	// a connection delivering its message one segment per resumption
+	struct trickle_source
+	{
+		struct read
+		{
+			bool await_ready() const { return false; }
+			void await_suspend(std::coroutine_handle<> handle) { g_ready.push_back(handle); }
+
+			size_t await_resume()
+			{
+				size_t size = source.text->size() - source.position;
+				if (size > segment_size)
+					size = segment_size;
+				if (size > capacity)
+					size = capacity;
+				source.text->copy(data, size, source.position);
+				source.position += size;
+				return size;
+			}
+
+			trickle_source& source;
+			char* data;
+			size_t capacity;
+		};
+
+		read async_read_some(char* data, size_t size) { return read{ *this, data, size }; }
+
+		const std::string* text;
+		size_t position;
+	};
+
+	// read the whole message, then parse it
+	json_lite::async_task<json_lite::parse_result> buffer_and_parse(trickle_source& source, Json& out)
+	{
+		std::string text;
+		char buffer[512];
+		while (const size_t size = co_await source.async_read_some(buffer, sizeof(buffer)))
+			text.append(buffer, size);
+		co_return Json::parse(text.data(), text.data() + text.size(), out);
+	}
+
+	std::string make_message(size_t i)
+	{
+		std::string message = "{\"connection\":" + std::to_string(i) + ",\"readings\":[";
+		for (int j = 0; j < 40; ++j)
+			message += std::string(j ? "," : "") + "{\"channel\":\"channel-" + std::to_string(j) + "\",\"value\":" + std::to_string(i * 0.5 + j) + "}";
+		message += "]}";
+		return message;
+	}
+
+	// serve all the connections with `parse` until every message is parsed
+	template <class Parse>
+	void serve(const std::vector<std::string>& messages, Parse parse)
+	{
+		std::vector<trickle_source> sources(messages.size());
+		std::vector<Json> values(messages.size());
+		std::vector<json_lite::async_task<json_lite::parse_result>> tasks;
+		tasks.reserve(messages.size());
+		for (size_t i = 0; i < messages.size(); ++i)
+		{
+			sources[i] = trickle_source{ &messages[i], 0 };
+			tasks.push_back(parse(sources[i], values[i]));
+			tasks.back().resume();
+		}
+		while (!g_ready.empty())
+		{
+			const std::coroutine_handle<> handle = g_ready.front();
+			g_ready.pop_front();
+			handle.resume();
+		}
+		for (auto& task : tasks)
+			if (!task.done() || !task.get())
+				std::fprintf(stderr, "async: a message was not parsed\n");
+		bench::do_not_optimize(values);
+	}
+}
+
+BENCHMARK_GROUP(async)
+{
+	std::vector<std::string> messages;
+	size_t bytes = 0;
+	for (size_t i = 0; i < connection_count; ++i)
+	{
+		messages.push_back(make_message(i));
+		bytes += messages.back().size();
+	}
+
+	const auto buffered = [](trickle_source& source, Json& out) { return buffer_and_parse(source, out); };
+	const auto incremental = [](trickle_source& source, Json& out) { return json_lite::async_parse(source, out); };
+
+	char text[160];
+	snprintf(text, sizeof(text), "%zu connections, %zu B messages: buffered %zu B of text per connection, async_parse a 512 B buffer",
+		connection_count, messages[0].size(), messages[0].size());
+	ctx.note("async/held while waiting", text);
+
+	ctx.run("async/buffer then Json::parse", bytes, [&]() { serve(messages, buffered); });
+	ctx.run("async/async_parse", bytes, [&]() { serve(messages, incremental); });
+}
+
+#endif
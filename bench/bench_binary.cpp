@@ -0,0 +1,71 @@
+#include "harness.hpp"
+
+#include <json_lite.hpp>
+
+#include <cstdio>
+
+using json_lite::Json;
+
+// Binary formats compared with text dump/parse on the same documents.
+
+BENCHMARK_GROUP(binary)
+{
+	for (const bench::document& doc : bench::corpus())
+	{
+		Json json;
+		if (!Json::parse(doc.text, json))
+			continue;
+
+		const std::string text = json.dump();
+		const std::string msgpack = json.to_msgpack();
+		const std::string cbor = json.to_cbor();
+		ctx.note("size/" + doc.name, "dump " + std::to_string(text.size()) + " B, msgpack " + std::to_string(msgpack.size()) +
+			" B, cbor " + std::to_string(cbor.size()) + " B");
+
+		ctx.run("msgpack/encode/" + doc.name, msgpack.size(), [&]() {
+			std::string str = json.to_msgpack();
+			bench::do_not_optimize(str);
+		});
+		ctx.run("msgpack/decode/" + doc.name, msgpack.size(), [&]() {
+			Json decoded = Json::from_msgpack(msgpack.data(), msgpack.data() + msgpack.size());
+			bench::do_not_optimize(decoded);
+		});
+		ctx.run("cbor/encode/" + doc.name, cbor.size(), [&]() {
+			std::string str = json.to_cbor();
+			bench::do_not_optimize(str);
+		});
+		ctx.run("cbor/decode/" + doc.name, cbor.size(), [&]() {
+			Json decoded = Json::from_cbor(cbor.data(), cbor.data() + cbor.size());
+			bench::do_not_optimize(decoded);
+		});
+	}
+}
+
+BENCHMARK_GROUP(snapshot)
+{
+	const char* path = "json_lite_bench.snap";
+	for (const bench::document& doc : bench::corpus())
+	{
+		Json json;
+		if (!Json::parse(doc.text, json))
+			continue;
+		if (!ctx.enabled("snapshot/load/" + doc.name) && !ctx.enabled("snapshot/reparse/" + doc.name))
+			continue;
+		if (!json_lite::save_snapshot(json, path))
+		{
+			ctx.note("snapshot/" + doc.name, "skipped: cannot write " + std::string(path));
+			continue;
+		}
+
+		// startup: from nothing to the first value of the document
+		ctx.run("snapshot/load/" + doc.name, 0, [&]() {
+			json_lite::snapshot snap(path);
+			bench::do_not_optimize(snap.root().type());
+		});
+		ctx.run("snapshot/reparse/" + doc.name, doc.text.size(), [&]() {
+			Json parsed = Json::parse(doc.text);
+			bench::do_not_optimize(parsed.type());
+		});
+	}
+	remove(path);
+}
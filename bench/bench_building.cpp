@@ -0,0 +1,146 @@
+#include "harness.hpp"
+
+#include <json_lite.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+
+using json_lite::Json;
+
+// Building documents in code: the allocations of the value constructors (a moved string or
+// container must not be copied) and of the emplace API, and the time to build 100k records
+// with `operator[]` and with `reserve()`/`emplace_back()`/`emplace()`.
+// The group aborts if an allocation count differs from the expected one.
+
+namespace
+{
+	const int record_count = 100000;
+
+	// allocations done by one call of `function`
+	template <class Function>
+	unsigned long long count_allocations(Function function)
+	{
+		const uint64_t before = bench::allocation_count();
+		function();
+		return static_cast<unsigned long long>(bench::allocation_count() - before);
+	}
+
+	struct allocation_check
+	{
+		const char* name;
+		unsigned long long count;
+		unsigned long long expected;
+	};
+
+	std::string record_name(int i)
+	{
+		return "a record with a name too long for the small string optimization " + std::to_string(i);
+	}
+}
+
+BENCHMARK_GROUP(building)
+{
+	// each value is constructed once: moving it into a `Json` allocates nothing
+	std::string strings[3] = { std::string(1024, 'a'), std::string(1024, 'b'), std::string(1024, 'c') };
+	std::vector<Json> elements(1000);
+	std::map<std::string, Json> members;
+	members["a"] = Json(true);
+	Json array = Json::make_array();
+	array.reserve(1);
+	Json object = Json::make_object();
+	const allocation_check checks[] = {
+		{ "Json(string&&)", count_allocations([&]() { Json json(std::move(strings[0])); bench::do_not_optimize(json); }), 0 },
+		{ "Json(vector&&)", count_allocations([&]() { Json json(std::move(elements)); bench::do_not_optimize(json); }), 0 },
+		{ "Json(map&&)", count_allocations([&]() { Json json(std::move(members)); bench::do_not_optimize(json); }), 0 },
+		{ "emplace_back(string&&)", count_allocations([&]() { array.emplace_back(std::move(strings[1])); }), 0 },
+		{ "emplace(key, string&&)", count_allocations([&]() { object.emplace("key", std::move(strings[2])); }), 1 }, // the map node
+	};
+	std::string note;
+	for (const allocation_check& check : checks)
+	{
+		// a regression, not a measurement: stop instead of printing a number nobody reads
+		if (check.count != check.expected)
+		{
+			std::fprintf(stderr, "building/allocations: %s made %llu allocations, expected %llu\n", check.name, check.count, check.expected);
+			std::abort();
+		}
+		note += (note.empty() ? "" : ", ") + std::string(check.name) + " " + std::to_string(check.count);
+	}
+	ctx.note("building/allocations", note);
+
+	std::vector<std::string> names;
+	for (int i = 0; i < record_count; ++i)
+		names.push_back(record_name(i));
+
+	ctx.run("building/operator[]", 0, [&]() {
+		Json json;
+		for (int i = 0; i < record_count; ++i)
+		{
+			Json& item = json[i];
+			item["id"] = Json(static_cast<Json::Int>(i));
+			item["name"] = Json(names[i]);
+			item["value"] = Json(i * 0.5);
+		}
+		bench::do_not_optimize(json);
+	});
+	ctx.run("building/push_back", 0, [&]() {
+		Json json;
+		for (int i = 0; i < record_count; ++i)
+		{
+			Json item;
+			item["id"] = Json(static_cast<Json::Int>(i));
+			item["name"] = Json(names[i]);
+			item["value"] = Json(i * 0.5);
+			json.push_back(std::move(item));
+		}
+		bench::do_not_optimize(json);
+	});
+	ctx.run("building/reserve and emplace", 0, [&]() {
+		Json json;
+		json.reserve(record_count);
+		for (int i = 0; i < record_count; ++i)
+		{
+			Json& item = json.emplace_back(Json::make_object_t());
+			item.emplace("id", static_cast<Json::Int>(i));
+			item.emplace("name", names[i]);
+			item.emplace("value", i * 0.5);
+		}
+		bench::do_not_optimize(json);
+	});
+}
+
+// The steady state of a loop that handles messages of the same shape: reparsing into the same
+// `Json` with `parse_options::recycle` reuses its strings, elements and members, and assigning
+// a value of the same type reuses its storage.
+BENCHMARK_GROUP(recycle)
+{
+	std::vector<std::string> messages;
+	for (int i = 0; i < 64; ++i)
+	{
+		std::string message = "{\"device\":\"sensor-" + std::to_string(i % 7) + "-with-a-long-identifier\",\"sequence\":" + std::to_string(i) +
+			",\"status\":{\"battery\":" + std::to_string(90 - i % 10) + ",\"state\":\"" + (i % 2 ? "running" : "idle-and-waiting-for-work") + "\"},\"readings\":[";
+		for (int j = 0; j < 20; ++j)
+			message += (j ? "," : "") + std::string("{\"name\":\"channel number ") + std::to_string(j) + "\",\"value\":" + std::to_string(i * 0.5 + j) + "}";
+		message += "]}";
+		messages.push_back(message);
+	}
+
+	size_t next = 0;
+	Json json;
+	const auto reparse = [&](const json_lite::parse_options& options) {
+		const std::string& message = messages[next++ % messages.size()];
+		Json::parse(message.data(), message.data() + message.size(), json, options);
+		bench::do_not_optimize(json);
+	};
+	json_lite::parse_options recycle;
+	recycle.recycle = true;
+	ctx.run("recycle/parse into the same Json", messages[0].size(), [&]() { reparse(json_lite::parse_options()); });
+	ctx.run("recycle/parse into the same Json, recycle", messages[0].size(), [&]() { reparse(recycle); });
+
+	const Json source = Json::parse(messages[0]);
+	Json copy = source;
+	ctx.run("recycle/copy assignment to the same shape", 0, [&]() {
+		copy = source;
+		bench::do_not_optimize(copy);
+	});
+}
@@ -0,0 +1,305 @@
+#include "harness.hpp"
+
+#include <json_lite.hpp>
+
+#include <cstdio>
+#include <utility>
+
+using json_lite::Json;
+using json_lite::json_data_type;
+
+namespace
+{
+	// parse a corpus document, returns false (and reports it) if json_lite cannot parse it
+	bool parse_document(bench::context& ctx, const bench::document& doc, Json& json)
+	{
+		const json_lite::parse_result result = Json::parse(doc.text, json);
+		if (!result)
+			ctx.note(doc.name, std::string("skipped: ") + json_lite::to_string(result.error) +
+				" at " + std::to_string(result.line) + ":" + std::to_string(result.column));
+		return result.ok();
+	}
+
+	// collects the objects/keys and the arrays of a document for the access benchmarks
+	void collect(const Json& json, std::vector<std::pair<const Json*, const std::string*>>& members, std::vector<const Json*>& arrays)
+	{
+		if (json.is(json_data_type::object))
+		{
+			for (const auto& pair : json.as_object())
+			{
+				members.emplace_back(&json, &pair.first);
+				collect(pair.second, members, arrays);
+			}
+		}
+		else if (json.is(json_data_type::array))
+		{
+			arrays.push_back(&json);
+			for (const Json& value : json.as_array())
+				collect(value, members, arrays);
+		}
+	}
+
+	// canada and a list of 20000 GeoJSON-like points
+	const std::vector<bench::document>& numeric_documents()
+	{
+		static std::vector<bench::document> documents;
+		if (documents.empty())
+		{
+			std::string points = "[";
+			for (int i = 0; i < 20000; ++i)
+				points += (i != 0 ? ",[" : "[") + std::to_string(i % 360 - 180) + ".25," + std::to_string(i % 180 - 90) + ".5]";
+			points += "]";
+			documents.push_back(bench::corpus()[1]);
+			documents.push_back({ "points", points });
+		}
+		return documents;
+	}
+
+	// sum of the floating point numbers in arrays, generic or packed
+	double sum_numbers(const Json& json)
+	{
+		double sum = 0;
+		if (json.is(json_data_type::floating_point_array))
+		{
+			for (double value : json.floating_points())
+				sum += value;
+		}
+		else if (json.is(json_data_type::array))
+		{
+			for (const Json& value : json.as_array())
+				sum += value.is(json_data_type::floating_point) ? value.get<json_data_type::floating_point>() : sum_numbers(value);
+		}
+		else if (json.is(json_data_type::object))
+		{
+			for (const auto& pair : json.as_object())
+				sum += sum_numbers(pair.second);
+		}
+		return sum;
+	}
+
+	// an array of `count` strings of `length` bytes, one byte in `escape_every` needs escaping (0 for none)
+	Json make_strings(size_t count, size_t length, size_t escape_every)
+	{
+		static const char text[] = "The quick brown fox jumps over the lazy dog, sensor values are streamed to the network. ";
+		Json json = Json::make_array();
+		std::vector<Json>& array = json.get<json_data_type::array>();
+		size_t n = 0;
+		for (size_t i = 0; i < count; ++i)
+		{
+			std::string str;
+			for (size_t j = 0; j < length; ++j, ++n)
+				str += escape_every != 0 && n % escape_every == escape_every - 1 ? (n % 2 ? '\n' : '"') : text[n % (sizeof(text) - 1)];
+			array.push_back(Json(std::move(str)));
+		}
+		return json;
+	}
+}
+
+BENCHMARK_GROUP(parse)
+{
+	for (const bench::document& doc : bench::corpus())
+	{
+		Json json;
+		if (!parse_document(ctx, doc, json))
+			continue;
+		ctx.run("parse/" + doc.name, doc.text.size(), [&]() {
+			Json parsed = Json::parse(doc.text);
+			bench::do_not_optimize(parsed);
+		});
+	}
+
+	// the explicit parse stack with limits on the deep document
+	const bench::document& deep = bench::corpus()[3];
+	json_lite::parse_limits limits;
+	limits.max_depth = 10000;
+	ctx.run("parse/" + deep.name + "/limits", deep.text.size(), [&]() {
+		Json parsed;
+		Json::parse(deep.text.data(), deep.text.data() + deep.text.size(), parsed, limits);
+		bench::do_not_optimize(parsed);
+	});
+}
+
+// Short arrays (coordinates, tuples) dominate GeoJSON: the allocations per array show how
+// the array storage is sized while parsing, 1 per non empty array is the minimum.
+BENCHMARK_GROUP(arrays)
+{
+	for (const bench::document& doc : numeric_documents())
+	{
+		const std::string name = "arrays/parse/" + doc.name;
+		Json json;
+		if (!ctx.enabled(name) || !parse_document(ctx, doc, json))
+			continue;
+
+		std::vector<std::pair<const Json*, const std::string*>> members;
+		std::vector<const Json*> arrays;
+		collect(json, members, arrays);
+
+		const uint64_t before = bench::allocation_count();
+		{
+			Json parsed = Json::parse(doc.text);
+			bench::do_not_optimize(parsed);
+		}
+		const uint64_t allocations = bench::allocation_count() - before;
+		char text[128];
+		snprintf(text, sizeof(text), "%zu arrays, %llu allocations per parse (%.2f per array)",
+			arrays.size(), static_cast<unsigned long long>(allocations), double(allocations) / arrays.size());
+		ctx.note(name, text);
+
+		ctx.run(name, doc.text.size(), [&]() {
+			Json parsed = Json::parse(doc.text);
+			bench::do_not_optimize(parsed);
+		});
+	}
+}
+
+// Packed numeric arrays: memory (bytes/op of the parse) and numeric processing
+BENCHMARK_GROUP(packed)
+{
+	json_lite::parse_options options;
+	options.pack_numeric_arrays = true;
+	for (const bench::document& doc : numeric_documents())
+	{
+		Json generic;
+		if (!ctx.enabled("packed/" + doc.name) || !parse_document(ctx, doc, generic))
+			continue;
+		const Json packed = Json::parse(doc.text.data(), doc.text.data() + doc.text.size(), options);
+
+		ctx.run("packed/parse/" + doc.name, doc.text.size(), [&]() {
+			Json parsed;
+			Json::parse(doc.text.data(), doc.text.data() + doc.text.size(), parsed, options);
+			bench::do_not_optimize(parsed);
+		});
+		ctx.run("packed/sum/" + doc.name + "/generic", 0, [&]() {
+			bench::do_not_optimize(sum_numbers(generic));
+		});
+		ctx.run("packed/sum/" + doc.name + "/packed", 0, [&]() {
+			bench::do_not_optimize(sum_numbers(packed));
+		});
+	}
+}
+
+// Numbers forwarded without being read: parse and dump, converting the numbers both ways or keeping
+// their text (`parse_options::raw_numbers`), which also keeps all their digits in the output
+BENCHMARK_GROUP(raw_numbers)
+{
+	json_lite::parse_options raw;
+	raw.raw_numbers = true;
+	for (const bench::document& doc : numeric_documents())
+	{
+		Json json;
+		if (!ctx.enabled("raw_numbers/" + doc.name) || !parse_document(ctx, doc, json))
+			continue;
+
+		ctx.run("raw_numbers/forward/" + doc.name + "/converted", doc.text.size(), [&]() {
+			Json parsed;
+			Json::parse(doc.text.data(), doc.text.data() + doc.text.size(), parsed);
+			bench::do_not_optimize(parsed.dump());
+		});
+		ctx.run("raw_numbers/forward/" + doc.name + "/raw", doc.text.size(), [&]() {
+			Json parsed;
+			Json::parse(doc.text.data(), doc.text.data() + doc.text.size(), parsed, raw);
+			bench::do_not_optimize(parsed.dump());
+		});
+	}
+}
+
+// String-heavy documents: the time is mostly spent scanning the strings for the bytes to escape
+BENCHMARK_GROUP(dump)
+{
+	for (const bench::document& doc : bench::corpus())
+	{
+		Json json;
+		if (!parse_document(ctx, doc, json))
+			continue;
+		const size_t size = json.dump().size();
+		ctx.run("dump/" + doc.name, size, [&]() {
+			std::string str = json.dump();
+			bench::do_not_optimize(str);
+		});
+	}
+
+	struct strings_case
+	{
+		const char* name;
+		size_t count;
+		size_t length;
+		size_t escape_every;
+	};
+	const strings_case cases[] = {
+		{ "dump/strings/short (16 B)", 200000, 16, 0 },
+		{ "dump/strings/long (4 KB)", 1000, 4096, 0 },
+		{ "dump/strings/long (4 KB), 1% escaped", 1000, 4096, 100 },
+	};
+	for (const strings_case& c : cases)
+	{
+		const Json json = make_strings(c.count, c.length, c.escape_every);
+		const size_t size = json.dump().size();
+		ctx.run(c.name, size, [&]() {
+			std::string str = json.dump();
+			bench::do_not_optimize(str);
+		});
+	}
+}
+
+BENCHMARK_GROUP(access)
+{
+	for (const bench::document& doc : bench::corpus())
+	{
+		Json parsed;
+		if (!parse_document(ctx, doc, parsed))
+			continue;
+		const Json& json = parsed;
+
+		std::vector<std::pair<const Json*, const std::string*>> members;
+		std::vector<const Json*> arrays;
+		collect(json, members, arrays);
+
+		if (!members.empty())
+			ctx.run("access/object/" + doc.name + " (" + std::to_string(members.size()) + " lookups)", 0, [&]() {
+				size_t sum = 0;
+				for (const auto& member : members)
+					sum += static_cast<size_t>((*member.first)[*member.second].data_type());
+				bench::do_not_optimize(sum);
+			});
+
+		size_t elements = 0;
+		for (const Json* array : arrays)
+			elements += array->as_array().size();
+		if (elements != 0)
+			ctx.run("access/array/" + doc.name + " (" + std::to_string(elements) + " elements)", 0, [&]() {
+				size_t sum = 0;
+				for (const Json* array : arrays)
+				{
+					const size_t size = array->as_array().size();
+					for (size_t i = 0; i < size; ++i)
+						sum += static_cast<size_t>((*array)[i].data_type());
+				}
+				bench::do_not_optimize(sum);
+			});
+	}
+}
+
+BENCHMARK_GROUP(copy_move)
+{
+	for (const bench::document& doc : bench::corpus())
+	{
+		Json json;
+		if (!parse_document(ctx, doc, json))
+			continue;
+		ctx.run("copy/" + doc.name, doc.text.size(), [&]() {
+			Json copy = json;
+			bench::do_not_optimize(copy);
+		});
+	}
+
+	Json a = Json::parse(bench::corpus()[0].text);
+	Json b;
+	ctx.run("move/document x1000", 0, [&]() {
+		for (int i = 0; i < 500; ++i)
+		{
+			b = std::move(a);
+			a = std::move(b);
+		}
+		bench::do_not_optimize(a);
+	});
+}
@@ -0,0 +1,123 @@
+#include "harness.hpp"
+
+#include <json_lite.hpp>
+
+#include <cstdio>
+
+using json_lite::Json;
+
+// A large array of records summed by parsing the whole document, by parsing one element at a time
+// with `json_cursor::for_each_element()`, by reading the tokens with `json_cursor::next()` and
+// with a `json_query` that parses only the prices and skips the rest of each record.
+// The memory of the whole document is allocated by the parse and stays in use, while the cursor
+// only keeps one element (or one token): its allocations do not depend on the length of the array.
+
+namespace
+{
+	std::string make_records(int count)
+	{
+		std::string text = "[";
+		for (int i = 0; i < count; ++i)
+		{
+			if (i > 0)
+				text += ',';
+			text += "{\"id\":" + std::to_string(i) + ",\"name\":\"item " + std::to_string(i) +
+				"\",\"price\":" + std::to_string(i % 1000) + ".25,\"tags\":[\"json\",\"lite\"],\"active\":" + (i % 3 == 0 ? "true" : "false") + "}";
+		}
+		text += "]";
+		return text;
+	}
+
+	double sum_parsed(const std::string& text)
+	{
+		const Json json = Json::parse(text);
+		double sum = 0;
+		for (const Json& record : json.as_array())
+			sum += record.at("price").get<json_lite::json_data_type::floating_point>();
+		return sum;
+	}
+
+	double sum_elements(const std::string& text)
+	{
+		json_lite::json_cursor cursor(text.data(), text.data() + text.size());
+		double sum = 0;
+		cursor.for_each_element([&sum](Json& record) {
+			sum += record.at("price").get<json_lite::json_data_type::floating_point>();
+		});
+		return sum;
+	}
+
+	double sum_tokens(const std::string& text)
+	{
+		json_lite::json_cursor cursor(text.data(), text.data() + text.size());
+		double sum = 0;
+		bool price = false;
+		for (json_lite::json_token token = cursor.next(); token != json_lite::json_token::end && token != json_lite::json_token::error; token = cursor.next())
+		{
+			if (token == json_lite::json_token::key)
+				price = cursor.depth() == 2 && cursor.string() == "price";
+			else if (token == json_lite::json_token::floating_point && price)
+				sum += cursor.floating_point();
+		}
+		return sum;
+	}
+
+	double sum_query(const std::string& text, const char* expression)
+	{
+		const json_lite::json_path path(expression);
+		json_lite::json_cursor cursor(text.data(), text.data() + text.size());
+		json_lite::json_query query(path, cursor);
+		double sum = 0;
+		query.for_each([&sum](Json& price) {
+			sum += price.get<json_lite::json_data_type::floating_point>();
+		});
+		return sum;
+	}
+
+	double sum_query_child(const std::string& text)
+	{
+		return sum_query(text, "$[*].price");
+	}
+
+	// allocated bytes of one call
+	template <class Function>
+	unsigned long long measure_bytes(Function function, const std::string& text)
+	{
+		const uint64_t before = bench::allocated_bytes();
+		bench::do_not_optimize(function(text));
+		return static_cast<unsigned long long>(bench::allocated_bytes() - before);
+	}
+}
+
+BENCHMARK_GROUP(cursor)
+{
+	const std::string small = make_records(10000);
+	const std::string large = make_records(100000);
+
+	char text[160];
+	snprintf(text, sizeof(text), "10k records: %llu bytes, 100k records: %llu bytes",
+		measure_bytes(sum_parsed, small), measure_bytes(sum_parsed, large));
+	ctx.note("cursor/parse allocated", text);
+	snprintf(text, sizeof(text), "10k records: %llu bytes, 100k records: %llu bytes",
+		measure_bytes(sum_tokens, small), measure_bytes(sum_tokens, large));
+	ctx.note("cursor/next allocated", text);
+	snprintf(text, sizeof(text), "10k records: %llu bytes, 100k records: %llu bytes",
+		measure_bytes(sum_query_child, small), measure_bytes(sum_query_child, large));
+	ctx.note("cursor/json_query allocated", text);
+
+	ctx.run("cursor/parse and iterate", large.size(), [&]() {
+		bench::do_not_optimize(sum_parsed(large));
+	});
+	ctx.run("cursor/for_each_element", large.size(), [&]() {
+		bench::do_not_optimize(sum_elements(large));
+	});
+	ctx.run("cursor/next", large.size(), [&]() {
+		bench::do_not_optimize(sum_tokens(large));
+	});
+	ctx.run("cursor/json_query $[*].price", large.size(), [&]() {
+		bench::do_not_optimize(sum_query(large, "$[*].price"));
+	});
+	ctx.run("cursor/json_query $..price", large.size(), [&]() {
+		bench::do_not_optimize(sum_query(large, "$..price"));
+	});
+}
@@ -0,0 +1,77 @@
+#include "harness.hpp"
+
+#include <json_lite.hpp>
+
+#include <unordered_set>
+
+using json_lite::Json;
+using json_lite::json_data_type;
+
+// Deep equality and hashing against the usual workaround of comparing `dump()` strings:
+// comparing a document with a copy of it, hashing it, and deduplicating messages
+// (the elements of the corpus arrays, each inserted twice) in an unordered set.
+
+namespace
+{
+	// the elements of the largest array of a document, used as messages
+	void largest_array(const Json& json, const std::vector<Json>*& largest)
+	{
+		if (json.is(json_data_type::object))
+		{
+			for (const auto& pair : json.as_object())
+				largest_array(pair.second, largest);
+		}
+		else if (json.is(json_data_type::array))
+		{
+			if (largest == nullptr || json.as_array().size() > largest->size())
+				largest = &json.as_array();
+			for (const Json& value : json.as_array())
+				largest_array(value, largest);
+		}
+	}
+}
+
+BENCHMARK_GROUP(equality)
+{
+	for (const bench::document& doc : bench::corpus())
+	{
+		const std::string name = "equality/" + doc.name;
+		Json json;
+		if (!ctx.enabled(name) || !Json::parse(doc.text, json))
+			continue;
+		const Json copy = json;
+
+		ctx.run(name + "/operator==", doc.text.size(), [&]() {
+			bench::do_not_optimize(json == copy);
+		});
+		ctx.run(name + "/dump() ==", doc.text.size(), [&]() {
+			bench::do_not_optimize(json.dump() == copy.dump());
+		});
+		ctx.run(name + "/hash()", doc.text.size(), [&]() {
+			bench::do_not_optimize(json.hash());
+		});
+		ctx.run(name + "/std::hash(dump())", doc.text.size(), [&]() {
+			bench::do_not_optimize(std::hash<std::string>()(json.dump()));
+		});
+
+		const std::vector<Json>* messages = nullptr;
+		largest_array(json, messages);
+		if (messages == nullptr || messages->size() < 2)
+			continue;
+		const std::string count = " (" + std::to_string(messages->size()) + " messages)";
+		ctx.run(name + "/dedup Json" + count, 0, [&]() {
+			std::unordered_set<Json> seen;
+			for (int twice = 0; twice < 2; ++twice)
+				for (const Json& message : *messages)
+					seen.insert(message);
+			bench::do_not_optimize(seen.size());
+		});
+		ctx.run(name + "/dedup dump()" + count, 0, [&]() {
+			std::unordered_set<std::string> seen;
+			for (int twice = 0; twice < 2; ++twice)
+				for (const Json& message : *messages)
+					seen.insert(message.dump());
+			bench::do_not_optimize(seen.size());
+		});
+	}
+}
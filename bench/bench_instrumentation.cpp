@@ -0,0 +1,53 @@
+#include "harness.hpp"
+
+#include <json_lite.hpp>
+
+using json_lite::Json;
+
+// Prints the library statistics of one parse, dump and copy of each document.
+// Only meaningful when the library is built with the JSON_LITE_INSTRUMENTATION option.
+
+BENCHMARK_GROUP(instrumentation)
+{
+#ifdef JSON_LITE_INSTRUMENTATION
+	for (const bench::document& doc : bench::corpus())
+	{
+		const std::string name = "stats/" + doc.name;
+		if (!ctx.enabled(name))
+			continue;
+
+		json_lite::reset_thread_stats();
+		Json json;
+		if (!Json::parse(doc.text, json))
+			continue;
+		const json_lite::json_stats parse = json_lite::thread_stats();
+
+		json_lite::reset_thread_stats();
+		bench::do_not_optimize(json.dump());
+		const json_lite::json_stats dump = json_lite::thread_stats();
+
+		json_lite::reset_thread_stats();
+		Json copy = json;
+		bench::do_not_optimize(copy);
+		const json_lite::json_stats copy_stats = json_lite::thread_stats();
+
+		ctx.note(name + "/parse",
+			"nodes " + std::to_string(parse.nodes_created) +
+			", copies " + std::to_string(parse.copies) +
+			", moves " + std::to_string(parse.moves) +
+			", bytes " + std::to_string(parse.bytes_allocated) +
+			", map insertions " + std::to_string(parse.map_insertions) +
+			", parse " + std::to_string(parse.parse_ns / 1000) + " us" +
+			" (numbers " + std::to_string(parse.number_ns / 1000) + " us in " + std::to_string(parse.number_calls) + " calls)");
+		ctx.note(name + "/dump",
+			"escapes " + std::to_string(dump.string_escapes) +
+			", dump " + std::to_string(dump.dump_ns / 1000) + " us");
+		ctx.note(name + "/copy",
+			"nodes " + std::to_string(copy_stats.nodes_created) +
+			", copies " + std::to_string(copy_stats.copies) +
+			", bytes " + std::to_string(copy_stats.bytes_allocated));
+	}
+#else
+	ctx.note("stats", "disabled, configure with -DJSON_LITE_INSTRUMENTATION=ON");
+#endif
+}
@@ -0,0 +1,75 @@
+#include "harness.hpp"
+
+#include <json_lite.hpp>
+
+#include <thread>
+
+using json_lite::Json;
+
+// `Json::parse_parallel()` and `Json::dump_parallel()` on a large array of records with an increasing
+// number of threads, the scaling is bounded by the number of hardware threads (reported in the notes).
+
+namespace
+{
+	// about 64 MB of records
+	const std::string& large_document()
+	{
+		static std::string text;
+		if (text.empty())
+		{
+			text = "[";
+			for (int i = 0; text.size() < (64u << 20); ++i)
+				text += std::string(i != 0 ? "," : "") + "{\"id\":" + std::to_string(i) +
+					",\"name\":\"record " + std::to_string(i) + " with a \\\"quoted\\\" [name]\"" +
+					",\"position\":[" + std::to_string(i % 360 - 180) + ".25," + std::to_string(i % 180 - 90) + ".5]" +
+					",\"tags\":[\"a\",\"b,c\",\"{d}\"],\"active\":" + (i % 2 ? "true" : "false") + "}";
+			text += "]";
+		}
+		return text;
+	}
+}
+
+BENCHMARK_GROUP(parallel)
+{
+	const unsigned thread_counts[] = { 1, 2, 4, 8, 16, 32, 64 };
+	bool enabled = ctx.enabled("parallel/parse/sequential") || ctx.enabled("parallel/dump/sequential");
+	for (unsigned threads : thread_counts)
+		enabled = enabled || ctx.enabled("parallel/parse/" + std::to_string(threads) + " threads") ||
+			ctx.enabled("parallel/dump/" + std::to_string(threads) + " threads");
+	if (!enabled)
+		return;
+
+	const std::string& text = large_document();
+	ctx.note("parallel", "hardware threads: " + std::to_string(std::thread::hardware_concurrency()) +
+		", document: " + std::to_string(text.size() >> 20) + " MB");
+
+	ctx.run("parallel/parse/sequential", text.size(), [&]() {
+		Json parsed = Json::parse(text);
+		bench::do_not_optimize(parsed);
+	});
+	for (unsigned threads : thread_counts)
+	{
+		json_lite::parallel_options parallel;
+		parallel.threads = threads;
+		ctx.run("parallel/parse/" + std::to_string(threads) + " threads", text.size(), [&]() {
+			Json parsed = Json::parse_parallel(text.data(), text.data() + text.size(), json_lite::parse_options(), parallel);
+			bench::do_not_optimize(parsed);
+		});
+	}
+
+	const Json json = Json::parse(text);
+	const size_t size = json.dump().size();
+	ctx.run("parallel/dump/sequential", size, [&]() {
+		std::string str = json.dump();
+		bench::do_not_optimize(str);
+	});
+	for (unsigned threads : thread_counts)
+	{
+		json_lite::parallel_options parallel;
+		parallel.threads = threads;
+		ctx.run("parallel/dump/" + std::to_string(threads) + " threads", size, [&]() {
+			std::string str = json.dump_parallel(parallel);
+			bench::do_not_optimize(str);
+		});
+	}
+}
@@ -0,0 +1,63 @@
+#include "harness.hpp"
+
+#include <json_lite.hpp>
+
+using json_lite::Json;
+
+// Many small messages (200 B to 2 KB, the typical request or telemetry payload): the latency of
+// each message with `Json::parse()`, with a reused `json_parser` and with a reused `json_parser`
+// recycling the same `Json`.
+
+namespace
+{
+	// 64 messages of the same shape with `readings` entries each
+	std::vector<std::string> make_messages(int readings)
+	{
+		std::vector<std::string> messages;
+		for (int i = 0; i < 64; ++i)
+		{
+			std::string message = "{\"device\":\"sensor-" + std::to_string(i % 7) + "\",\"sequence\":" + std::to_string(i) +
+				",\"status\":{\"battery\":" + std::to_string(90 - i % 10) + ",\"state\":\"" + (i % 2 ? "running" : "idle") + "\"},\"readings\":[";
+			for (int j = 0; j < readings; ++j)
+				message += std::string(j ? "," : "") + "{\"channel\":" + std::to_string(j) + ",\"value\":" + std::to_string(i * 0.5 + j) + "}";
+			message += "]}";
+			messages.push_back(message);
+		}
+		return messages;
+	}
+}
+
+BENCHMARK_GROUP(messages)
+{
+	for (int readings : { 4, 15, 60 })
+	{
+		const std::vector<std::string> messages = make_messages(readings);
+		const std::string size = std::to_string(messages[0].size()) + " B";
+		size_t next = 0;
+
+		ctx.run("messages/" + size + "/Json::parse", messages[0].size(), [&]() {
+			const std::string& message = messages[next++ % messages.size()];
+			Json json;
+			Json::parse(message.data(), message.data() + message.size(), json);
+			bench::do_not_optimize(json);
+		});
+
+		json_lite::json_parser parser;
+		ctx.run("messages/" + size + "/json_parser", messages[0].size(), [&]() {
+			const std::string& message = messages[next++ % messages.size()];
+			Json json;
+			parser.parse(message.data(), message.data() + message.size(), json);
+			bench::do_not_optimize(json);
+		});
+
+		json_lite::parse_options options;
+		options.recycle = true;
+		json_lite::json_parser recycling_parser(options);
+		Json json;
+		ctx.run("messages/" + size + "/json_parser, recycle", messages[0].size(), [&]() {
+			const std::string& message = messages[next++ % messages.size()];
+			recycling_parser.parse(message.data(), message.data() + message.size(), json);
+			bench::do_not_optimize(json);
+		});
+	}
+}
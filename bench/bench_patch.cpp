@@ -0,0 +1,106 @@
+#include "harness.hpp"
+
+#include <json_lite.hpp>
+
+using json_lite::Json;
+using json_lite::json_data_type;
+
+// JSON Patch on the corpus documents used as state snapshots: a copy of each document
+// with a small fraction of the values changed is the new state. Sending the patch
+// (diff + dump of the patch) is compared against sending the whole new state (dump), and
+// applying the patch in place against rebuilding the state (a copy of the new document).
+
+namespace
+{
+	// collects the scalar values of a document
+	void collect_values(Json& json, std::vector<Json*>& values)
+	{
+		if (json.is(json_data_type::object))
+		{
+			for (auto& pair : json.as_object())
+				collect_values(pair.second, values);
+		}
+		else if (json.is(json_data_type::array))
+		{
+			for (Json& value : json.as_array())
+				collect_values(value, values);
+		}
+		else
+			values.push_back(&json);
+	}
+
+	// changes one value every `period`
+	void change_values(Json& json, size_t period)
+	{
+		std::vector<Json*> values;
+		collect_values(json, values);
+		for (size_t i = period / 2; i < values.size(); i += period)
+		{
+			Json& value = *values[i];
+			if (value.is(json_data_type::integer))
+				value = Json(value.get<json_data_type::integer>() + 1);
+			else if (value.is(json_data_type::floating_point))
+				value = Json(value.get<json_data_type::floating_point>() * 2);
+			else if (value.is(json_data_type::string))
+				value = Json(value.get<json_data_type::string>() + " (edited)");
+			else if (value.is(json_data_type::boolean))
+				value = Json(!value.get<json_data_type::boolean>());
+			else
+				value = Json(static_cast<Json::Int>(i));
+		}
+	}
+}
+
+BENCHMARK_GROUP(patch)
+{
+	for (const bench::document& doc : bench::corpus())
+	{
+		const std::string name = "patch/" + doc.name;
+		Json state;
+		if (!ctx.enabled(name) || !Json::parse(doc.text, state))
+			continue;
+		Json next = state;
+		change_values(next, 1000);
+
+		const std::string full = next.dump();
+		const std::string patch = Json::diff(state, next).dump();
+		ctx.note(name, std::to_string(patch.size()) + " patch bytes, " + std::to_string(full.size()) + " document bytes (" +
+			std::to_string(100.0 * patch.size() / full.size()) + " %)");
+
+		ctx.run(name + "/send document", full.size(), [&]() {
+			std::string str = next.dump();
+			bench::do_not_optimize(str);
+		});
+		ctx.run(name + "/send patch", full.size(), [&]() {
+			std::string str = Json::diff(state, next).dump();
+			bench::do_not_optimize(str);
+		});
+		ctx.run(name + "/diff identical", full.size(), [&]() {
+			bench::do_not_optimize(Json::diff(next, next));
+		});
+
+		// the patch and its inverse, to return to the same state on every iteration
+		const Json forward = Json::diff(state, next);
+		const Json backward = Json::diff(next, state);
+		Json target = state;
+		ctx.run(name + "/apply patch and inverse", 0, [&]() {
+			target.apply_patch(forward);
+			target.apply_patch(backward);
+			bench::do_not_optimize(target);
+		});
+		ctx.run(name + "/rebuild (copy)", 0, [&]() {
+			Json copy = next;
+			bench::do_not_optimize(copy);
+		});
+		if (target.is(json_data_type::object))
+		{
+			const Json merge = Json::parse("{\"bench\":{\"enabled\":true,\"period\":10}}");
+			const Json revert = Json::parse("{\"bench\":null}");
+			ctx.run(name + "/apply merge patch and inverse", 0, [&]() {
+				target.apply_merge_patch(merge);
+				target.apply_merge_patch(revert);
+				bench::do_not_optimize(target);
+			});
+		}
+	}
+}
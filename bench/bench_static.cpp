@@ -0,0 +1,63 @@
+#include "harness.hpp"
+
+#include <json_lite_static.hpp>
+
+// A default configuration embedded in the firmware: parsed from a string at boot with
+// `Json::parse()`, or parsed at compile time with `_json_static` and read from constant data.
+// Built when the compiler supports C++20.
+
+#ifdef JSON_LITE_STATIC
+
+#include <cstdio>
+
+using json_lite::Json;
+using namespace json_lite::literals;
+
+// the same text for both
+#define DEFAULT_CONFIG \
+	R"({"device": {"name": "sensor", "firmware": "1.4.2", "sample_period_ms": 250},)" \
+	R"("wifi": {"ssid": "factory", "retries": 5, "timeout_ms": 8000, "power_save": true},)" \
+	R"("mqtt": {"host": "broker.local", "port": 1883, "topics": ["telemetry", "status", "commands"]},)" \
+	R"("calibration": [1.0, 0.998, 1.0021, 0.9994, 1.0003, 0.9987, 1.0012, 1.0001]})"
+
+namespace
+{
+	const char default_config[] = DEFAULT_CONFIG;
+
+	// read a few settings, as the firmware would after boot
+	template <class Value>
+	double read_settings(const Value& config)
+	{
+		return static_cast<double>(static_cast<json_lite::json_int>(config["wifi"]["retries"])) +
+			static_cast<double>(static_cast<json_lite::json_int>(config["mqtt"]["port"])) +
+			static_cast<json_lite::json_float>(config["calibration"][3]);
+	}
+}
+
+BENCHMARK_GROUP(literals)
+{
+	const uint64_t before = bench::allocated_bytes();
+	const json_lite::snapshot_value literal = DEFAULT_CONFIG ""_json_static;
+	bench::do_not_optimize(read_settings(literal));
+	const uint64_t literal_bytes = bench::allocated_bytes() - before;
+	const Json parsed = Json::parse(default_config);
+	char text[160];
+	snprintf(text, sizeof(text), "Json::parse %llu B, _json_static %llu B",
+		static_cast<unsigned long long>(bench::allocated_bytes() - before - literal_bytes),
+		static_cast<unsigned long long>(literal_bytes));
+	ctx.note("literals/heap at boot", text);
+
+	ctx.run("literals/Json::parse and read", sizeof(default_config) - 1, [&]() {
+		const Json config = Json::parse(default_config);
+		bench::do_not_optimize(read_settings(config));
+	});
+	ctx.run("literals/_json_static and read", 0, [&]() {
+		const json_lite::snapshot_value config = DEFAULT_CONFIG ""_json_static;
+		bench::do_not_optimize(read_settings(config));
+	});
+	ctx.run("literals/read parsed", 0, [&]() {
+		bench::do_not_optimize(read_settings(parsed));
+	});
+}
+
+#endif
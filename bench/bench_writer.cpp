@@ -0,0 +1,117 @@
+#include "harness.hpp"
+
+#include <json_lite.hpp>
+
+#include <cstring>
+
+using json_lite::Json;
+
+// A response of 100k records produced by building a `Json` with `operator[]` and dumping it,
+// and by streaming it with `json_writer` to a string or to a sink that discards the output
+// (the memory of a response streamed to a socket or a file).
+
+namespace
+{
+	const int record_count = 100000;
+
+	// counts the bytes written
+	class counting_sink : public json_lite::output_sink
+	{
+	public:
+		void write(const char*, size_t size) override { bytes += size; }
+
+		size_t bytes = 0;
+	};
+
+	std::string record_name(int i)
+	{
+		return "item " + std::to_string(i);
+	}
+
+	// the keys are literals, they can be written with `json_writer::clean_key()`
+	void write_key(json_lite::json_writer& writer, const char* key, bool clean)
+	{
+		if (clean)
+			writer.clean_key(key, strlen(key));
+		else
+			writer.key(key);
+	}
+
+	void write_response(json_lite::json_writer& writer, bool clean_keys = false)
+	{
+		writer.begin_object();
+		write_key(writer, "count", clean_keys);
+		writer.value(record_count);
+		write_key(writer, "items", clean_keys);
+		writer.begin_array();
+		for (int i = 0; i < record_count; ++i)
+		{
+			writer.begin_object();
+			write_key(writer, "active", clean_keys);
+			writer.value(i % 3 == 0);
+			write_key(writer, "id", clean_keys);
+			writer.value(i);
+			write_key(writer, "name", clean_keys);
+			writer.value(record_name(i));
+			write_key(writer, "price", clean_keys);
+			writer.value(i * 0.25);
+			write_key(writer, "tags", clean_keys);
+			writer.begin_array();
+			writer.value("json");
+			writer.value("lite");
+			writer.end_array();
+			writer.end_object();
+		}
+		writer.end_array();
+		writer.end_object();
+	}
+}
+
+BENCHMARK_GROUP(writer)
+{
+	Json built;
+	const auto build = [&built]() {
+		built = Json();
+		built["count"] = Json(static_cast<Json::Int>(record_count));
+		for (int i = 0; i < record_count; ++i)
+		{
+			Json& item = built["items"][i];
+			item["active"] = Json(i % 3 == 0);
+			item["id"] = Json(static_cast<Json::Int>(i));
+			item["name"] = Json(record_name(i));
+			item["price"] = Json(i * 0.25);
+			item["tags"][0] = Json("json");
+			item["tags"][1] = Json("lite");
+		}
+	};
+	build();
+	const size_t size = built.dump().size();
+
+	ctx.run("writer/build and dump", size, [&]() {
+		build();
+		std::string str = built.dump();
+		bench::do_not_optimize(str);
+	});
+	ctx.run("writer/json_writer to string", size, [&]() {
+		std::string str;
+		json_lite::string_sink sink(str);
+		json_lite::json_writer writer(sink);
+		write_response(writer);
+		writer.flush();
+		bench::do_not_optimize(str);
+	});
+	ctx.run("writer/json_writer to sink", size, [&]() {
+		counting_sink sink;
+		json_lite::json_writer writer(sink);
+		write_response(writer);
+		writer.flush();
+		bench::do_not_optimize(sink.bytes);
+	});
+	ctx.run("writer/json_writer to sink, clean keys", size, [&]() {
+		counting_sink sink;
+		json_lite::json_writer writer(sink);
+		write_response(writer, true);
+		writer.flush();
+		bench::do_not_optimize(sink.bytes);
+	});
+}
@@ -0,0 +1,257 @@
+#include "harness.hpp"
+
+#include <cstdio>
+
+namespace bench
+{
+	namespace
+	{
+		std::string g_directory;
+
+		// deterministic generator, the synthetic corpus must be the same on every run
+		class random
+		{
+		public:
+			uint64_t next()
+			{
+				m_state ^= m_state << 13;
+				m_state ^= m_state >> 7;
+				m_state ^= m_state << 17;
+				return m_state;
+			}
+
+			long long integer(long long min, long long max)
+			{
+				return min + static_cast<long long>(next() % static_cast<uint64_t>(max - min + 1));
+			}
+
+			double real(double min, double max)
+			{
+				return min + (max - min) * (static_cast<double>(next() >> 11) / 9007199254740992.0);
+			}
+
+			std::string word()
+			{
+				static const char* const words[] = {
+					"json", "lite", "parser", "esp32", "sensor", "value", "network", "update",
+					"device", "status", "config", "release", "stream", "buffer", "quick", "brown",
+					"fox", "jumps", "over", "lazy", "dog", "hello", "world", "data"
+				};
+				return words[next() % (sizeof(words) / sizeof(words[0]))];
+			}
+
+			std::string sentence(int words)
+			{
+				std::string str;
+				for (int i = 0; i < words; ++i)
+				{
+					if (i != 0)
+						str += ' ';
+					str += word();
+				}
+				return str;
+			}
+
+		private:
+			uint64_t m_state = 0x9e3779b97f4a7c15ull;
+		};
+
+		std::string number(long long value)
+		{
+			return std::to_string(value);
+		}
+
+		std::string number(double value)
+		{
+			char buffer[32];
+			snprintf(buffer, sizeof(buffer), "%.15g", value);
+			return buffer;
+		}
+
+		std::string quoted(const std::string& str)
+		{
+			return '"' + str + '"';
+		}
+
+		// same shape as twitter.json: an array of statuses with nested user and entities
+		std::string make_twitter()
+		{
+			random rng;
+			std::string str = "{\"statuses\":[";
+			for (int i = 0; i < 800; ++i)
+			{
+				if (i != 0)
+					str += ',';
+				str += "{\"id\":" + number(rng.integer(100000000000000000LL, 999999999999999999LL));
+				str += ",\"text\":" + quoted(rng.sentence(14));
+				str += ",\"created_at\":\"Sun Aug 31 00:29:15 +0000 2014\"";
+				str += ",\"user\":{\"id\":" + number(rng.integer(1, 3000000000LL));
+				str += ",\"name\":" + quoted(rng.sentence(2));
+				str += ",\"screen_name\":" + quoted(rng.word() + rng.word());
+				str += ",\"description\":" + quoted(rng.sentence(10));
+				str += ",\"followers_count\":" + number(rng.integer(0, 100000));
+				str += ",\"friends_count\":" + number(rng.integer(0, 5000));
+				str += ",\"verified\":" + std::string(rng.next() % 10 == 0 ? "true" : "false");
+				str += ",\"lang\":\"en\",\"profile_background_color\":\"C0DEED\"}";
+				str += ",\"geo\":null,\"coordinates\":null,\"place\":null";
+				str += ",\"retweet_count\":" + number(rng.integer(0, 1000));
+				str += ",\"favorite_count\":" + number(rng.integer(0, 1000));
+				str += ",\"entities\":{\"hashtags\":[";
+				const int hashtags = static_cast<int>(rng.integer(0, 3));
+				for (int h = 0; h < hashtags; ++h)
+				{
+					if (h != 0)
+						str += ',';
+					const long long start = rng.integer(0, 100);
+					str += "{\"text\":" + quoted(rng.word()) + ",\"indices\":[" + number(start) + "," + number(start + 8) + "]}";
+				}
+				str += "],\"symbols\":[],\"urls\":[],\"user_mentions\":[]}";
+				str += ",\"favorited\":false,\"retweeted\":false,\"lang\":\"en\"}";
+			}
+			str += "],\"search_metadata\":{\"completed_in\":0.087,\"max_id\":505874924095815681,\"query\":\"%E4%B8%80\",\"count\":800,\"since_id\":0}}";
+			return str;
+		}
+
+		// same shape as canada.json: a polygon with many rings of floating point coordinates
+		std::string make_canada()
+		{
+			random rng;
+			std::string str = "{\"type\":\"FeatureCollection\",\"features\":[{\"type\":\"Feature\",\"properties\":{\"name\":\"Canada\"},\"geometry\":{\"type\":\"Polygon\",\"coordinates\":[";
+			for (int ring = 0; ring < 480; ++ring)
+			{
+				if (ring != 0)
+					str += ',';
+				str += '[';
+				for (int point = 0; point < 115; ++point)
+				{
+					if (point != 0)
+						str += ',';
+					str += '[' + number(rng.real(-141.0, -52.0)) + ',' + number(rng.real(41.0, 83.0)) + ']';
+				}
+				str += ']';
+			}
+			str += "]}}]}";
+			return str;
+		}
+
+		// same shape as citm_catalog.json: objects keyed by numeric ids and arrays of small records
+		std::string make_citm()
+		{
+			random rng;
+			std::string str = "{\"areaNames\":{";
+			for (int i = 0; i < 20; ++i)
+			{
+				if (i != 0)
+					str += ',';
+				str += quoted(number(205705993LL + i)) + ":" + quoted(rng.sentence(2));
+			}
+			str += "},\"events\":{";
+			for (int i = 0; i < 180; ++i)
+			{
+				if (i != 0)
+					str += ',';
+				const long long id = 138586341LL + i * 97;
+				str += quoted(number(id)) + ":{\"description\":null,\"id\":" + number(id) + ",\"logo\":null,\"name\":" + quoted(rng.sentence(3));
+				str += ",\"subTopicIds\":[337184269,337184283],\"subjectCode\":null,\"subtitle\":null,\"topicIds\":[324846099,107888604]}";
+			}
+			str += "},\"performances\":[";
+			for (int i = 0; i < 240; ++i)
+			{
+				if (i != 0)
+					str += ',';
+				str += "{\"eventId\":" + number(138586341LL + rng.integer(0, 179) * 97) + ",\"id\":" + number(339887544LL + i);
+				str += ",\"logo\":null,\"name\":null,\"prices\":[";
+				for (int p = 0; p < 3; ++p)
+				{
+					if (p != 0)
+						str += ',';
+					str += "{\"amount\":" + number(rng.integer(10, 200) * 1000) + ",\"audienceSubCategoryId\":337100890,\"seatCategoryId\":" + number(338937295LL + p) + "}";
+				}
+				str += "],\"seatCategories\":[";
+				for (int c = 0; c < 3; ++c)
+				{
+					if (c != 0)
+						str += ',';
+					str += "{\"areas\":[{\"areaId\":205705999,\"blockIds\":[]},{\"areaId\":205705998,\"blockIds\":[]}],\"seatCategoryId\":" + number(338937295LL + c) + "}";
+				}
+				str += "],\"seatMapImage\":null,\"start\":" + number(1372701600000LL + i * 86400000LL) + ",\"venueCode\":\"PLEYEL_PLEYEL\"}";
+			}
+			str += "],\"venueNames\":{\"PLEYEL_PLEYEL\":\"Salle Pleyel\"}}";
+			return str;
+		}
+
+		// deeply nested arrays and objects
+		std::string make_deep()
+		{
+			std::string str;
+			const int depth = 5000;
+			for (int i = 0; i < depth; ++i)
+				str += (i % 2 == 0) ? "[" : "{\"k\":";
+			str += "1";
+			for (int i = depth - 1; i >= 0; --i)
+				str += (i % 2 == 0) ? "]" : "}";
+			return str;
+		}
+
+		// a single wide array of small records
+		std::string make_wide()
+		{
+			random rng;
+			std::string str = "[";
+			for (int i = 0; i < 20000; ++i)
+			{
+				if (i != 0)
+					str += ',';
+				str += "{\"id\":" + number(static_cast<long long>(i)) + ",\"v\":" + number(rng.real(0, 1)) + ",\"ok\":true}";
+			}
+			str += "]";
+			return str;
+		}
+
+		bool load_file(const std::string& path, std::string& text)
+		{
+			FILE* file = fopen(path.c_str(), "rb");
+			if (file == nullptr)
+				return false;
+			char block[65536];
+			size_t n;
+			text.clear();
+			while ((n = fread(block, 1, sizeof(block), file)) != 0)
+				text.append(block, n);
+			fclose(file);
+			return true;
+		}
+
+		document load_or_generate(const std::string& name, std::string (*generate)())
+		{
+			document doc;
+			if (!g_directory.empty() && load_file(g_directory + "/" + name + ".json", doc.text))
+				doc.name = name;
+			else
+			{
+				doc.name = name + "(synthetic)";
+				doc.text = generate();
+			}
+			return doc;
+		}
+	}
+
+	////////////////////////////////////////////////////////////////
+	void set_corpus_directory(const std::string& directory)
+	{
+		g_directory = directory;
+	}
+
+	////////////////////////////////////////////////////////////////
+	const std::vector<document>& corpus()
+	{
+		static const std::vector<document> documents = {
+			load_or_generate("twitter", make_twitter),
+			load_or_generate("canada", make_canada),
+			load_or_generate("citm_catalog", make_citm),
+			{ "deep", make_deep() },
+			{ "wide", make_wide() },
+		};
+		return documents;
+	}
+}
@@ -0,0 +1,81 @@
+#include "harness.hpp"
+
+#include <chrono>
+#include <cstdio>
+
+namespace bench
+{
+	////////////////////////////////////////////////////////////////
+	std::vector<std::pair<const char*, group_function>>& groups()
+	{
+		static std::vector<std::pair<const char*, group_function>> groups;
+		return groups;
+	}
+
+	////////////////////////////////////////////////////////////////
+	registrar::registrar(const char* name, group_function function)
+	{
+		groups().emplace_back(name, function);
+	}
+
+	////////////////////////////////////////////////////////////////
+	bool context::enabled(const std::string& name) const
+	{
+		return filter.empty() || name.find(filter) != std::string::npos;
+	}
+
+	////////////////////////////////////////////////////////////////
+	void context::run(const std::string& name, size_t bytes, const std::function<void()>& operation)
+	{
+		if (!enabled(name))
+			return;
+
+		typedef std::chrono::steady_clock clock;
+
+		// warm up (caches, allocator pools, lazy initialization)
+		operation();
+
+		const double min_time_ns = min_time_ms * 1e6;
+		uint64_t iterations = 0;
+		const uint64_t allocations_before = allocation_count();
+		const uint64_t bytes_before = allocated_bytes();
+		const clock::time_point start = clock::now();
+		double elapsed_ns = 0;
+		do
+		{
+			operation();
+			++iterations;
+			elapsed_ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count());
+		} while (elapsed_ns < min_time_ns || iterations < 3);
+
+		result r;
+		r.name = name;
+		r.iterations = iterations;
+		r.ns_per_op = elapsed_ns / iterations;
+		r.mb_per_s = bytes == 0 ? 0 : (static_cast<double>(bytes) / (1 << 20)) / (r.ns_per_op * 1e-9);
+		r.allocations_per_op = static_cast<double>(allocation_count() - allocations_before) / iterations;
+		r.allocated_bytes_per_op = static_cast<double>(allocated_bytes() - bytes_before) / iterations;
+		results.push_back(r);
+
+		char throughput[32] = "-";
+		if (bytes != 0)
+			snprintf(throughput, sizeof(throughput), "%.1f", r.mb_per_s);
+		printf("%-56s %10llu %14.0f %10s %12.1f %14.0f\n",
+			r.name.c_str(),
+			static_cast<unsigned long long>(r.iterations),
+			r.ns_per_op,
+			throughput,
+			r.allocations_per_op,
+			r.allocated_bytes_per_op);
+		fflush(stdout);
+	}
+
+	////////////////////////////////////////////////////////////////
+	void context::note(const std::string& name, const std::string& text)
+	{
+		if (!enabled(name))
+			return;
+		printf("  %-54s %s\n", name.c_str(), text.c_str());
+		fflush(stdout);
+	}
+}
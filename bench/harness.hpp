@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// A small benchmark harness: each case is timed until it ran for at least the
+// minimum time and is reported as time per operation, throughput (when the
+// case processes a known number of bytes) and heap allocations per operation.
+
+namespace bench
+{
+	// ================================
+	//           Allocations
+	// ================================
+
+	// number of calls to the global `operator new` since the program started
+	uint64_t allocation_count();
+
+	// number of bytes requested to the global `operator new` since the program started
+	uint64_t allocated_bytes();
+
+	// ================================
+	//              Corpus
+	// ================================
+
+	// a named JSON document used as benchmark input
+	struct document
+	{
+		std::string name;
+		std::string text;
+	};
+
+	// The benchmark corpus: twitter.json, canada.json and citm_catalog.json are loaded
+	// from the corpus directory when available, synthetic documents with the same
+	// shape are generated otherwise. The deep and wide synthetic cases are always generated.
+	const std::vector<document>& corpus();
+
+	// set the directory the corpus files are loaded from, must be called before `corpus()`
+	void set_corpus_directory(const std::string& directory);
+
+	// ================================
+	//             Running
+	// ================================
+
+	// the measured result of a case
+	struct result
+	{
+		std::string name;
+		uint64_t iterations;
+		double ns_per_op;
+		double mb_per_s; // 0 if the case has no byte count
+		double allocations_per_op;
+		double allocated_bytes_per_op;
+	};
+
+	// The context passed to the benchmark groups.
+	class context
+	{
+	public:
+
+		// time `operation`, `bytes` is the number of bytes processed by one call (0 if not meaningful)
+		void run(const std::string& name, size_t bytes, const std::function<void()>& operation);
+
+		// report an extra metric, printed after the results of the group
+		void note(const std::string& name, const std::string& text);
+
+		// checks if a case name passes the filter, to skip expensive setup
+		bool enabled(const std::string& name) const;
+
+		std::string filter;
+		double min_time_ms = 200;
+		std::vector<result> results;
+	};
+
+	// a function that runs a group of cases
+	using group_function = void (*)(context&);
+
+	// registers a group, use `BENCHMARK_GROUP`
+	struct registrar
+	{
+		registrar(const char* name, group_function function);
+	};
+
+	// the registered groups in registration order
+	std::vector<std::pair<const char*, group_function>>& groups();
+
+	// prevents the compiler from optimizing away a value
+	template <class T>
+	inline void do_not_optimize(const T& value)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static volatile const void* sink;
+		sink = &value;
+#endif
+	}
+}
+
+// defines and registers a group of benchmark cases
+#define BENCHMARK_GROUP(name) \
+	static void name(bench::context& ctx); \
+	static bench::registrar name##_registrar(#name, name); \
+	static void name(bench::context& ctx)
@@ -0,0 +1,46 @@
+#include "harness.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+	void usage(const char* program)
+	{
+		printf(
+			"usage: %s [--filter TEXT] [--min-time MS] [--corpus DIR]\n"
+			"  --filter TEXT   run only the cases whose name contains TEXT\n"
+			"  --min-time MS   minimum time spent on each case (default 200)\n"
+			"  --corpus DIR    directory with twitter.json, canada.json and citm_catalog.json\n"
+			"                  (default: $JSON_LITE_BENCH_CORPUS, synthetic documents if missing)\n",
+			program);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	bench::context ctx;
+	if (const char* directory = getenv("JSON_LITE_BENCH_CORPUS"))
+		bench::set_corpus_directory(directory);
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+			ctx.filter = argv[++i];
+		else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+			ctx.min_time_ms = atof(argv[++i]);
+		else if (strcmp(argv[i], "--corpus") == 0 && i + 1 < argc)
+			bench::set_corpus_directory(argv[++i]);
+		else
+		{
+			usage(argv[0]);
+			return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+		}
+	}
+
+	printf("%-56s %10s %14s %10s %12s %14s\n", "case", "iterations", "ns/op", "MB/s", "allocs/op", "bytes/op");
+	for (const auto& group : bench::groups())
+		group.second(ctx);
+	return 0;
+}
@@ -0,0 +1,6 @@
+# Package configuration of the installed json_lite, used by find_package(json_lite)
+
+include(CMakeFindDependencyMacro)
+find_dependency(Threads)
+
+include("${CMAKE_CURRENT_LIST_DIR}/json_lite-targets.cmake")
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <json_lite.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+// Shared pieces of the fuzz targets, see fuzz/README.md
+
+// the libFuzzer entry point, implemented by every target
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+// aborts (so that the fuzzer saves the input) when `condition` does not hold
+#define FUZZ_CHECK(condition, message) \
+	do { \
+		if (!(condition)) \
+		{ \
+			fprintf(stderr, "%s:%d: check failed: %s (%s)\n", __FILE__, __LINE__, #condition, message); \
+			abort(); \
+		} \
+	} while (false)
+
+namespace fuzz
+{
+	// The nesting limit used by the targets: `dump()` and the destructor are recursive,
+	// the targets must not fail on a stack overflow that the parser itself avoids.
+	const size_t max_depth = 256;
+
+	// The reference parser: a recursive descent parser written independently from
+	// `json_lite` against RFC 8259, plus the documented leniencies of `json_lite`
+	// (trailing commas, lax numbers, every `isspace` character as whitespace,
+	// unescaped control characters, trailing content) and minus `\u` escapes.
+	// Returns true on success, `consumed` is the position right after the value.
+	bool reference_parse(const char* begin, const char* end, json_lite::Json& out, size_t& consumed);
+
+	// true if `json` contains a non finite floating point number (e.g. parsed from `1e999`),
+	// they are dumped as `inf`/`nan` which is not JSON, a known limitation of `dump()`
+	bool has_non_finite(const json_lite::Json& json);
+}
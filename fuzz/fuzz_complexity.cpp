@@ -0,0 +1,130 @@
+#include "fuzz_common.hpp"
+
+#include <chrono>
+#include <string>
+
+using json_lite::Json;
+
+// Complexity target: parsing must take linear time in the input size. Every
+// accepted input is repeated in a small and in a `growth` times larger document
+// (as array elements, as object members and as nesting), if the time per byte
+// of the large document is more than `max_slowdown` times the one of the small
+// document, parsing is superlinear in some dimension and the input is reported.
+
+namespace
+{
+	const size_t growth = 64;
+	const double max_slowdown = 8.0; // a quadratic blowup gives up to 64
+
+	// the small documents are at least this large, so that the fixed costs do not hide the per element ones
+	const size_t min_document_size = 1024;
+
+	// inputs larger than this are not scaled, to keep every run short
+	const size_t max_input_size = 4096;
+
+	// best time per byte, in nanoseconds, of parsing `text`
+	double ns_per_byte(const std::string& text)
+	{
+		typedef std::chrono::steady_clock clock;
+		const auto budget = std::chrono::microseconds(500);
+
+		json_lite::parse_limits limits;
+		limits.max_depth = fuzz::max_depth;
+
+		double best = 0;
+		for (int round = 0; round < 3; ++round)
+		{
+			size_t iterations = 0;
+			const auto start = clock::now();
+			auto elapsed = clock::duration::zero();
+			do
+			{
+				Json json;
+				Json::parse(text.data(), text.data() + text.size(), json, limits);
+				++iterations;
+				elapsed = clock::now() - start;
+			} while (elapsed < budget);
+			const double ns = std::chrono::duration<double, std::nano>(elapsed).count() / (double(iterations) * text.size());
+			if (round == 0 || ns < best)
+				best = ns;
+		}
+		return best;
+	}
+
+	std::string as_elements(const std::string& value, size_t count)
+	{
+		std::string text = "[";
+		for (size_t i = 0; i < count; ++i)
+		{
+			if (i != 0)
+				text += ',';
+			text += value;
+		}
+		return text + "]";
+	}
+
+	std::string as_members(const std::string& value, size_t count)
+	{
+		std::string text = "{";
+		for (size_t i = 0; i < count; ++i)
+		{
+			if (i != 0)
+				text += ',';
+			text += "\"" + std::to_string(i) + "\":" + value;
+		}
+		return text + "}";
+	}
+
+	std::string as_nested(const std::string& value, size_t count)
+	{
+		return std::string(count, '[') + value + std::string(count, ']');
+	}
+
+	void check_scaling(const std::string& value, std::string (*scale)(const std::string&, size_t), size_t small, const char* message)
+	{
+		const std::string small_text = scale(value, small);
+		const std::string large_text = scale(value, small * growth);
+
+		// the nesting limit could be reached by the large document only
+		json_lite::parse_limits limits;
+		limits.max_depth = fuzz::max_depth;
+		Json json;
+		if (!Json::parse(large_text.data(), large_text.data() + large_text.size(), json, limits).ok())
+			return;
+
+		const double small_cost = ns_per_byte(small_text);
+		const double large_cost = ns_per_byte(large_text);
+		if (large_cost > max_slowdown * small_cost)
+		{
+			fprintf(stderr, "%s: %.2f ns/byte for %zu bytes, %.2f ns/byte for %zu bytes\n",
+				message, small_cost, small_text.size(), large_cost, large_text.size());
+			FUZZ_CHECK(false, "superlinear parsing time");
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+	if (size > max_input_size)
+		return 0;
+
+	const char* begin = reinterpret_cast<const char*>(data);
+
+	json_lite::parse_limits limits;
+	limits.max_depth = fuzz::max_depth;
+
+	Json json;
+	const json_lite::parse_result result = Json::parse(begin, begin + size, json, limits);
+	if (!result.ok())
+		return 0;
+
+	// only the parsed value, the trailing content would make the scaled documents invalid
+	const std::string value(begin, begin + result.offset);
+	const size_t count = value.size() < min_document_size ? min_document_size / value.size() : 1;
+	check_scaling(value, as_elements, count, "array elements");
+	check_scaling(value, as_members, count, "object members");
+	// the nesting is bounded by `fuzz::max_depth`
+	check_scaling(value, as_nested, fuzz::max_depth / growth, "nesting");
+	return 0;
+}
@@ -0,0 +1,291 @@
+#include "fuzz_common.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using json_lite::Json;
+
+// Differential target: `json_lite` and the reference parser (see reference.cpp)
+// must accept the same inputs, stop at the same position and produce the same document.
+// `Json::parse_parallel()`, `json_cursor`, recycling parses, a reused `json_parser`, `json_push_parser`
+// and raw numbers are checked against `Json::parse()` the same way, and `json_query` against the parsed document.
+
+namespace
+{
+	// rebuild the document token by token
+	json_lite::parse_result read_tokens(const char* begin, const char* end, const json_lite::parse_options& options, Json& out)
+	{
+		json_lite::json_cursor cursor(begin, end, options);
+		json_lite::json_sax_builder builder(out);
+		while (true)
+		{
+			switch (cursor.next())
+			{
+			case json_lite::json_token::null_value: builder.null_value(); break;
+			case json_lite::json_token::boolean: builder.boolean_value(cursor.boolean()); break;
+			case json_lite::json_token::integer: builder.integer_value(cursor.integer()); break;
+			case json_lite::json_token::floating_point: builder.floating_point_value(cursor.floating_point()); break;
+			case json_lite::json_token::string: builder.string_value(cursor.string().data(), cursor.string().size()); break;
+			case json_lite::json_token::key: builder.key(cursor.string().data(), cursor.string().size()); break;
+			case json_lite::json_token::begin_array: builder.begin_array(json_lite::json_sax::unknown_size); break;
+			case json_lite::json_token::end_array: builder.end_array(); break;
+			case json_lite::json_token::begin_object: builder.begin_object(json_lite::json_sax::unknown_size); break;
+			case json_lite::json_token::end_object: builder.end_object(); break;
+			case json_lite::json_token::end:
+			case json_lite::json_token::error:
+				return cursor.result();
+			}
+		}
+	}
+
+	// a step of the paths queried, as `json_path` compiles it
+	struct path_step
+	{
+		bool descendant;
+		const char* name; // nullptr for an index or a wildcard
+		long index;       // -1 for a name or a wildcard
+	};
+
+	struct query_case
+	{
+		const char* expression;
+		std::vector<path_step> steps;
+	};
+
+	const std::vector<query_case>& query_cases()
+	{
+		static const std::vector<query_case> cases = {
+			{ "$.a", { { false, "a", -1 } } },
+			{ "$[*].a", { { false, nullptr, -1 }, { false, "a", -1 } } },
+			{ "$..a", { { true, "a", -1 } } },
+			{ "$..[1]", { { true, nullptr, 1 } } },
+			{ "$[0]..*", { { false, nullptr, 0 }, { true, nullptr, -1 } } },
+			{ "$..a[*]..b", { { true, "a", -1 }, { false, nullptr, -1 }, { true, "b", -1 } } },
+		};
+		return cases;
+	}
+
+	// the values of `json` matching the steps from `states`, not looking inside the matches
+	void evaluate(const std::vector<path_step>& steps, const std::vector<size_t>& states, const Json& json, std::vector<std::string>& out)
+	{
+		const auto visit = [&](const std::string* key, long index, const Json& child) {
+			std::vector<size_t> child_states;
+			bool matched = false;
+			for (size_t state : states)
+			{
+				const path_step& step = steps[state];
+				const bool selected = step.name != nullptr ? key != nullptr && *key == step.name
+					: step.index < 0 || (key == nullptr && index == step.index);
+				if (selected && state + 1 == steps.size())
+					matched = true;
+				else if (selected)
+					child_states.push_back(state + 1);
+				if (step.descendant)
+					child_states.push_back(state);
+			}
+			if (matched)
+				out.push_back(child.dump());
+			else if (!child_states.empty())
+				evaluate(steps, child_states, child, out);
+		};
+		if (json.type() == json_lite::json_type::array)
+		{
+			long index = 0;
+			for (const Json& element : json.as_array())
+				visit(nullptr, index++, element);
+		}
+		else if (json.type() == json_lite::json_type::object)
+			for (const auto& member : json.as_object())
+				visit(&member.first, -1, member.second);
+	}
+
+	// number of keys in the text, duplicates included
+	size_t count_keys(const char* begin, const char* end, const json_lite::parse_options& options)
+	{
+		json_lite::json_cursor cursor(begin, end, options);
+		size_t count = 0;
+		for (json_lite::json_token token; (token = cursor.next()) != json_lite::json_token::end && token != json_lite::json_token::error;)
+			count += token == json_lite::json_token::key;
+		return count;
+	}
+
+	size_t count_members(const Json& json)
+	{
+		size_t count = 0;
+		if (json.type() == json_lite::json_type::array)
+			for (const Json& element : json.as_array())
+				count += count_members(element);
+		else if (json.type() == json_lite::json_type::object)
+			for (const auto& member : json.as_object())
+				count += 1 + count_members(member.second);
+		return count;
+	}
+
+	// feed the input to a push parser in chunks of 1 to 7 bytes
+	json_lite::parse_result push_parse(const char* begin, const char* end, const json_lite::parse_limits& limits, Json& out)
+	{
+		json_lite::json_sax_builder builder(out);
+		json_lite::json_push_parser parser(builder, limits);
+		size_t chunk = static_cast<size_t>(end - begin);
+		for (const char* p = begin; !parser.done() && parser.result(); chunk = chunk % 7 + 1)
+		{
+			const size_t size = static_cast<size_t>(end - p) < chunk ? static_cast<size_t>(end - p) : chunk;
+			if (size == 0)
+				parser.finish();
+			else
+				p += parser.feed(p, size);
+		}
+		return parser.result();
+	}
+}
+
+////////////////////////////////////////////////////////////////
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+	const char* begin = reinterpret_cast<const char*>(data);
+	const char* end = begin + size;
+
+	json_lite::parse_limits limits;
+	limits.max_depth = fuzz::max_depth;
+
+	Json json;
+	const json_lite::parse_result result = Json::parse(begin, end, json, limits);
+
+	Json expected;
+	size_t consumed = 0;
+	const bool expected_ok = fuzz::reference_parse(begin, end, expected, consumed);
+
+	FUZZ_CHECK(result.ok() == expected_ok, expected_ok ? "json_lite rejected a valid input" : "json_lite accepted an invalid input");
+
+	// the parallel parser, forced to split even the smallest inputs, must agree with the sequential one
+	json_lite::parse_options options;
+	options.max_depth = fuzz::max_depth;
+	json_lite::parallel_options parallel;
+	parallel.threads = 3;
+	parallel.min_chunk_size = 1;
+	Json parallel_json;
+	const json_lite::parse_result parallel_result = Json::parse_parallel(begin, end, parallel_json, options, parallel);
+	FUZZ_CHECK(parallel_result.ok() == result.ok(), "parse_parallel and parse disagree on the validity");
+	FUZZ_CHECK(parallel_result.offset == result.offset, "parse_parallel and parse stopped at different positions");
+	if (result.ok())
+		FUZZ_CHECK(parallel_json.dump() == json.dump(), "parse_parallel and parse produced different documents");
+
+	// recycling a value must not change the result: parse into the same document (everything is
+	// reused) and into an unrelated one (types change, members and elements are left over)
+	if (result.ok())
+	{
+		json_lite::parse_options recycle_options = options;
+		recycle_options.recycle = true;
+		Json same = json;
+		Json other = Json::parse(R"({"":[1,"a",{"b":[]}],"a":{"":"xyz","c":null},"b":[[1,2],{"d":1}],"x":"string"})");
+		for (Json* recycled : { &same, &other })
+		{
+			const json_lite::parse_result recycled_result = Json::parse(begin, end, *recycled, recycle_options);
+			FUZZ_CHECK(recycled_result.ok() && recycled_result.offset == result.offset, "a recycling parse failed on a valid input");
+			FUZZ_CHECK(recycled->dump() == json.dump(), "a recycling parse produced a different document");
+		}
+	}
+
+	// a parser reused across all the inputs, failed ones included, recycling the value of the previous input
+	static json_lite::json_parser reused_parser([&options]() {
+		json_lite::parse_options recycle_options = options;
+		recycle_options.recycle = true;
+		return recycle_options;
+	}());
+	static Json reused_json;
+	const json_lite::parse_result reused_result = reused_parser.parse(begin, end, reused_json);
+	FUZZ_CHECK(reused_result.ok() == result.ok() && reused_result.offset == result.offset, "a reused json_parser and parse disagree");
+	if (result.ok())
+		FUZZ_CHECK(reused_json.dump() == json.dump(), "a reused json_parser produced a different document");
+
+	// raw numbers must not change the errors nor the values, and their text is dumped as it is
+	// (converted numbers are still dumped with 6 decimals: only the raw dump survives a second raw parse unchanged)
+	json_lite::parse_options raw_options = options;
+	raw_options.raw_numbers = true;
+	Json raw_json;
+	const json_lite::parse_result raw_result = Json::parse(begin, end, raw_json, raw_options);
+	FUZZ_CHECK(raw_result.error == result.error && raw_result.offset == result.offset, "parse with raw numbers and parse disagree");
+	if (result.ok())
+	{
+		FUZZ_CHECK(raw_json == json && raw_json.hash() == json.hash(), "parse with raw numbers produced different values");
+		const std::string raw_dump = raw_json.dump();
+		Json reparsed;
+		if (!fuzz::has_non_finite(json))
+			FUZZ_CHECK(Json::parse(raw_dump.data(), raw_dump.data() + raw_dump.size(), reparsed, raw_options) && reparsed.dump() == raw_dump,
+				"the dump of raw numbers changed when parsed again");
+	}
+
+	// the cursor, token by token, must agree with the parser
+	Json tokens_json;
+	const json_lite::parse_result tokens_result = read_tokens(begin, end, options, tokens_json);
+	FUZZ_CHECK(tokens_result.ok() == result.ok(), "json_cursor and parse disagree on the validity");
+	FUZZ_CHECK(tokens_result.offset == result.offset, "json_cursor and parse stopped at different positions");
+	if (result.ok())
+		FUZZ_CHECK(tokens_json.dump() == json.dump(), "json_cursor and parse produced different documents");
+
+	// the push parser must report the same errors at the same positions
+	Json push_json;
+	const json_lite::parse_result push_result = push_parse(begin, end, limits, push_json);
+	FUZZ_CHECK(push_result.error == result.error, "json_push_parser and parse disagree on the error");
+	FUZZ_CHECK(push_result.offset == result.offset && push_result.line == result.line && push_result.column == result.column,
+		"json_push_parser and parse stopped at different positions");
+	if (result.ok())
+		FUZZ_CHECK(push_json.dump() == json.dump(), "json_push_parser and parse produced different documents");
+
+	// reading the elements one by one must give the same array, skipping them the same end position
+	if (result.ok() && json.type() == json_lite::json_type::array)
+	{
+		Json elements = Json::make_array();
+		json_lite::json_cursor cursor(begin, end, options);
+		const bool ok = cursor.for_each_element([&elements](Json& element) {
+			elements.get<json_lite::json_data_type::array>().push_back(element);
+		});
+		FUZZ_CHECK(ok && cursor.next() == json_lite::json_token::end, "json_cursor::for_each_element() failed on a valid array");
+		FUZZ_CHECK(cursor.result().offset == result.offset, "json_cursor::for_each_element() stopped at a different position");
+		FUZZ_CHECK(elements.dump() == json.dump(), "json_cursor::for_each_element() produced a different array");
+	}
+	if (result.ok())
+	{
+		json_lite::json_cursor cursor(begin, end, options);
+		FUZZ_CHECK(cursor.skip_value() && cursor.next() == json_lite::json_token::end, "json_cursor::skip_value() failed on a valid document");
+		FUZZ_CHECK(cursor.result().offset == result.offset, "json_cursor::skip_value() stopped at a different position");
+	}
+
+	// streaming queries must find the values found in the parsed document (the order of the members
+	// differs, sort them), the text of the matches must parse to the same values
+	if (result.ok() && count_keys(begin, end, options) == count_members(json))
+	{
+		for (const query_case& query_case : query_cases())
+		{
+			std::vector<std::string> expected_matches;
+			evaluate(query_case.steps, std::vector<size_t>(1, 0), json, expected_matches);
+			std::sort(expected_matches.begin(), expected_matches.end());
+
+			const json_lite::json_path path(query_case.expression);
+			std::vector<std::string> matches;
+			json_lite::json_cursor cursor(begin, end, options);
+			json_lite::json_query query(path, cursor);
+			FUZZ_CHECK(query.for_each([&matches](Json& value) { matches.push_back(value.dump()); }), "json_query failed on a valid document");
+			std::sort(matches.begin(), matches.end());
+			FUZZ_CHECK(matches == expected_matches, "json_query and the parsed document have different matches");
+
+			std::vector<std::string> raw_matches;
+			json_lite::json_cursor raw_cursor(begin, end, options);
+			json_lite::json_query raw_query(path, raw_cursor);
+			const char* raw_begin;
+			const char* raw_end;
+			while (raw_query.next_raw(raw_begin, raw_end))
+				raw_matches.push_back(Json::parse(raw_begin, raw_end).dump());
+			std::sort(raw_matches.begin(), raw_matches.end());
+			FUZZ_CHECK(raw_cursor.result().ok() && raw_matches == expected_matches, "json_query::next_raw() returned different matches");
+		}
+	}
+
+	if (!expected_ok)
+		return 0;
+	FUZZ_CHECK(result.offset == consumed, "json_lite stopped at a different position");
+	FUZZ_CHECK(json.data_type() == expected.data_type(), "different root type");
+	FUZZ_CHECK(json.dump() == expected.dump(), "different document");
+	return 0;
+}
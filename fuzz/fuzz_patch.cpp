@@ -0,0 +1,108 @@
+#include "fuzz_common.hpp"
+
+#include <string>
+
+using json_lite::Json;
+
+// JSON Patch target: the input is read as up to three consecutive documents `a`, `b` and `p`.
+// Applying `diff(a, b)` to `a` must give `b`, a patch `p` that fails must leave the document
+// unchanged (the rollback) and applying the merge patch `b` twice must be the same as once.
+// Equal documents must have the same hash. With packed numeric arrays, reading them (`test`,
+// the `from` of `copy`) and failed patches must not unpack them.
+
+namespace
+{
+	// parse the next document of the input, returns false at the end or on an error
+	bool next_document(const char*& begin, const char* end, Json& out)
+	{
+		json_lite::parse_limits limits;
+		limits.max_depth = fuzz::max_depth;
+		const json_lite::parse_result result = Json::parse(begin, end, out, limits);
+		if (!result.ok())
+			return false;
+		begin += result.offset;
+		return true;
+	}
+
+	// the same data types everywhere, packed arrays are not equal to generic ones
+	bool same_data_types(const Json& a, const Json& b)
+	{
+		if (a.data_type() != b.data_type())
+			return false;
+		if (a.is(json_lite::json_data_type::array))
+		{
+			const auto& x = a.get<json_lite::json_data_type::array>();
+			const auto& y = b.get<json_lite::json_data_type::array>();
+			if (x.size() != y.size())
+				return false;
+			for (size_t i = 0; i < x.size(); ++i)
+				if (!same_data_types(x[i], y[i]))
+					return false;
+		}
+		else if (a.is(json_lite::json_data_type::object))
+		{
+			const auto& x = a.get<json_lite::json_data_type::object>();
+			const auto& y = b.get<json_lite::json_data_type::object>();
+			if (x.size() != y.size())
+				return false;
+			for (auto i = x.begin(), j = y.begin(); i != x.end(); ++i, ++j)
+				if (i->first != j->first || !same_data_types(i->second, j->second))
+					return false;
+		}
+		return true;
+	}
+}
+
+////////////////////////////////////////////////////////////////
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+	const char* begin = reinterpret_cast<const char*>(data);
+	const char* end = begin + size;
+
+	const char* a_begin = begin;
+	Json a;
+	Json b;
+	if (!next_document(begin, end, a) || !next_document(begin, end, b))
+		return 0;
+	const std::string a_text = a.dump();
+	const std::string b_text = b.dump();
+
+	const Json patch = Json::diff(a, b);
+	FUZZ_CHECK(!patch.as_array().empty() || a == b, "an empty diff means equal documents");
+	FUZZ_CHECK(a != b || a.hash() == b.hash(), "equal documents must have the same hash");
+	Json patched = a;
+	const json_lite::patch_result result = patched.apply_patch(patch);
+	FUZZ_CHECK(result.ok(), "the output of diff() must apply");
+	FUZZ_CHECK(patched.dump() == b_text, "apply_patch(a, diff(a, b)) must be equal to b");
+	FUZZ_CHECK(Json::diff(patched, b).as_array().empty(), "diff(b, b) must be empty");
+
+	Json moved = a;
+	Json patch_copy = patch;
+	FUZZ_CHECK(moved.apply_patch(std::move(patch_copy)).ok() && moved.dump() == b_text, "moving the patch values must give the same result");
+
+	// a failed patch is rolled back, the document is the same
+	Json p;
+	if (next_document(begin, end, p))
+	{
+		Json target = a;
+		if (!target.apply_patch(p).ok())
+			FUZZ_CHECK(target.dump() == a_text, "a failed patch must leave the document unchanged");
+
+		// the same document with packed numeric arrays
+		json_lite::parse_options options;
+		options.max_depth = fuzz::max_depth;
+		options.pack_numeric_arrays = true;
+		Json packed;
+		Json::parse(a_begin, end, packed, options);
+		Json packed_target = packed;
+		if (!packed_target.apply_patch(p).ok())
+			FUZZ_CHECK(same_data_types(packed_target, packed), "a failed patch must leave the packed arrays packed");
+	}
+
+	Json merged = a;
+	merged.apply_merge_patch(b);
+	const std::string merged_text = merged.dump();
+	merged.apply_merge_patch(b);
+	FUZZ_CHECK(merged.dump() == merged_text, "a merge patch must be idempotent");
+	return 0;
+}
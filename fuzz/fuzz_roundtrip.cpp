@@ -0,0 +1,158 @@
+#include "fuzz_common.hpp"
+
+#include <cstring>
+#include <string>
+
+using json_lite::Json;
+
+// parse -> dump -> parse round trip: every document accepted by `parse` must
+// dump to text that parses back to the same document, and dumping must be
+// idempotent. `dump_parallel` and `json_writer` must match `dump`. The binary formats, snapshots and packed numeric arrays must preserve the document too,
+// and `snapshot::open()` must reject corrupted images.
+
+namespace
+{
+	// the snapshot must preserve the document, and `open()` must reject the corrupted images
+	// that would make the views loop (a container that is its own child) or read past a string
+	void check_snapshot(const Json& json, const std::string& text)
+	{
+		std::string image;
+		{
+			json_lite::string_sink sink(image);
+			json_lite::save_snapshot(json, sink);
+		}
+		json_lite::snapshot snapshot;
+		FUZZ_CHECK(snapshot.open(image.data(), image.size()), "the output of save_snapshot() must open");
+		FUZZ_CHECK(snapshot.root().dump() == text, "snapshots must preserve the document");
+		const json_lite::json_type root_type = snapshot.root().type();
+		const size_t root_size = root_type == json_lite::json_type::array || root_type == json_lite::json_type::object ? snapshot.root().size() : 0;
+
+		// header { magic, version, byte order, node count, strings size }, nodes { type, reserved, count, payload }
+		const size_t header_size = 32;
+		const size_t node_size = 16;
+		uint64_t node_count;
+		memcpy(&node_count, image.data() + 16, sizeof(node_count));
+		const size_t strings = header_size + node_count * node_size;
+
+		if (root_size != 0)
+		{
+			std::string corrupted = image;
+			memset(&corrupted[header_size + 8], 0, sizeof(uint64_t)); // root payload = root
+			FUZZ_CHECK(!snapshot.open(corrupted.data(), corrupted.size()), "open() must reject a container that is its own child");
+		}
+
+		for (uint64_t i = 0; i < node_count; ++i)
+		{
+			const char* node = image.data() + header_size + i * node_size;
+			if (static_cast<uint8_t>(node[0]) != static_cast<uint8_t>(json_lite::json_data_type::string))
+				continue;
+			uint32_t count;
+			uint64_t payload;
+			memcpy(&count, node + 4, sizeof(count));
+			memcpy(&payload, node + 8, sizeof(payload));
+			std::string corrupted = image;
+			corrupted[strings + payload + count] = 'x';
+			FUZZ_CHECK(!snapshot.open(corrupted.data(), corrupted.size()), "open() must reject a string without terminator");
+			break;
+		}
+	}
+
+	void check_round_trip(const Json& json)
+	{
+		const std::string text = json.dump();
+
+		Json reparsed;
+		const json_lite::parse_result result = Json::parse(text, reparsed);
+		FUZZ_CHECK(result.ok(), "the output of dump() must parse");
+		FUZZ_CHECK(result.offset == text.size(), "the output of dump() must be parsed entirely");
+		FUZZ_CHECK(reparsed.dump() == text, "dump(parse(dump(x))) must be equal to dump(x)");
+
+		// chunks of a single element, to exercise the ordering of the chunks
+		json_lite::parallel_options parallel;
+		parallel.threads = 3;
+		parallel.chunk_elements = 1;
+		FUZZ_CHECK(json.dump_parallel(parallel) == text, "dump_parallel() must be equal to dump()");
+
+		const std::string msgpack = json.to_msgpack();
+		Json from_msgpack;
+		FUZZ_CHECK(Json::from_msgpack(msgpack.data(), msgpack.data() + msgpack.size(), from_msgpack).ok(), "the output of to_msgpack() must decode");
+		FUZZ_CHECK(from_msgpack.dump() == text, "MessagePack must preserve the document");
+
+		const std::string cbor = json.to_cbor();
+		Json from_cbor;
+		FUZZ_CHECK(Json::from_cbor(cbor.data(), cbor.data() + cbor.size(), from_cbor).ok(), "the output of to_cbor() must decode");
+		FUZZ_CHECK(from_cbor.dump() == text, "CBOR must preserve the document");
+
+		// the CBOR events written as text, by the streaming writer and by its `Json` overload
+		std::string written;
+		{
+			json_lite::string_sink sink(written);
+			json_lite::json_writer writer(sink);
+			json_lite::cbor_decoder decoder(writer);
+			decoder.feed(cbor.data(), cbor.size());
+			FUZZ_CHECK(decoder.done(), "the output of to_cbor() must decode");
+		}
+		FUZZ_CHECK(written == text, "json_writer must write the same text of dump()");
+		written.clear();
+		{
+			json_lite::string_sink sink(written);
+			json_lite::json_writer writer(sink);
+			writer.begin_array();
+			writer.value(json);
+			writer.end_array();
+		}
+		FUZZ_CHECK(written == "[" + text + "]", "json_writer::value(const Json&) must write the same text of dump()");
+
+		check_snapshot(json, text);
+	}
+}
+
+////////////////////////////////////////////////////////////////
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+	const char* begin = reinterpret_cast<const char*>(data);
+	const char* end = begin + size;
+
+	json_lite::parse_limits limits;
+	limits.max_depth = fuzz::max_depth;
+
+	Json json;
+	const json_lite::parse_result result = Json::parse(begin, end, json, limits);
+
+#ifdef JSON_LITE_EXCEPTIONS
+	// the throwing overload must agree with the status one
+	bool thrown = false;
+	try
+	{
+		Json::parse(begin, end, limits);
+	}
+	catch (const Json::parsing_error&)
+	{
+		thrown = true;
+	}
+	FUZZ_CHECK(thrown == !result.ok(), "parse() must throw if and only if it reports an error");
+#endif
+
+	if (!result.ok())
+	{
+		FUZZ_CHECK(result.offset <= size, "the error offset must be inside the input");
+		return 0;
+	}
+	FUZZ_CHECK(result.offset <= size, "the parsed size must not exceed the input");
+
+	// packing the numeric arrays must not change the document
+	json_lite::parse_options options;
+	options.max_depth = fuzz::max_depth;
+	options.pack_numeric_arrays = true;
+	Json packed;
+	FUZZ_CHECK(Json::parse(begin, end, packed, options).offset == result.offset, "packing must not change the parsed size");
+	FUZZ_CHECK(packed.dump() == json.dump(), "packing must not change the document");
+	FUZZ_CHECK(packed == json && packed.hash() == json.hash(), "packed arrays must be equal to the generic ones, with the same hash");
+
+	if (!fuzz::has_non_finite(json))
+	{
+		check_round_trip(json);
+		check_round_trip(packed);
+	}
+	return 0;
+}
@@ -0,0 +1,291 @@
+#include "fuzz_common.hpp"
+
+#include <cmath>
+#include <string>
+
+using json_lite::Json;
+using json_lite::json_data_type;
+
+namespace fuzz
+{
+	namespace
+	{
+		// Deliberately simple and recursive: it is the oracle, not the code under test,
+		// so it shares nothing with the `json_lite` parser but the output type.
+		class reference_parser
+		{
+		public:
+
+			reference_parser(const char* begin, const char* end) : m_p(begin), m_end(end) {}
+
+			bool document(Json& out)
+			{
+				skip_whitespace();
+				// leniency: trailing content after the value is not an error
+				return value(out, 0);
+			}
+
+			const char* position() const { return m_p; }
+
+		private:
+
+			bool at(char c) const { return m_p != m_end && *m_p == c; }
+
+			void skip_whitespace()
+			{
+				// leniency: `isspace` is used, so \v and \f are whitespace too
+				while (m_p != m_end && (*m_p == ' ' || *m_p == '\t' || *m_p == '\n' || *m_p == '\r' || *m_p == '\v' || *m_p == '\f'))
+					++m_p;
+			}
+
+			bool value(Json& out, size_t depth)
+			{
+				if (m_p == m_end)
+					return false;
+				switch (*m_p)
+				{
+				case '[':
+					return array(out, depth);
+				case '{':
+					return object(out, depth);
+				case '"':
+				{
+					std::string str;
+					if (!string(str))
+						return false;
+					out = Json(std::move(str));
+					return true;
+				}
+				case 'n':
+					return literal("null", Json(), out);
+				case 't':
+					return literal("true", Json(true), out);
+				case 'f':
+					return literal("false", Json(false), out);
+				default:
+					return number(out);
+				}
+			}
+
+			bool literal(const std::string& text, const Json& value, Json& out)
+			{
+				if (static_cast<size_t>(m_end - m_p) < text.size() || text.compare(0, text.size(), m_p, text.size()) != 0)
+					return false;
+				m_p += text.size();
+				out = value;
+				return true;
+			}
+
+			bool array(Json& out, size_t depth)
+			{
+				if (depth >= max_depth)
+					return false;
+				++m_p;
+				Json result = Json::make_array();
+				skip_whitespace();
+				while (!at(']'))
+				{
+					Json element;
+					if (!value(element, depth + 1))
+						return false;
+					result.get<json_data_type::array>().push_back(std::move(element));
+					skip_whitespace();
+					if (at(','))
+					{
+						++m_p;
+						skip_whitespace();
+						// leniency: `[1,]` is accepted
+					}
+					else if (!at(']'))
+						return false;
+				}
+				++m_p;
+				out = std::move(result);
+				return true;
+			}
+
+			bool object(Json& out, size_t depth)
+			{
+				if (depth >= max_depth)
+					return false;
+				++m_p;
+				Json result = Json::make_object();
+				skip_whitespace();
+				while (!at('}'))
+				{
+					std::string key;
+					if (!at('"') || !string(key))
+						return false;
+					skip_whitespace();
+					if (!at(':'))
+						return false;
+					++m_p;
+					skip_whitespace();
+					Json element;
+					if (!value(element, depth + 1))
+						return false;
+					// duplicated keys: the last one wins
+					result.get<json_data_type::object>()[key] = std::move(element);
+					skip_whitespace();
+					if (at(','))
+					{
+						++m_p;
+						skip_whitespace();
+						// leniency: `{"a":1,}` is accepted
+					}
+					else if (!at('}'))
+						return false;
+				}
+				++m_p;
+				out = std::move(result);
+				return true;
+			}
+
+			bool string(std::string& out)
+			{
+				++m_p;
+				while (m_p != m_end)
+				{
+					const char c = *m_p++;
+					if (c == '"')
+						return true;
+					if (c != '\\')
+					{
+						// leniency: control characters and invalid UTF-8 are copied as they are
+						out.push_back(c);
+						continue;
+					}
+					if (m_p == m_end)
+						return false;
+					switch (*m_p++)
+					{
+					case '"': out.push_back('"'); break;
+					case '\\': out.push_back('\\'); break;
+					case '/': out.push_back('/'); break;
+					case 'b': out.push_back('\b'); break;
+					case 'f': out.push_back('\f'); break;
+					case 'n': out.push_back('\n'); break;
+					case 'r': out.push_back('\r'); break;
+					case 't': out.push_back('\t'); break;
+					default: return false; // including the unsupported `\u`
+					}
+				}
+				return false;
+			}
+
+			// leniency: a number is the longest run of `-`, digits, `.`, `e`, `E` (and a sign
+			// right after the exponent), it is valid if it matches
+			// `-? digits* (. digits*)? ([eE] [+-]? digits+)?` with at least one mantissa digit,
+			// so `.5`, `1.` and `007` are accepted
+			bool number(Json& out)
+			{
+				const char* begin = m_p;
+				const char* end = m_p;
+				if (end != m_end && *end == '-')
+					++end;
+				while (end != m_end)
+				{
+					const char c = *end;
+					if ((c == 'e' || c == 'E') && end + 1 != m_end && (end[1] == '+' || end[1] == '-'))
+						end += 2;
+					else if ((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E')
+						++end;
+					else
+						break;
+				}
+
+				const char* q = begin;
+				const bool negative = q != end && *q == '-';
+				if (negative)
+					++q;
+				size_t mantissa_digits = 0;
+				bool integer = true;
+				unsigned long long magnitude = 0;
+				bool overflow = false;
+				for (; q != end && *q >= '0' && *q <= '9'; ++q, ++mantissa_digits)
+				{
+					const unsigned digit = static_cast<unsigned>(*q - '0');
+					if (magnitude > (~0ULL - digit) / 10)
+						overflow = true;
+					else
+						magnitude = magnitude * 10 + digit;
+				}
+				if (q != end && *q == '.')
+				{
+					integer = false;
+					for (++q; q != end && *q >= '0' && *q <= '9'; ++q)
+						++mantissa_digits;
+				}
+				if (mantissa_digits == 0)
+					return false;
+				if (q != end && (*q == 'e' || *q == 'E'))
+				{
+					integer = false;
+					++q;
+					if (q != end && (*q == '+' || *q == '-'))
+						++q;
+					size_t exponent_digits = 0;
+					for (; q != end && *q >= '0' && *q <= '9'; ++q)
+						++exponent_digits;
+					if (exponent_digits == 0)
+						return false;
+				}
+				if (q != end)
+					return false;
+				m_p = end;
+
+				const unsigned long long limit = negative ? 9223372036854775808ULL : 9223372036854775807ULL;
+				if (integer && !overflow && magnitude <= limit)
+				{
+					// out of range integers are stored as floating point
+					const Json::Int value = negative ? static_cast<Json::Int>(0 - magnitude) : static_cast<Json::Int>(magnitude);
+					out = Json(value);
+					return true;
+				}
+				const std::string text(begin, end);
+				out = Json(static_cast<Json::Float>(strtod(text.c_str(), nullptr)));
+				return true;
+			}
+
+			const char* m_p;
+			const char* m_end;
+		};
+	}
+
+	////////////////////////////////////////////////////////////////
+	bool reference_parse(const char* begin, const char* end, Json& out, size_t& consumed)
+	{
+		reference_parser parser(begin, end);
+		if (!parser.document(out))
+			return false;
+		consumed = parser.position() - begin;
+		return true;
+	}
+
+	////////////////////////////////////////////////////////////////
+	bool has_non_finite(const Json& json)
+	{
+		switch (json.data_type())
+		{
+		case json_data_type::floating_point:
+			return !std::isfinite(json.get<json_data_type::floating_point>());
+		case json_data_type::array:
+			for (const auto& element : json.get<json_data_type::array>())
+				if (has_non_finite(element))
+					return true;
+			return false;
+		case json_data_type::object:
+			for (const auto& member : json.get<json_data_type::object>())
+				if (has_non_finite(member.second))
+					return true;
+			return false;
+		case json_data_type::floating_point_array:
+			for (double value : json.get<json_data_type::floating_point_array>())
+				if (!std::isfinite(value))
+					return true;
+			return false;
+		default:
+			return false;
+		}
+	}
+}
@@ -0,0 +1,204 @@
+#include "fuzz_common.hpp"
+
+#include <csignal>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+// The driver used when the targets are not built with libFuzzer (e.g. with GCC):
+// runs the target on the given files and directories, then on `--generate N`
+// random inputs derived from them (or from scratch if none is given).
+//
+// ./fuzz_roundtrip [--generate N] [--seed S] [files or directories...]
+//
+// When a check fails, the input is saved to `crash-input` in the current directory.
+
+namespace
+{
+	// deterministic generator, a failing run can be reproduced with the same seed
+	class generator
+	{
+	public:
+		explicit generator(uint64_t seed) : m_state(seed ? seed : 1) {}
+
+		uint64_t next()
+		{
+			m_state ^= m_state << 13;
+			m_state ^= m_state >> 7;
+			m_state ^= m_state << 17;
+			return m_state;
+		}
+
+		size_t below(size_t max) { return static_cast<size_t>(next() % max); }
+
+	private:
+		uint64_t m_state;
+	};
+
+	// random, mostly valid, JSON text
+	void generate_value(generator& rng, std::string& text, int depth)
+	{
+		static const char* const scalars[] = {
+			"null", "true", "false", "0", "-0", "1", "-12", "3.25", "-1e-7", "6.02E+23", "1e999", ".5", "1.",
+			"007", "9223372036854775807", "-9223372036854775808", "9223372036854775808", "\"\"", "\"text\"",
+			"\"a\\\"b\\\\c\\/d\\b\\f\\n\\r\\t\"", "\"\\u0041\"", "\"\x01\x7f\xc3\xa8\""
+		};
+		switch (depth <= 0 ? 0 : rng.below(4))
+		{
+		case 0:
+		case 1:
+			text += scalars[rng.below(sizeof(scalars) / sizeof(scalars[0]))];
+			break;
+		case 2:
+		{
+			text += '[';
+			const size_t count = rng.below(5);
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (i != 0)
+					text += rng.below(8) ? "," : " , ";
+				generate_value(rng, text, depth - 1);
+			}
+			text += ']';
+			break;
+		}
+		default:
+		{
+			text += '{';
+			const size_t count = rng.below(5);
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (i != 0)
+					text += ',';
+				text += "\"k" + std::to_string(rng.below(4)) + "\":";
+				generate_value(rng, text, depth - 1);
+			}
+			text += '}';
+			break;
+		}
+		}
+	}
+
+	// random byte level edits, biased towards the JSON syntax
+	void mutate(generator& rng, std::string& text)
+	{
+		static const char syntax[] = "[]{},:\"\\.-+eE0123456789 \t\n\v\ftfnu";
+		const size_t edits = 1 + rng.below(4);
+		for (size_t i = 0; i < edits; ++i)
+		{
+			const char c = rng.below(4) ? syntax[rng.below(sizeof(syntax) - 1)] : static_cast<char>(rng.next());
+			const size_t position = rng.below(text.size() + 1);
+			switch (rng.below(3))
+			{
+			case 0:
+				text.insert(text.begin() + position, c);
+				break;
+			case 1:
+				if (position < text.size())
+					text[position] = c;
+				break;
+			default:
+				if (position < text.size())
+					text.erase(position, 1 + rng.below(4));
+				break;
+			}
+		}
+	}
+
+	bool read_file(const std::string& path, std::string& content)
+	{
+		FILE* file = fopen(path.c_str(), "rb");
+		if (!file)
+			return false;
+		char buffer[4096];
+		size_t size;
+		while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0)
+			content.append(buffer, size);
+		fclose(file);
+		return true;
+	}
+
+	// adds `path` to the inputs, or all the files in it if it is a directory
+	void collect(const std::string& path, std::vector<std::string>& inputs)
+	{
+		if (DIR* dir = opendir(path.c_str()))
+		{
+			while (dirent* entry = readdir(dir))
+				if (entry->d_name[0] != '.')
+					collect(path + "/" + entry->d_name, inputs);
+			closedir(dir);
+			return;
+		}
+		std::string content;
+		if (!read_file(path, content))
+		{
+			fprintf(stderr, "cannot read %s\n", path.c_str());
+			exit(1);
+		}
+		inputs.push_back(content);
+	}
+
+	const std::string* g_current = nullptr;
+
+	void save_current(int)
+	{
+		// only async signal safe calls here
+		const int file = open("crash-input", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (file >= 0 && g_current)
+		{
+			const ssize_t written = write(file, g_current->data(), g_current->size());
+			(void)written;
+			close(file);
+		}
+		signal(SIGABRT, SIG_DFL);
+		raise(SIGABRT);
+	}
+
+	void run(const std::string& input)
+	{
+		g_current = &input;
+		LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t*>(input.data()), input.size());
+	}
+}
+
+////////////////////////////////////////////////////////////////
+int main(int argc, char** argv)
+{
+	signal(SIGABRT, save_current);
+
+	size_t generate = 0;
+	uint64_t seed = 1;
+	std::vector<std::string> inputs;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--generate") == 0 && i + 1 < argc)
+			generate = strtoull(argv[++i], nullptr, 10);
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+			seed = strtoull(argv[++i], nullptr, 10);
+		else
+			collect(argv[i], inputs);
+	}
+
+	for (const auto& input : inputs)
+		run(input);
+	printf("%zu inputs replayed\n", inputs.size());
+
+	generator rng(seed);
+	for (size_t i = 0; i < generate; ++i)
+	{
+		std::string text;
+		if (!inputs.empty() && rng.below(2))
+			text = inputs[rng.below(inputs.size())];
+		else
+			generate_value(rng, text, static_cast<int>(rng.below(6)));
+		if (rng.below(2))
+			mutate(rng, text);
+		run(text);
+	}
+	if (generate)
+		printf("%zu inputs generated (seed %llu)\n", generate, static_cast<unsigned long long>(seed));
+	return 0;
+}
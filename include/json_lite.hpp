@@ -1,10 +1,20 @@
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <vector>
 #include <map>
 #include <stdexcept>
 #include <ostream>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 // if we are in the arduino framework and printable is available,
 // we make our Json objects printable
@@ -19,6 +29,23 @@
 	#define IF_JSON_LITE_PRINTABLE(...)
 #endif
 
+// exceptions might be disabled (e.g. `-fno-exceptions` on esp32), in that case
+// the errors that would throw abort the program instead and the non-throwing
+// parsing functions should be used
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+	#define JSON_LITE_EXCEPTIONS
+	#define JSON_LITE_THROW(exception) throw exception
+#else
+	#define JSON_LITE_THROW(exception) std::abort()
+#endif
+
+// instrumentation counters, see `json_lite::json_stats`
+#ifdef JSON_LITE_INSTRUMENTATION
+	#define JSON_LITE_STAT_ADD(counter, value) (::json_lite::detail::current_stats.counter += (value))
+#else
+	#define JSON_LITE_STAT_ADD(counter, value) ((void)0)
+#endif
+
 /*
 Note:
   - in arduino and esp32, we don't have some c++ features such as std::variant, so we create a custom json_value class just like in nlohmann::json
@@ -39,7 +66,7 @@ namespace json_lite
 
 	// describes the internal representation of the JSON value
 	// this is about the same as json_type, but with integer and floating point numbers
-	// distinguished
+	// distinguished and with the packed numeric arrays (see `Json::pack()`)
 	enum class json_data_type
 	{
 		null,
@@ -48,7 +75,10 @@ namespace json_lite
 		floating_point,
 		string,
 		array,
-		object
+		object,
+		integer_array,        // an array of integers stored as `std::vector<json_int>`
+		floating_point_array, // an array of floating point numbers stored as `std::vector<json_float>`
+		raw_number            // a number stored as its text, see `parse_options::raw_numbers`
 	};
 
 	// the integer type used for JSON numbers
@@ -66,8 +96,376 @@ namespace json_lite
 	// ```
 	struct json_null_value_t {};
 
+	// describes why parsing failed, see `Json::parse(const char*, const char*, Json&)`
+	enum class parse_error
+	{
+		none,
+		empty_input,
+		unexpected_end,
+		unexpected_character,
+		invalid_literal,
+		invalid_number,
+		invalid_escape,
+		unsupported_unicode,
+		input_too_large,
+		depth_limit_exceeded,
+		node_limit_exceeded,
+		string_too_long,
+		unsupported_type
+	};
+
+	// get a short description of the error
+	const char* to_string(parse_error error);
+
+	// Limits enforced while parsing, parsing fails as soon as one of them is exceeded.
+	// By default nothing is limited, set the limits when parsing untrusted input.
+	// Note: the parser itself does not recurse, but copying, dumping and destroying a `Json`
+	// do, so `max_depth` should be set on devices with small stacks.
+	// example:
+	// ```cpp
+	// json_lite::parse_limits limits;
+	// limits.max_depth = 32;
+	// limits.max_input_size = 4096;
+	// Json json = Json::parse(begin, end, limits);
+	// ```
+	struct parse_limits
+	{
+		// maximum number of nested arrays and objects
+		size_t max_depth = static_cast<size_t>(-1);
+
+		// maximum number of values (containers included) in the document
+		size_t max_nodes = static_cast<size_t>(-1);
+
+		// maximum length of a string or key (after unescaping)
+		size_t max_string_length = static_cast<size_t>(-1);
+
+		// maximum size of the input in bytes
+		size_t max_input_size = static_cast<size_t>(-1);
+	};
+
+	// Parsing options, they include the limits.
+	// example:
+	// ```cpp
+	// json_lite::parse_options options;
+	// options.pack_numeric_arrays = true;
+	// options.max_depth = 32;
+	// Json json = Json::parse(begin, end, options);
+	// ```
+	struct parse_options : parse_limits
+	{
+		// store the arrays whose elements are all integers or all floating point
+		// numbers as packed arrays, see `Json::pack()`
+		bool pack_numeric_arrays = false;
+
+		// Reuse the value parsed into (`Json::parse(begin, end, out, options)`, `json_cursor::read_value()`):
+		// strings keep their buffers, arrays their storage and elements, objects the members whose
+		// keys are parsed again. Reparsing documents of the same shape into the same `Json` then
+		// allocates only for what changed. Packed arrays are not reused.
+		bool recycle = false;
+
+		// Keep the numbers as their text (`json_data_type::raw_number`, see `json_raw_number`) instead of
+		// converting them: they are converted on first access and `dump()` copies the text, so numbers that
+		// are only forwarded are never converted and keep their exact digits (large integers, long decimals).
+		// Numbers using the leniencies of the parser (`.5`, `1.`, `007`) are converted as usual, so the output
+		// is always valid JSON. Arrays of raw numbers are not packed. Used when building a `Json`
+		// (`Json::parse()`, `json_parser`, `Json::parse_parallel()`, `json_cursor::read_value()`).
+		bool raw_numbers = false;
+	};
+
+	// Options of `Json::parse_parallel()` and `Json::dump_parallel()`
+	struct parallel_options
+	{
+		// number of threads, 0 to use `std::thread::hardware_concurrency()`
+		unsigned threads = 0;
+
+		// minimum number of bytes parsed by each thread, smaller inputs use fewer threads
+		size_t min_chunk_size = 1 << 20;
+
+		// number of top level elements (or members) serialized as one unit of work by `Json::dump_parallel()`
+		size_t chunk_elements = 1024;
+	};
+
+	// Options of `Json::diff()`
+	struct diff_options
+	{
+		// Maximum size (elements of the source × elements of the destination, after removing the
+		// common prefix and suffix) of the table used to align arrays with a longest common
+		// subsequence. Larger arrays are compared index by index.
+		size_t max_lcs_size = 1 << 20;
+	};
+
+	// The result of a non-throwing parse.
+	// On failure, `offset` is the byte offset (from the beginning of the input) where the
+	// error was detected and `line`/`column` are its 1-based position.
+	// On success, `offset` is the position right after the parsed value and `line`/`column` are 0.
+	struct parse_result
+	{
+		parse_error error = parse_error::none;
+		size_t offset = 0;
+		size_t line = 0;
+		size_t column = 0;
+
+		// checks if the parsing succeeded
+		bool ok() const { return error == parse_error::none; }
+
+		// same as `ok()`
+		explicit operator bool() const { return ok(); }
+	};
+
+	// Errors reported by `Json::apply_patch()`
+	enum class patch_error
+	{
+		none,
+		invalid_operation, // not an object, unknown `op`, missing or invalid members
+		invalid_pointer,   // `path` or `from` is not a valid JSON Pointer (RFC 6901)
+		path_not_found,    // the location (or its parent for `add`) does not exist
+		invalid_move,      // `move` to a location inside the moved value
+		test_failed
+	};
+
+	// get a short description of the error
+	const char* to_string(patch_error error);
+
+	// The result of `Json::apply_patch()`, `operation` is the index of the failed operation.
+	struct patch_result
+	{
+		patch_error error = patch_error::none;
+		size_t operation = 0;
+
+		// checks if the patch was applied
+		bool ok() const { return error == patch_error::none; }
+
+		// same as `ok()`
+		explicit operator bool() const { return ok(); }
+	};
+
+	// A destination for serialized bytes.
+	// Implement it to stream the output (e.g. to a file, a socket or a `Print`)
+	// without building the whole result in memory.
+	class output_sink
+	{
+	public:
+		virtual ~output_sink() {}
+
+		// write `size` bytes
+		virtual void write(const char* data, size_t size) = 0;
+	};
+
+	// An `output_sink` that appends to a string.
+	class string_sink : public output_sink
+	{
+	public:
+		explicit string_sink(std::string& str) : m_str(str) {}
+
+		void write(const char* data, size_t size) override { m_str.append(data, size); }
+
+	private:
+		std::string& m_str;
+	};
+
+	// An `output_sink` that accumulates small writes and forwards them to another sink in blocks.
+	// Serializers write a few bytes at a time, this avoids a (virtual) write on the target for each of them.
+	// The remaining bytes are written on `flush()` or on destruction.
+	class buffered_sink : public output_sink
+	{
+	public:
+		explicit buffered_sink(output_sink& target) : m_target(target), m_size(0) {}
+
+		~buffered_sink() override { flush(); }
+
+		// write a single byte
+		void put(char c)
+		{
+			if (m_size == sizeof(m_buffer))
+				flush();
+			m_buffer[m_size++] = c;
+		}
+
+		void write(const char* data, size_t size) override
+		{
+			if (size > sizeof(m_buffer) - m_size)
+			{
+				flush();
+				if (size >= sizeof(m_buffer))
+				{
+					// large blocks go straight to the target
+					m_target.write(data, size);
+					return;
+				}
+			}
+			memcpy(m_buffer + m_size, data, size);
+			m_size += size;
+		}
+
+		// write the buffered bytes to the target
+		void flush()
+		{
+			if (m_size != 0)
+			{
+				m_target.write(m_buffer, m_size);
+				m_size = 0;
+			}
+		}
+
+	private:
+		output_sink& m_target;
+		char m_buffer[256];
+		size_t m_size;
+	};
+
+	// A read-only view of contiguous values, like the C++20 `std::span<const T>`.
+	// Views do not own the values, they are valid as long as the viewed storage is not modified.
+	template <class T>
+	class array_view
+	{
+	public:
+		array_view() : m_data(nullptr), m_size(0) {}
+		array_view(const T* data, size_t size) : m_data(data), m_size(size) {}
+
+		const T* data() const { return m_data; }
+		size_t size() const { return m_size; }
+		bool empty() const { return m_size == 0; }
+		const T* begin() const { return m_data; }
+		const T* end() const { return m_data + m_size; }
+		const T& operator[](size_t index) const { return m_data[index]; }
+
+	private:
+		const T* m_data;
+		size_t m_size;
+	};
+
 	class Json;
 
+	// ================================================================
+	//                        Instrumentation
+	// ================================================================
+
+	// Statistics about the work done by the library, collected per thread when the library is
+	// built with `JSON_LITE_INSTRUMENTATION` defined (the `JSON_LITE_INSTRUMENTATION` CMake option).
+	// When it is not defined, the counters and probes compile to nothing and the statistics are all zero.
+	// The timing probes are nested: `parse_ns` includes `number_ns`.
+	struct json_stats
+	{
+		// `Json` values constructed, copies and moves included
+		uint64_t nodes_created = 0;
+
+		// estimated bytes of string and container storage requested by the library
+		uint64_t bytes_allocated = 0;
+
+		// calls to the copy constructor (copy assignments included)
+		uint64_t copies = 0;
+
+		// calls to the move constructor (move assignments included)
+		uint64_t moves = 0;
+
+		// characters escaped while serializing strings
+		uint64_t string_escapes = 0;
+
+		// members inserted into objects while parsing and by `operator[]`
+		uint64_t map_insertions = 0;
+
+		// time spent in, and calls of, the text parser
+		uint64_t parse_ns = 0;
+		uint64_t parse_calls = 0;
+
+		// time spent in, and calls of, number parsing
+		uint64_t number_ns = 0;
+		uint64_t number_calls = 0;
+
+		// time spent in, and calls of, text serialization
+		uint64_t dump_ns = 0;
+		uint64_t dump_calls = 0;
+	};
+
+	// get the statistics of the calling thread
+	json_stats thread_stats();
+
+	// reset the statistics of the calling thread
+	void reset_thread_stats();
+
+#ifdef JSON_LITE_INSTRUMENTATION
+	namespace detail
+	{
+		extern thread_local json_stats current_stats;
+	}
+#endif
+
+	// ================================================================
+	//                          Raw numbers
+	// ================================================================
+
+	// A number kept as the text it was parsed from (see `parse_options::raw_numbers`).
+	// The text is converted on the first read of the value, as the parser would convert it (an integer
+	// out of the range of `json_int` is a floating point number), and the result is cached.
+	// The cache is guarded by an atomic state, const reads from multiple threads are safe
+	// (the first one converts the text, the others wait for it).
+	// example:
+	// ```cpp
+	// const json_raw_number& number = json.get<json_lite::json_data_type::raw_number>();
+	// if (number.is_integer())
+	//     total += number.integer();
+	// ```
+	class json_raw_number
+	{
+	public:
+
+		// `text` must be a valid JSON number
+		explicit json_raw_number(std::string text) : m_text(std::move(text)) {}
+
+		json_raw_number(const json_raw_number& other) : m_text(other.m_text) { copy_number(other); }
+
+		json_raw_number(json_raw_number&& other) noexcept : m_text(std::move(other.m_text)) { copy_number(other); }
+
+		json_raw_number& operator=(const json_raw_number& other) { m_text = other.m_text; copy_number(other); return *this; }
+
+		json_raw_number& operator=(json_raw_number&& other) noexcept { m_text = std::move(other.m_text); copy_number(other); return *this; }
+
+		// the text of the number
+		const std::string& text() const { return m_text; }
+
+		// checks if the parser would store the number as an integer
+		bool is_integer() const { return converted() == state::integer; }
+
+		// the value as an integer (truncated if it is a floating point number)
+		json_int integer() const { return converted() == state::integer ? m_number.integer : static_cast<json_int>(m_number.floating); }
+
+		// the value as a floating point number
+		json_float floating_point() const { return converted() == state::integer ? static_cast<json_float>(m_number.integer) : m_number.floating; }
+
+	private:
+
+		friend class Json;
+
+		enum class state : unsigned char { text, converting, integer, floating_point };
+
+		// the state of the converted number, `m_number` can be read once it is returned
+		state converted() const
+		{
+			const state current = m_state.load(std::memory_order_acquire);
+			return current == state::integer || current == state::floating_point ? current : convert();
+		}
+
+		state convert() const;
+
+		// the cache of another number, a number that is not converted yet is copied as text
+		void copy_number(const json_raw_number& other)
+		{
+			const state current = other.m_state.load(std::memory_order_acquire);
+			if (current == state::integer || current == state::floating_point)
+			{
+				m_number = other.m_number;
+				m_state.store(current, std::memory_order_relaxed);
+			}
+			else
+				m_state.store(state::text, std::memory_order_relaxed);
+		}
+
+		std::string m_text;
+		mutable union number_t { json_int integer; json_float floating; } m_number;
+		// written once, by the read that moves it from `text` to `converting`
+		mutable std::atomic<state> m_state{ state::text };
+	};
+
 	// Provides the actual type given a json_data_type value. It is useful in
 	// determining return types of functions since they are declared in the cpp
 	// and thus we cannot use `auto` in the header.
@@ -79,6 +477,9 @@ namespace json_lite
 	template <> struct json_data_type_to_type<json_data_type::string> { using type = std::string; using ref = std::string&; using cref = const std::string&; using ret_val = const std::string&; };
 	template <> struct json_data_type_to_type<json_data_type::array> { using type = std::vector<Json>; using ref = std::vector<Json>&; using cref = const std::vector<Json>&; using ret_val = const std::vector<Json>&; };
 	template <> struct json_data_type_to_type<json_data_type::object> { using type = std::map<std::string, Json>; using ref = std::map<std::string, Json>&; using cref = const std::map<std::string, Json>&; using ret_val = const std::map<std::string, Json>&; };
+	template <> struct json_data_type_to_type<json_data_type::integer_array> { using type = std::vector<json_int>; using ref = std::vector<json_int>&; using cref = const std::vector<json_int>&; using ret_val = const std::vector<json_int>&; };
+	template <> struct json_data_type_to_type<json_data_type::floating_point_array> { using type = std::vector<json_float>; using ref = std::vector<json_float>&; using cref = const std::vector<json_float>&; using ret_val = const std::vector<json_float>&; };
+	template <> struct json_data_type_to_type<json_data_type::raw_number> { using type = json_raw_number; using ref = json_raw_number&; using cref = const json_raw_number&; using ret_val = const json_raw_number&; };
 
 	// ================================================================
 	//                         Json class
@@ -132,7 +533,7 @@ namespace json_lite
 		// ================================
 
 		// Default constructor, creates a null value
-		Json() : m_data_type(json_data_type::null), m_value(null_value_t()) {}
+		Json() : m_data_type(json_data_type::null), m_value(null_value_t()) { JSON_LITE_STAT_ADD(nodes_created, 1); }
 
 		// Null constructor, creates a null value from the null pointer
 		// example:
@@ -147,64 +548,79 @@ namespace json_lite
 		// Copy constructor
 		Json(const Json& other);
 
-		// Move constructor
-		Json(Json&& other);
+		// Move constructor, never throws so that `std::vector<Json>` moves (instead of copying) when it grows
+		Json(Json&& other) noexcept;
 
 		// Constructor from a boolean value
 		// example:
 		// ```cpp
 		// Json j = true;
 		// ```
-		explicit Json(bool value) : m_data_type(json_data_type::boolean), m_value(value) {}
+		explicit Json(bool value) : m_data_type(json_data_type::boolean), m_value(value) { JSON_LITE_STAT_ADD(nodes_created, 1); }
 
 		// Constructor from an integer value
 		// example:
 		// ```cpp
 		// Json j = (Json::Int)42; // <- explicit cast is needed to avoid ambiguity with the constructor from a floating point value
 		// ```
-		explicit Json(Int value) : m_data_type(json_data_type::integer), m_value(value) {}
+		explicit Json(Int value) : m_data_type(json_data_type::integer), m_value(value) { JSON_LITE_STAT_ADD(nodes_created, 1); }
 
 		// Constructor from a floating point value
 		// example:
 		// ```cpp
 		// Json j = (Json::Float)42.42; // <- explicit cast is needed to avoid ambiguity with the constructor from an integer value
 		// ```
-		explicit Json(Float value) : m_data_type(json_data_type::floating_point), m_value(value) {}
+		explicit Json(Float value) : m_data_type(json_data_type::floating_point), m_value(value) { JSON_LITE_STAT_ADD(nodes_created, 1); }
 
 		// Constructor from a string value (`const char*`)
 		// example:
 		// ```cpp
 		// Json j = "hello world";
 		// ```
-		explicit Json(const char* value) : m_data_type(json_data_type::string), m_value(value) {}
+		explicit Json(const char* value) : m_data_type(json_data_type::string), m_value(value) { JSON_LITE_STAT_ADD(nodes_created, 1); }
 
 		// Constructor from a string value (`std::string`)
 		// example:
 		// ```cpp
 		// Json j = std::string("hello world");
 		// ```
-		explicit Json(const std::string& value) : m_data_type(json_data_type::string), m_value(value) {}
+		explicit Json(const std::string& value) : m_data_type(json_data_type::string), m_value(value) { JSON_LITE_STAT_ADD(nodes_created, 1); }
 		
-		// Constructor from rval string value (`std::string&&`)
-		explicit Json(std::string&& value) : m_data_type(json_data_type::string), m_value(value) {}
+		// Constructor from rval string value (`std::string&&`), the string is moved, not copied
+		explicit Json(std::string&& value) : m_data_type(json_data_type::string), m_value(std::move(value)) { JSON_LITE_STAT_ADD(nodes_created, 1); }
 
 		// Constructor from a vector of JSON values
-		explicit Json(const std::vector<Json>& value) : m_data_type(json_data_type::array), m_value(value) {}
+		explicit Json(const std::vector<Json>& value) : m_data_type(json_data_type::array), m_value(value) { JSON_LITE_STAT_ADD(nodes_created, 1); }
 
 		// Constructor from rval vector of JSON values
-		explicit Json(std::vector<Json>&& value) : m_data_type(json_data_type::array), m_value(value) {}
+		explicit Json(std::vector<Json>&& value) : m_data_type(json_data_type::array), m_value(std::move(value)) { JSON_LITE_STAT_ADD(nodes_created, 1); }
 
 		// Constructor from a map of JSON values
-		explicit Json(const std::map<std::string, Json>& value) : m_data_type(json_data_type::object), m_value(value) {}
+		explicit Json(const std::map<std::string, Json>& value) : m_data_type(json_data_type::object), m_value(value) { JSON_LITE_STAT_ADD(nodes_created, 1); }
 
 		// Constructor from rval map of JSON values
-		explicit Json(std::map<std::string, Json>&& value) : m_data_type(json_data_type::object), m_value(value) {}
+		explicit Json(std::map<std::string, Json>&& value) : m_data_type(json_data_type::object), m_value(std::move(value)) { JSON_LITE_STAT_ADD(nodes_created, 1); }
 
 		// Constructor from make_array_t, creates an empty array
-		explicit Json(make_array_t) : m_data_type(json_data_type::array), m_value(std::vector<Json>()) {}
+		explicit Json(make_array_t) : m_data_type(json_data_type::array), m_value(std::vector<Json>()) { JSON_LITE_STAT_ADD(nodes_created, 1); }
 
 		// Constructor from make_object_t, creates an empty object
-		explicit Json(make_object_t) : m_data_type(json_data_type::object), m_value(std::map<std::string, Json>()) {}
+		explicit Json(make_object_t) : m_data_type(json_data_type::object), m_value(std::map<std::string, Json>()) { JSON_LITE_STAT_ADD(nodes_created, 1); }
+
+		// Constructor from a vector of integers, creates a packed array (see `pack()`)
+		explicit Json(const std::vector<Int>& value) : m_data_type(json_data_type::integer_array), m_value(value) { JSON_LITE_STAT_ADD(nodes_created, 1); }
+
+		// Constructor from rval vector of integers, creates a packed array (see `pack()`)
+		explicit Json(std::vector<Int>&& value) : m_data_type(json_data_type::integer_array), m_value(std::move(value)) { JSON_LITE_STAT_ADD(nodes_created, 1); }
+
+		// Constructor from a vector of floating point numbers, creates a packed array (see `pack()`)
+		explicit Json(const std::vector<Float>& value) : m_data_type(json_data_type::floating_point_array), m_value(value) { JSON_LITE_STAT_ADD(nodes_created, 1); }
+
+		// Constructor from rval vector of floating point numbers, creates a packed array (see `pack()`)
+		explicit Json(std::vector<Float>&& value) : m_data_type(json_data_type::floating_point_array), m_value(std::move(value)) { JSON_LITE_STAT_ADD(nodes_created, 1); }
+
+		// Constructor from a raw number, see `parse_options::raw_numbers`
+		explicit Json(json_raw_number&& value) : m_data_type(json_data_type::raw_number), m_value(std::move(value)) { JSON_LITE_STAT_ADD(nodes_created, 1); }
 
 		// ================================
 		//           Destructor
@@ -217,11 +633,14 @@ namespace json_lite
 		//           Assignments
 		// ================================
 
+		// Assignments to a value of the same type reuse its storage: a string assigned to a string
+		// keeps the buffer, arrays keep their capacity and assign their elements, objects reuse their nodes.
+
 		// Copy assignment
 		Json& operator=(const Json& other);
 
 		// Move assignment
-		Json& operator=(Json&& other);
+		Json& operator=(Json&& other) noexcept;
 
 		// Assignment to null from the null pointer
 		Json& operator=(std::nullptr_t);
@@ -297,6 +716,17 @@ namespace json_lite
 		// conversion to Object, same as `json = Json::make_object();` or `json = std::map<std::string, Json>();` or `json = Json::make_object_t();`
 		void to_object();
 
+		// Empty a string, an array or an object keeping its storage: strings and arrays (packed too)
+		// keep their capacity, so filling them again does not allocate until it is exceeded.
+		// Other values become null.
+		// example:
+		// ```cpp
+		// json.clear_keep_capacity();
+		// for (const Reading& r : readings)
+		//     json.emplace_back(r.value); // no allocation once the capacity is large enough
+		// ```
+		void clear_keep_capacity();
+
 		// creates a null value
 		static Json make_null() { return Json(); }
 
@@ -306,26 +736,50 @@ namespace json_lite
 		// creates an empty object
 		static Json make_object() { Json j; j.to_object(); return j; }
 
+		// Creates an array from a list of values.
+		// The values are copied: the elements of an initializer list are const.
+		// Each value is constructed twice (in the list and in the array), this is not allocation-free:
+		// use `reserve()` and `emplace_back()` to build without copies.
+		// example:
+		// ```cpp
+		// Json json = Json::make_array({ Json(true), Json("text"), Json((Json::Int)42) });
+		// ```
+		static Json make_array(std::initializer_list<Json> values) { return Json(std::vector<Json>(values)); }
+
+		// Creates an object from a list of members.
+		// The values are copied: the elements of an initializer list are const.
+		// Each value is constructed twice (in the list and in the object), this is not allocation-free:
+		// use `reserve()` and `emplace()` to build without copies.
+		// example:
+		// ```cpp
+		// Json json = Json::make_object({ { "name", Json("sensor") }, { "value", Json(21.5) } });
+		// ```
+		static Json make_object(std::initializer_list<std::pair<const std::string, Json>> members) { return Json(std::map<std::string, Json>(members)); }
+
 		// ================================
 		//             Access
 		// ================================
 
 		// get the value reference as the given type
 		// The type must match the internal data type of the JSON value.
+		// A raw number (see `parse_options::raw_numbers`) is also an `integer` or a `floating_point`, as the parser
+		// would have stored it: it is converted to it, its text is not kept.
 		// TODO make a default inline implementation that uses static_assert(false, "invalid type") to give a better error message
 		template <json_data_type Ty> typename json_data_type_to_type<Ty>::type& get();
 
 		// get the const value reference as the given type
 		// The type must match the internal data type of the JSON value.
+		// A raw number is also an `integer` or a `floating_point`, the reference is to its cached value.
 		// TODO make a default inline implementation that uses static_assert(false, "invalid type") to give a better error message
 		template <json_data_type Ty> const typename json_data_type_to_type<Ty>::type& get() const;
 
 		// get the reference to the array, if the JSON value is not an array, it will be converted to an array
+		// a packed array is unpacked (see `unpack()`)
 		// TODO maybe this is an unwanted behavior
 		std::vector<Json>& as_array();
 
 		// get the const reference to the array
-		// The current JSON value must be an array.
+		// The current JSON value must be an array, not a packed one.
 		const std::vector<Json>& as_array() const;
 
 		// get the reference to the object, if the JSON value is not an object, it will be converted to an object
@@ -415,6 +869,89 @@ namespace json_lite
 
 		bool has_key(const std::string& key) const;
 
+		// ================================
+		//             Building
+		// ================================
+
+		// These build arrays and objects in place: the values are constructed directly in their
+		// final location from the arguments of a `Json` constructor, rvalues are moved.
+		// As for `as_array()` and `as_object()`, a value of another type is converted first.
+		// example:
+		// ```cpp
+		// Json json;
+		// json.reserve(readings.size());
+		// for (Reading& r : readings)
+		// {
+		//     Json& item = json.emplace_back(Json::make_object_t());
+		//     item.emplace("name", std::move(r.name)); // the string is moved, not copied
+		//     item.emplace("value", r.value);
+		// }
+		// ```
+
+		// append a copy of `value` to the array
+		void push_back(const Json& value) { as_array().push_back(value); }
+
+		// append `value` to the array, moving it
+		void push_back(Json&& value) { as_array().push_back(std::move(value)); }
+
+		// construct an element at the end of the array, returns a reference to it
+		template <class... Args>
+		Json& emplace_back(Args&&... args)
+		{
+			std::vector<Json>& array = as_array();
+			array.emplace_back(std::forward<Args>(args)...);
+			return array.back();
+		}
+
+		// Construct the member `key` if it is not in the object (an existing member is left unchanged),
+		// returns the member and whether it was inserted, as `std::map::emplace()`
+		template <class Key, class... Args>
+		std::pair<std::map<std::string, Json>::iterator, bool> emplace(Key&& key, Args&&... args)
+		{
+			return as_object().emplace(std::piecewise_construct, std::forward_as_tuple(std::forward<Key>(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+		}
+
+		// reserve the storage of an array for `size` elements, packed arrays reserve their numbers
+		void reserve(size_t size);
+
+		// ================================
+		//          Packed arrays
+		// ================================
+
+		// Arrays of numbers can be stored packed: the numbers are kept in a contiguous
+		// `std::vector<Int>` (`json_data_type::integer_array`) or `std::vector<Float>`
+		// (`json_data_type::floating_point_array`) instead of one `Json` per element.
+		// This uses a fraction of the memory and gives direct access to the numbers.
+		// Packed arrays are still arrays (`type()` is `json_type::array`) and are
+		// serialized as such, but the generic access (`get<json_data_type::array>()`,
+		// `as_array() const`, `operator[](size_t) const`) requires an unpacked array,
+		// while the non const `as_array()`, `operator[](size_t)` and `at(size_t)` unpack it.
+		// example:
+		// ```cpp
+		// json_lite::parse_options options;
+		// options.pack_numeric_arrays = true;
+		// Json json = Json::parse(begin, end, options);
+		// double sum = 0;
+		// for (double x : json["samples"].floating_points())
+		//     sum += x;
+		// ```
+
+		// packs an array whose elements are all integers or all floating point numbers,
+		// returns true if the value is (now) a packed array
+		bool pack();
+
+		// converts a packed array to a generic array, does nothing if the value is not a packed array
+		void unpack();
+
+		// checks if the value is a packed array
+		bool is_packed() const { return m_data_type == json_data_type::integer_array || m_data_type == json_data_type::floating_point_array; }
+
+		// view of the numbers of a packed array of integers, the value must be an `integer_array`
+		array_view<Int> integers() const;
+
+		// view of the numbers of a packed array of floating point numbers, the value must be a `floating_point_array`
+		array_view<Float> floating_points() const;
+
 		// ================================
 		//           Cast Operators
 		// ================================
@@ -449,6 +986,16 @@ namespace json_lite
 		// cast to `const char*`
 		explicit operator const char*() const;
 
+		// ================================
+		//           Comparison
+		// ================================
+
+		// Structural 64-bit hash, consistent with `operator==`: numbers hash by value (`1` and `1.0`
+		// have the same hash), packed arrays as the generic ones and objects independently of the
+		// order of their members.
+		// The hash is computed on each call, use `hashed_json` to keep it with an immutable value.
+		uint64_t hash() const;
+
 		// ================================
 		//            Parsing
 		// ================================
@@ -468,11 +1015,154 @@ namespace json_lite
 		// parse a JSON value from a string
 		static Json parse(const std::string& str);
 
+		// parse a JSON value from a string without throwing
+		// On success `out` contains the parsed value, on failure its content is unspecified
+		// and the returned value describes the error.
+		// example:
+		// ```cpp
+		// Json json;
+		// auto result = Json::parse(begin, end, json);
+		// if (!result)
+		//     printf("error at %d:%d: %s\n", (int)result.line, (int)result.column, to_string(result.error));
+		// ```
+		static parse_result parse(const char* begin, const char* end, Json& out);
+
+		// parse a JSON value from a string without throwing, see `parse(const char*, const char*, Json&)`
+		static parse_result parse(const std::string& str, Json& out);
+
+		// parse a JSON value from a string enforcing the given limits
+		static Json parse(const char* begin, const char* end, const parse_limits& limits);
+
+		// parse a JSON value from a string enforcing the given limits without throwing
+		static parse_result parse(const char* begin, const char* end, Json& out, const parse_limits& limits);
+
+		// parse a JSON value from a string with the given options (and limits)
+		static Json parse(const char* begin, const char* end, const parse_options& options);
+
+		// parse a JSON value from a string with the given options (and limits) without throwing
+		static parse_result parse(const char* begin, const char* end, Json& out, const parse_options& options);
+
+		// Parse a large document on multiple threads.
+		// A quick structural pre-scan of the input (itself parallel) finds the commas that separate
+		// the top level array elements or object members, the parts between them are parsed
+		// concurrently and joined into the result. The result, and the errors, are the same of `parse()`.
+		// Documents that are not arrays or objects, small inputs and `parse_limits::max_nodes`
+		// (which needs a global count) fall back to the sequential parser.
+		// example:
+		// ```cpp
+		// Json records = Json::parse_parallel(text.data(), text.data() + text.size());
+		// ```
+		static Json parse_parallel(const char* begin, const char* end, const parse_options& options = parse_options(), const parallel_options& parallel = parallel_options());
+
+		// parse a large document on multiple threads without throwing, see `parse_parallel(const char*, const char*, const parse_options&, const parallel_options&)`
+		static parse_result parse_parallel(const char* begin, const char* end, Json& out, const parse_options& options = parse_options(), const parallel_options& parallel = parallel_options());
+
 		// dump to a string, no indentation (lighter)
 		std::string dump() const;
 
 		// TODO std::string dump(size_t indent) const;
 
+		// Dump a large array or object on multiple threads, the output is the same of `dump()`.
+		// The top level elements (or members) are split in chunks of `parallel_options::chunk_elements`,
+		// serialized concurrently into separate buffers and written in order to the sink, so only a
+		// few chunks per thread are held in memory at any time.
+		// Other values and small containers are dumped on the calling thread.
+		// example:
+		// ```cpp
+		// std::string text;
+		// json_lite::string_sink sink(text);
+		// records.dump_parallel(sink);
+		// ```
+		void dump_parallel(output_sink& sink, const parallel_options& parallel = parallel_options()) const;
+
+		// dump a large array or object to a string on multiple threads, see `dump_parallel(output_sink&, const parallel_options&)`
+		std::string dump_parallel(const parallel_options& parallel = parallel_options()) const;
+
+		// ================================
+		//           MessagePack
+		// ================================
+
+		// serialize to MessagePack, writing to the sink
+		// Integers and floating point numbers keep their data type, floating point values
+		// are stored in single precision when this is lossless.
+		void to_msgpack(output_sink& sink) const;
+
+		// serialize to MessagePack
+		std::string to_msgpack() const;
+
+		// parse a MessagePack encoded value
+		// Binary values are decoded as strings, extension types are not supported.
+		static Json from_msgpack(const char* begin, const char* end, const parse_limits& limits = parse_limits());
+
+		// parse a MessagePack encoded value without throwing
+		// Only `parse_result::offset` is set on failure, there are no lines in binary data.
+		static parse_result from_msgpack(const char* begin, const char* end, Json& out, const parse_limits& limits = parse_limits());
+
+		// ================================
+		//              CBOR
+		// ================================
+
+		// serialize to CBOR (RFC 8949) using the preferred serialization, writing to the sink
+		// see also `cbor_encoder`
+		void to_cbor(output_sink& sink) const;
+
+		// serialize to CBOR (RFC 8949)
+		std::string to_cbor() const;
+
+		// parse a CBOR encoded value
+		// Byte strings are decoded as strings, tags are ignored. To decode a stream
+		// without buffering the whole message, use `cbor_decoder`.
+		static Json from_cbor(const char* begin, const char* end, const parse_limits& limits = parse_limits());
+
+		// parse a CBOR encoded value without throwing
+		// Only `parse_result::offset` is set on failure, there are no lines in binary data.
+		static parse_result from_cbor(const char* begin, const char* end, Json& out, const parse_limits& limits = parse_limits());
+
+		// ================================
+		//           JSON Patch
+		// ================================
+
+		// Compute the JSON Patch (RFC 6902) that transforms `from` into `to`.
+		// Identical subtrees are skipped, objects are compared by merging their sorted keys and
+		// arrays are aligned on their longest common subsequence (see `diff_options::max_lcs_size`),
+		// so the patch is made of `add`, `remove` and `replace` operations on the changed values only.
+		// example:
+		// ```cpp
+		// Json patch = Json::diff(last_sent, state);
+		// if (!patch.as_array().empty())
+		//     send(patch.dump());
+		// ```
+		static Json diff(const Json& from, const Json& to, const diff_options& options = diff_options());
+
+		// Apply a JSON Patch (RFC 6902) in place.
+		// Each path is resolved once, values are moved (not copied) where the operation allows it
+		// and the patch is transactional: on failure the operations already applied are undone
+		// from a log of the values they replaced or removed, and the document is left unchanged.
+		// Packed arrays are unpacked only when an element is added, removed or replaced (and packed
+		// again if the patch fails), reading them with `test` or as the `from` of `copy` does not change them.
+		// example:
+		// ```cpp
+		// json_lite::patch_result result = state.apply_patch(Json::parse(message));
+		// if (!result)
+		//     printf("operation %d: %s\n", (int)result.operation, to_string(result.error));
+		// ```
+		patch_result apply_patch(const Json& patch);
+
+		// Apply a JSON Patch moving the values out of it, see `apply_patch(const Json&)`.
+		// On failure the content of `patch` is unspecified.
+		patch_result apply_patch(Json&& patch);
+
+		// Apply a JSON Merge Patch (RFC 7396) in place: members set to `null` are removed,
+		// objects are merged recursively and any other value replaces the target.
+		// example:
+		// ```cpp
+		// config.apply_merge_patch(Json::parse("{\"wifi\":{\"ssid\":\"home\",\"password\":null}}"));
+		// ```
+		void apply_merge_patch(const Json& patch);
+
+		// Apply a JSON Merge Patch moving the values out of it, see `apply_merge_patch(const Json&)`.
+		void apply_merge_patch(Json&& patch);
+
 #ifdef JSON_LITE_PRINTABLE
 		// implements the Printable interface
 		size_t printTo(Print& p) const override;
@@ -495,6 +1185,9 @@ namespace json_lite
 			std::string string;
 			std::vector<Json> array;
 			std::map<std::string, Json> object;
+			std::vector<Int> integer_array;
+			std::vector<Float> floating_array;
+			json_raw_number raw_number;
 
 			value_union_t();
 			value_union_t(const value_union_t& other) = delete;
@@ -511,16 +1204,899 @@ namespace json_lite
 			value_union_t(std::vector<Json>&& value);
 			value_union_t(const std::map<std::string, Json>& value);
 			value_union_t(std::map<std::string, Json>&& value);
+			value_union_t(const std::vector<Int>& value);
+			value_union_t(std::vector<Int>&& value);
+			value_union_t(const std::vector<Float>& value);
+			value_union_t(std::vector<Float>&& value);
+			value_union_t(json_raw_number&& value);
 
 			~value_union_t() noexcept {};
 		} m_value;
 	};
 
+	// ================================================================
+	//                         SAX interface
+	// ================================================================
+
+	// Receives a document as a sequence of events, in document order.
+	// This is used by the incremental decoders (e.g. `cbor_decoder`) so that a
+	// document can be processed without building a `Json` or buffering the input.
+	// Object members are reported as `key()` followed by the value.
+	class json_sax
+	{
+	public:
+
+		// the size passed to `begin_array()` and `begin_object()` when it is not known in advance
+		static const size_t unknown_size = static_cast<size_t>(-1);
+
+		virtual ~json_sax() {}
+
+		virtual void null_value() = 0;
+		virtual void boolean_value(bool value) = 0;
+		virtual void integer_value(json_int value) = 0;
+		virtual void floating_point_value(json_float value) = 0;
+		virtual void string_value(const char* data, size_t size) = 0;
+
+		// `size` is the number of elements or `unknown_size`
+		virtual void begin_array(size_t size) = 0;
+		virtual void end_array() = 0;
+
+		// `size` is the number of members or `unknown_size`
+		virtual void begin_object(size_t size) = 0;
+		virtual void key(const char* data, size_t size) = 0;
+		virtual void end_object() = 0;
+	};
+
+	// A `json_sax` handler that builds a `Json` value.
+	// example:
+	// ```cpp
+	// Json json;
+	// json_sax_builder builder(json);
+	// cbor_decoder decoder(builder);
+	// ```
+	class json_sax_builder : public json_sax
+	{
+	public:
+
+		explicit json_sax_builder(Json& out) : m_out(out) {}
+
+		void null_value() override;
+		void boolean_value(bool value) override;
+		void integer_value(json_int value) override;
+		void floating_point_value(json_float value) override;
+		void string_value(const char* data, size_t size) override;
+		void begin_array(size_t size) override;
+		void end_array() override;
+		void begin_object(size_t size) override;
+		void key(const char* data, size_t size) override;
+		void end_object() override;
+
+	private:
+
+		// the location of the next value
+		Json& next_value();
+
+		Json& m_out;
+		std::vector<Json*> m_stack;
+		std::string m_key;
+	};
+
+	// ================================================================
+	//                          JSON parser
+	// ================================================================
+
+	// A reusable parser, configured once.
+	// `Json::parse()` creates its stacks and buffers on every call, a `json_parser` keeps them
+	// (with their capacity) between calls: when many small messages are parsed, keep one per thread.
+	// Together with `parse_options::recycle`, parsing messages of the same shape reaches a steady
+	// state without allocations.
+	// example:
+	// ```cpp
+	// json_lite::parse_options options;
+	// options.max_depth = 32;
+	// options.recycle = true;
+	// json_lite::json_parser parser(options);
+	// Json message;
+	// while (receive(buffer))
+	//     if (parser.parse(buffer.data(), buffer.data() + buffer.size(), message))
+	//         handle(message);
+	// ```
+	class json_parser
+	{
+	public:
+
+		explicit json_parser(const parse_options& options = parse_options());
+
+		~json_parser();
+
+		json_parser(const json_parser&) = delete;
+		json_parser& operator=(const json_parser&) = delete;
+
+		// parse a JSON value into `out` without throwing, as `Json::parse(begin, end, out, options)`
+		parse_result parse(const char* begin, const char* end, Json& out);
+
+		// parse a JSON value from a string into `out` without throwing
+		parse_result parse(const std::string& str, Json& out) { return parse(str.data(), str.data() + str.size(), out); }
+
+		// parse a JSON value, throws `Json::parsing_error` on failure
+		Json parse(const char* begin, const char* end);
+
+		// parse a JSON value from a string, throws `Json::parsing_error` on failure
+		Json parse(const std::string& str) { return parse(str.data(), str.data() + str.size()); }
+
+		// the options given to the constructor
+		const parse_options& options() const;
+
+	private:
+
+		struct impl;
+
+		std::unique_ptr<impl> m_impl;
+	};
+
+	// Incremental JSON parser.
+	// Bytes can be fed in chunks of any size as they arrive (e.g. from a socket), the values are
+	// reported to a `json_sax` handler as soon as they are complete. Only the token being read
+	// and the stack of open containers are kept in memory, never the whole text.
+	// It accepts the same documents and reports the same errors as `Json::parse()`, except that
+	// a string fails as soon as it exceeds `parse_limits::max_string_length` and that
+	// `parse_limits::max_input_size` only counts the bytes up to the end of the value.
+	// The end of a number is only known at the next byte: call `finish()` at the end of the input.
+	// See also `async_parse()` in `json_lite_async.hpp`.
+	// example:
+	// ```cpp
+	// Json json;
+	// json_sax_builder builder(json);
+	// json_push_parser parser(builder);
+	// while (!parser.done() && parser.result())
+	// {
+	//     const size_t size = read_some(buffer, sizeof(buffer));
+	//     if (size == 0)
+	//         parser.finish();
+	//     else
+	//         parser.feed(buffer, size);
+	// }
+	// ```
+	class json_push_parser
+	{
+	public:
+
+		explicit json_push_parser(json_sax& handler, const parse_limits& limits = parse_limits());
+
+		~json_push_parser();
+
+		json_push_parser(const json_push_parser&) = delete;
+		json_push_parser& operator=(const json_push_parser&) = delete;
+
+		// feed the next bytes of the input
+		// Returns the number of bytes consumed: all of them unless the top level value was
+		// completed (the remaining bytes follow the value) or an error occurred.
+		size_t feed(const char* data, size_t size);
+
+		// the input ended: completes a top level number or fails
+		void finish();
+
+		// checks if a complete top level value was parsed
+		bool done() const;
+
+		// the error state, `parse_result::offset` counts the bytes from the beginning of the stream
+		const parse_result& result() const;
+
+		// prepare to parse a new value (e.g. the next line of a JSON Lines stream)
+		void reset();
+
+	private:
+
+		struct impl;
+
+		std::unique_ptr<impl> m_impl;
+	};
+
+	// ================================================================
+	//                          JSON cursor
+	// ================================================================
+
+	// the tokens returned by `json_cursor::next()`
+	enum class json_token
+	{
+		null_value,
+		boolean,
+		integer,
+		floating_point,
+		string,
+		key,
+		begin_array,
+		end_array,
+		begin_object,
+		end_object,
+		end,   // the document is complete
+		error  // see `json_cursor::result()`
+	};
+
+	// Pull parser: reads a document one token at a time, without building it.
+	// The memory used depends on the nesting depth only, so arbitrarily long arrays can be
+	// processed in constant memory: `for_each_element()` parses one element at a time into the
+	// same `Json` and `skip_value()` jumps over the values that are not needed.
+	// The accepted syntax, the leniencies and the limits are the same of `Json::parse()`.
+	// example:
+	// ```cpp
+	// json_cursor cursor(text.data(), text.data() + text.size());
+	// cursor.for_each_element([](Json& record) {
+	//     process(record);
+	// });
+	// if (!cursor.result())
+	//     printf("error at %d:%d\n", (int)cursor.result().line, (int)cursor.result().column);
+	// ```
+	class json_cursor
+	{
+	public:
+
+		// the input must stay valid while the cursor is used
+		json_cursor(const char* begin, const char* end, const parse_options& options = parse_options());
+
+		~json_cursor();
+
+		json_cursor(const json_cursor&) = delete;
+		json_cursor& operator=(const json_cursor&) = delete;
+
+		// read the next token, `end` after the document and `error` on failure
+		json_token next();
+
+		// the value of the last `boolean` token
+		bool boolean() const;
+
+		// the value of the last `integer` token
+		json_int integer() const;
+
+		// the value of the last `floating_point` token
+		json_float floating_point() const;
+
+		// the unescaped value of the last `string` or `key` token, valid until the next call
+		const std::string& string() const;
+
+		// Skip the next value without building it: containers are skipped by matching the brackets,
+		// their content is not validated and they count as a single node for `parse_limits::max_nodes`.
+		// Before a key, the whole member is skipped.
+		// Returns false, consuming nothing, at the end of a container or of the document, or on errors.
+		bool skip_value();
+
+		// Parse the next value into `out`, as `Json::parse()` would.
+		// Returns false, consuming nothing, before a key, at the end of a container or of the document, or on errors.
+		bool read_value(Json& out);
+
+		// Skip the next value as `skip_value()` and set [`begin`, `end`) to its text, to copy or forward it as it is.
+		// As for `skip_value()`, the content of containers is not validated.
+		// Returns false, consuming nothing, before a key, at the end of a container or of the document, or on errors.
+		bool read_raw(const char*& begin, const char*& end);
+
+		// Parse the elements of the next value, an array, one at a time calling `function(Json&)`
+		// on each of them. The same `Json` is reused for every element.
+		// Returns false if the value is not an array or on errors.
+		template <class Function>
+		bool for_each_element(Function function)
+		{
+			if (next() != json_token::begin_array)
+				return false;
+			while (read_value(m_element))
+				function(m_element);
+			return result().ok() && next() == json_token::end_array;
+		}
+
+		// number of open arrays and objects
+		size_t depth() const;
+
+		// the error state, on failure `offset`, `line` and `column` locate the error
+		const parse_result& result() const;
+
+	private:
+
+		struct impl;
+
+		std::unique_ptr<impl> m_impl;
+		Json m_element;
+	};
+
+	// ================================================================
+	//                          JSON path
+	// ================================================================
+
+	// A compiled JSONPath expression, the subset that can be evaluated in a single pass:
+	//  - `$` the root, it must be the first character
+	//  - `.name` or `['name']` (`["name"]`) a member, `\` escapes quotes and backslashes in brackets
+	//  - `[3]` an element (negative indices and slices are not supported)
+	//  - `.*` or `[*]` every member or element
+	//  - `..name`, `..[3]`, `..*` recursive descent, at any depth below
+	// example:
+	// ```cpp
+	// json_lite::json_path path("$.events[*].payload.temperature");
+	// ```
+	class json_path
+	{
+	public:
+
+		// the root only
+		json_path() = default;
+
+		// compile `expression`, throws `std::invalid_argument` if it is not valid
+		explicit json_path(const char* expression);
+
+		// compile `expression` into `out` without throwing, returns false (leaving `out` unchanged) if it is not valid
+		static bool parse(const char* expression, json_path& out);
+
+	private:
+
+		friend class json_query;
+
+		struct step
+		{
+			enum class kind { name, index, wildcard };
+
+			kind selector;
+			bool descendant; // `..`, also applied to the descendants of the children
+			std::string name;
+			size_t index;
+		};
+
+		std::vector<step> m_steps;
+	};
+
+	// Streaming evaluation of a `json_path` over a `json_cursor`: the matching values are returned
+	// one at a time, parsed (`next()`) or as text (`next_raw()`), and every other subtree is skipped
+	// without building it. Only the open containers and the current match are kept in memory, so
+	// documents of any size can be queried.
+	// The values are returned in document order and every member is visited, duplicate keys included.
+	// A value matching inside another match (e.g. with `$..a` on `{"a":{"a":1}}`) is not returned
+	// separately, it is part of the enclosing one.
+	// The cursor must be before the document (or before a value, that is queried as the root)
+	// and the path and the cursor must outlive the query.
+	// example:
+	// ```cpp
+	// json_path path("$.events[*].payload.temperature");
+	// json_cursor cursor(begin, end); // e.g. a memory mapped file
+	// json_query query(path, cursor);
+	// Json temperature;
+	// while (query.next(temperature))
+	//     record((json_float)temperature);
+	// if (!cursor.result())
+	//     report(cursor.result());
+	// ```
+	class json_query
+	{
+	public:
+
+		json_query(const json_path& path, json_cursor& cursor) : m_path(path), m_cursor(cursor) {}
+
+		json_query(const json_query&) = delete;
+		json_query& operator=(const json_query&) = delete;
+
+		// Parse the next matching value into `out`.
+		// Returns false when there are no more matches or on errors, see `json_cursor::result()`.
+		bool next(Json& out);
+
+		// Set [`begin`, `end`) to the text of the next matching value, see `json_cursor::read_raw()`.
+		// Returns false when there are no more matches or on errors, see `json_cursor::result()`.
+		bool next_raw(const char*& begin, const char*& end);
+
+		// Parse the matching values one at a time calling `function(Json&)` on each of them.
+		// The same `Json` is reused for every value. Returns false on errors.
+		template <class Function>
+		bool for_each(Function function)
+		{
+			while (next(m_value))
+				function(m_value);
+			return m_cursor.result().ok();
+		}
+
+	private:
+
+		// an open container with matching descendants
+		struct frame
+		{
+			size_t states_begin; // the steps to apply to the children, in `m_states`
+			size_t states_end;
+			size_t index;        // the index of the next element of an array
+			bool object;
+		};
+
+		// move the cursor before the next matching value, returns false if there are no more
+		bool find();
+
+		// after a failed read at a match: close the array that ended there, false on errors
+		bool close_array();
+
+		// forget the innermost container, its end was read
+		void pop();
+
+		const json_path& m_path;
+		json_cursor& m_cursor;
+		std::vector<frame> m_frames;
+		std::vector<size_t> m_states;
+		bool m_started = false;
+		Json m_value;
+	};
+
+	// ================================================================
+	//                          JSON writer
+	// ================================================================
+
+	// Streaming JSON writer: writes the same text of `Json::dump()` straight to a sink,
+	// without building a `Json`. A small stack of the open containers checks the nesting
+	// (a misplaced key, value or end throws `std::runtime_error`) and places the commas.
+	// It is a `json_sax` handler, so it can also serialize any event source (e.g. `cbor_decoder`).
+	// example:
+	// ```cpp
+	// json_writer writer(sink);
+	// writer.begin_object();
+	// writer.key("readings");
+	// writer.begin_array();
+	// for (...)
+	//     writer.value(reading); // numbers, strings, booleans, nullptr or a whole `Json`
+	// writer.end_array();
+	// writer.end_object();
+	// writer.flush();
+	// ```
+	class json_writer : public json_sax
+	{
+	public:
+
+		explicit json_writer(output_sink& sink) : m_out(sink) {}
+
+		void null_value() override;
+		void boolean_value(bool value) override;
+		void integer_value(json_int value) override;
+		void floating_point_value(json_float value) override;
+		void string_value(const char* data, size_t size) override;
+		void begin_array(size_t size) override;
+		void end_array() override;
+		void begin_object(size_t size) override;
+		void key(const char* data, size_t size) override;
+		void end_object() override;
+
+		// start an array
+		void begin_array() { begin_array(unknown_size); }
+
+		// start an object
+		void begin_object() { begin_object(unknown_size); }
+
+		// write the key of the next member of the current object
+		void key(const char* key) { this->key(key, strlen(key)); }
+
+		// write the key of the next member of the current object
+		void key(const std::string& key) { this->key(key.data(), key.size()); }
+
+		// Write a key known not to need escaping (no quotes, backslashes or control characters),
+		// e.g. a literal, it is copied as it is without scanning it.
+		// example:
+		// ```cpp
+		// writer.clean_key("temperature", 11);
+		// ```
+		void clean_key(const char* data, size_t size);
+
+		// write a null value
+		void value(std::nullptr_t) { null_value(); }
+
+		// write a boolean value
+		void value(bool value) { boolean_value(value); }
+
+		// write an integer value (any integral type except `bool`)
+		template <class T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, int>::type = 0>
+		void value(T value) { integer_value(static_cast<json_int>(value)); }
+
+		// write a floating point value
+		template <class T, typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0>
+		void value(T value) { floating_point_value(static_cast<json_float>(value)); }
+
+		// write a string value
+		void value(const char* value) { string_value(value, strlen(value)); }
+
+		// write a string value
+		void value(const std::string& value) { string_value(value.data(), value.size()); }
+
+		// write a whole `Json` value (e.g. a subtree built in memory)
+		void value(const Json& json);
+
+		// write the buffered bytes to the sink
+		void flush() { m_out.flush(); }
+
+	private:
+
+		// checks that a value can be written here and writes the comma before it
+		void before_value();
+
+		// checks that a key can be written here and writes the comma before it
+		void before_key();
+
+		// ends the current container, `object` tells which one is expected
+		void end_container(bool object);
+
+		struct frame
+		{
+			bool object;
+			bool empty;
+			bool after_key; // a key has been written, the value must follow
+		};
+
+		buffered_sink m_out;
+		std::vector<frame> m_stack;
+		std::string m_scratch;
+		bool m_done = false;
+	};
+
+	// ================================================================
+	//                              CBOR
+	// ================================================================
+
+	// Streaming CBOR (RFC 8949) encoder.
+	// It is a `json_sax` handler, so it can encode any event source, and uses the
+	// preferred serialization: shortest integer and length arguments and the smallest
+	// floating point format that is lossless. Arrays and objects started with
+	// `json_sax::unknown_size` are encoded with indefinite length, this is
+	// useful to stream containers whose size is not known in advance.
+	// example:
+	// ```cpp
+	// cbor_encoder encoder(sink);
+	// encoder.begin_array(json_sax::unknown_size);
+	// for (...)
+	//     encoder.value(reading);
+	// encoder.end_array();
+	// ```
+	class cbor_encoder : public json_sax
+	{
+	public:
+
+		explicit cbor_encoder(output_sink& sink) : m_out(sink) {}
+
+		void null_value() override;
+		void boolean_value(bool value) override;
+		void integer_value(json_int value) override;
+		void floating_point_value(json_float value) override;
+		void string_value(const char* data, size_t size) override;
+		void begin_array(size_t size) override;
+		void end_array() override;
+		void begin_object(size_t size) override;
+		void key(const char* data, size_t size) override;
+		void end_object() override;
+
+		// encode a byte string (major type 2)
+		void byte_string_value(const char* data, size_t size);
+
+		// encode a whole `Json` value
+		void value(const Json& json);
+
+		// write the buffered bytes to the sink
+		void flush() { m_out.flush(); }
+
+	private:
+
+		void write_head(unsigned major, uint64_t argument);
+
+		buffered_sink m_out;
+		std::vector<bool> m_indefinite;
+	};
+
+	// Incremental CBOR (RFC 8949) decoder.
+	// Bytes can be fed in chunks of any size as they arrive, the decoded values
+	// are reported to a `json_sax` handler as soon as they are complete. Only the
+	// string being decoded and the stack of open containers are kept in memory.
+	// Byte strings are reported as strings, tags are ignored and map keys must be strings.
+	// example:
+	// ```cpp
+	// Json json;
+	// json_sax_builder builder(json);
+	// cbor_decoder decoder(builder);
+	// while (!decoder.done() && decoder.result())
+	//     decoder.feed(buffer, read_some(buffer, sizeof(buffer)));
+	// ```
+	class cbor_decoder
+	{
+	public:
+
+		explicit cbor_decoder(json_sax& handler, const parse_limits& limits = parse_limits());
+
+		// feed the next bytes of the input
+		// Returns the number of bytes consumed: all of them unless the top level item was
+		// completed (the remaining bytes belong to the next item of the sequence) or an error occurred.
+		size_t feed(const char* data, size_t size);
+
+		// checks if a complete top level item was decoded
+		bool done() const { return m_done; }
+
+		// the error state, `parse_result::offset` counts the bytes from the beginning of the stream
+		const parse_result& result() const { return m_result; }
+
+		// prepare to decode a new item (e.g. the next one of a CBOR sequence)
+		void reset();
+
+	private:
+
+		struct frame
+		{
+			uint64_t remaining; // items left in a definite length container (keys and values for maps)
+			bool is_object;
+			bool key_next;
+			bool indefinite;
+		};
+
+		enum class string_state { none, definite, chunk_header, chunk };
+
+		bool process_head();
+		bool begin_string(unsigned major, uint64_t length, bool indefinite);
+		void finish_string();
+		void complete_item();
+		bool fail(parse_error error);
+
+		json_sax& m_handler;
+		parse_limits m_limits;
+		std::vector<frame> m_frames;
+		unsigned char m_head[9];
+		size_t m_head_size = 0;
+		size_t m_head_needed = 0;
+		std::string m_string;
+		uint64_t m_string_remaining = 0;
+		string_state m_string_state = string_state::none;
+		unsigned m_string_major = 0;
+		bool m_string_is_key = false;
+		size_t m_nodes = 0;
+		size_t m_offset = 0;
+		bool m_done = false;
+		parse_result m_result;
+	};
+
+	// ================================================================
+	//                           Snapshots
+	// ================================================================
+
+	// A snapshot is a binary image of a `Json` document that can be loaded
+	// without parsing: it is a flat table of 16 byte nodes followed by a string table.
+	// Nodes are stored in breadth first order so the children of a container are
+	// contiguous (object members are stored as key, value pairs sorted by key),
+	// this makes array indexing O(1) and key lookup a binary search.
+	// Snapshots are written in the native byte order and can only be loaded on
+	// machines with the same byte order.
+
+	// write the snapshot of `json` to the sink
+	void save_snapshot(const Json& json, output_sink& sink);
+
+	// write the snapshot of `json` to a file, returns false on I/O errors
+	bool save_snapshot(const Json& json, const char* path);
+
+	class snapshot;
+
+	namespace detail
+	{
+		// opens the images of the `_json_static` literals, see json_lite_static.hpp
+		struct static_document;
+	}
+
+	// Read-only view of a value in a snapshot, it has the same accessors of a const `Json`.
+	// Views are small and cheap to copy, they are valid as long as the snapshot is.
+	class snapshot_value
+	{
+	public:
+
+		// get the type of the value
+		json_type type() const;
+
+		// get the internal data type of the value
+		json_data_type data_type() const;
+
+		// checks if the type is the given type
+		bool is(json_type type) const { return this->type() == type; }
+
+		// checks if the internal data type is the given data type
+		bool is(json_data_type type) const { return this->data_type() == type; }
+
+		// checks if the value is null
+		bool is_null() const { return is(json_type::null); }
+
+		// number of elements of an array, members of an object or bytes of a string
+		size_t size() const;
+
+		// get the element at the given index, the value must be an array
+		// Index must be in bounds, like `Json::operator[](size_t) const`.
+		snapshot_value operator[](size_t index) const;
+
+		// get the element at the given index, the value must be an array
+		// if the index is out of bounds, an exception will be thrown
+		snapshot_value at(size_t index) const;
+
+		// alias for `operator[](size_t)`, used to avoid ambiguity with `operator[](const char*)`
+		snapshot_value operator[](int index) const { return (*this)[static_cast<size_t>(index)]; }
+
+		// get the member with the given key, the value must be an object
+		// if the key does not exist, an exception will be thrown
+		snapshot_value operator[](const std::string& key) const { return at(key.c_str(), key.size()); }
+
+		// get the member with the given key, the value must be an object
+		// if the key does not exist, an exception will be thrown
+		snapshot_value operator[](const char* key) const { return at(key, strlen(key)); }
+
+		// get the member with the given key, the value must be an object
+		// if the key does not exist, an exception will be thrown
+		snapshot_value at(const std::string& key) const { return at(key.c_str(), key.size()); }
+
+		// get the member with the given key, the value must be an object
+		// if the key does not exist, an exception will be thrown
+		snapshot_value at(const char* key, size_t size) const;
+
+		bool has_key(const std::string& key) const;
+
+		// get the key of the member at the given index (members are sorted by key), the value must be an object
+		const char* key(size_t index) const;
+
+		// get the value of the member at the given index (members are sorted by key), the value must be an object
+		snapshot_value value(size_t index) const;
+
+		// checks if the value is not null, like `Json::operator bool()`
+		explicit operator bool() const;
+
+		// cast to `Int`, the value must be an integer
+		explicit operator json_int() const;
+
+		// cast to `Float`, the value must be a floating point number
+		explicit operator json_float() const;
+
+		// cast to `string`, the value must be a string
+		explicit operator std::string() const;
+
+		// cast to `const char*`, the value must be a string
+		// The string is null terminated and points into the snapshot.
+		explicit operator const char*() const;
+
+		// get the boolean value, the value must be a boolean
+		bool as_bool() const;
+
+		// copy the value into a `Json`
+		Json to_json() const;
+
+		// dump to a string, same as `to_json().dump()`
+		std::string dump() const;
+
+	private:
+
+		friend class snapshot;
+
+		snapshot_value(const snapshot* owner, uint64_t index) : m_owner(owner), m_index(index) {}
+
+		const snapshot* m_owner;
+		uint64_t m_index;
+	};
+
+	// A loaded snapshot, see `save_snapshot()`.
+	// Files are memory mapped where available (read into memory otherwise) and no
+	// parsing takes place: the values are read directly from the mapped nodes.
+	// example:
+	// ```cpp
+	// json_lite::snapshot data("reference.snap");
+	// auto name = (std::string)data.root()["items"][42]["name"];
+	// ```
+	class snapshot
+	{
+	public:
+
+		// creates an empty snapshot, use `open()` to load one
+		snapshot() {}
+
+		// load a snapshot file, throws on error
+		explicit snapshot(const char* path);
+
+		// use a snapshot that is already in memory (e.g. a flash partition), throws if it is not valid
+		// The memory is not copied and must outlive the snapshot. The nodes are checked in one linear
+		// pass (tree shape, string terminators), so a corrupted image is rejected instead of being read.
+		snapshot(const char* data, size_t size);
+
+		snapshot(const snapshot&) = delete;
+		snapshot& operator=(const snapshot&) = delete;
+
+		~snapshot();
+
+		// load a snapshot file, returns false on error
+		bool open(const char* path);
+
+		// use a snapshot that is already in memory, returns false if it is not valid
+		bool open(const char* data, size_t size);
+
+		// release the snapshot, the views become invalid
+		void close();
+
+		// checks if a snapshot is loaded
+		bool is_open() const { return m_node_count != 0; }
+
+		// get the root value
+		snapshot_value root() const;
+
+	private:
+
+		friend class snapshot_value;
+		friend struct detail::static_document;
+
+		// use a snapshot in memory, `check_nodes` false only checks the header (for images valid by construction)
+		snapshot(const char* data, size_t size, bool check_nodes);
+
+		bool open(const char* data, size_t size, bool check_nodes);
+
+		// get the node at the given index, throws if the index is not valid
+		const char* node(uint64_t index) const;
+
+		// get the string of a node, throws if the string is not in the string table
+		const char* string(const char* node, size_t& size) const;
+
+		const char* m_data = nullptr;
+		size_t m_size = 0;
+		void* m_mapping = nullptr;
+		std::vector<char> m_buffer;
+		const char* m_nodes = nullptr;
+		uint64_t m_node_count = 0;
+		const char* m_strings = nullptr;
+		uint64_t m_strings_size = 0;
+	};
+
+	// ================================================================
+	//                          Comparison
+	// ================================================================
+
+	// Deep equality: same types and values, recursively.
+	// Numbers are compared by value (an integer is equal to a floating point number with the
+	// same value) and packed arrays are equal to the generic arrays with the same elements.
+	// Identical values, different types and containers of different sizes are detected without
+	// visiting the elements.
+	bool operator==(const Json& a, const Json& b);
+
+	// negation of `operator==`
+	inline bool operator!=(const Json& a, const Json& b) { return !(a == b); }
+
+	// An immutable `Json` with its hash computed once. It is cheap to rehash (e.g. in a
+	// `std::unordered_map` key) and the comparison of different values usually stops at the hash.
+	// example:
+	// ```cpp
+	// std::unordered_set<json_lite::hashed_json> seen;
+	// if (!seen.insert(json_lite::hashed_json(std::move(message))).second)
+	//     return; // duplicated message
+	// ```
+	class hashed_json
+	{
+	public:
+
+		explicit hashed_json(const Json& value) : m_value(value), m_hash(m_value.hash()) {}
+
+		explicit hashed_json(Json&& value) : m_value(std::move(value)), m_hash(m_value.hash()) {}
+
+		// get the value
+		const Json& value() const { return m_value; }
+
+		// get the hash of the value, same as `value().hash()`
+		uint64_t hash() const { return m_hash; }
+
+	private:
+		Json m_value;
+		uint64_t m_hash;
+	};
+
+	inline bool operator==(const hashed_json& a, const hashed_json& b) { return a.hash() == b.hash() && a.value() == b.value(); }
+
+	inline bool operator!=(const hashed_json& a, const hashed_json& b) { return !(a == b); }
+
 	// ================================================================
 	//                       External functions
 	// ================================================================
 }
 
+// `Json` and `hashed_json` as keys of the unordered containers
+namespace std
+{
+	template <>
+	struct hash<json_lite::Json>
+	{
+		size_t operator()(const json_lite::Json& json) const { return static_cast<size_t>(json.hash()); }
+	};
+
+	template <>
+	struct hash<json_lite::hashed_json>
+	{
+		size_t operator()(const json_lite::hashed_json& json) const { return static_cast<size_t>(json.hash()); }
+	};
+}
+
 ////////////////////////////////////////////////////////////////
 inline std::ostream& operator<<(std::ostream& os, const json_lite::Json& json) {
 	os << json.dump();
@@ -0,0 +1,169 @@
+#pragma once
+
+// Asynchronous parsing with C++20 coroutines, on top of `json_push_parser`.
+// This header needs a compiler with coroutine support, `json_lite.hpp` itself stays C++11.
+
+#include "json_lite.hpp"
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <utility>
+
+#define JSON_LITE_ASYNC
+
+namespace json_lite
+{
+	// ================================================================
+	//                          Async parsing
+	// ================================================================
+
+	// A source of bytes read asynchronously: `co_await source.async_read_some(data, size)`
+	// reads at most `size` bytes into `data` and yields the number of bytes read, 0 at the end of the input.
+	// Sockets, pipes and test doubles only need to provide this method (and an awaitable for its result).
+	template <class Source>
+	concept async_byte_source = requires(Source& source, char* data, size_t size)
+	{
+		source.async_read_some(data, size);
+	};
+
+	// A lazy coroutine producing a `T`, returned by `async_parse()`.
+	// It starts when awaited and resumes the awaiting coroutine when it completes.
+	// Without a coroutine to await it, e.g. from an event loop, it can be driven with `resume()`
+	// until `done()` and its value taken with `get()`.
+	template <class T>
+	class async_task
+	{
+	public:
+
+		struct promise_type
+		{
+			// resumes the awaiting coroutine, if any
+			struct final_awaiter
+			{
+				bool await_ready() noexcept { return false; }
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+				{
+					const std::coroutine_handle<> continuation = handle.promise().continuation;
+					return continuation ? continuation : std::noop_coroutine();
+				}
+				void await_resume() noexcept {}
+			};
+
+			async_task get_return_object() { return async_task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+			std::suspend_always initial_suspend() noexcept { return {}; }
+			final_awaiter final_suspend() noexcept { return {}; }
+			void return_value(T result) { value = std::move(result); }
+
+			void unhandled_exception()
+			{
+#ifdef JSON_LITE_EXCEPTIONS
+				exception = std::current_exception();
+#else
+				std::abort();
+#endif
+			}
+
+			T value;
+			std::exception_ptr exception;
+			std::coroutine_handle<> continuation;
+		};
+
+		async_task(async_task&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+
+		async_task& operator=(async_task&& other) noexcept
+		{
+			if (this != &other)
+			{
+				if (m_handle)
+					m_handle.destroy();
+				m_handle = std::exchange(other.m_handle, nullptr);
+			}
+			return *this;
+		}
+
+		~async_task()
+		{
+			if (m_handle)
+				m_handle.destroy();
+		}
+
+		// checks if the coroutine completed
+		bool done() const { return m_handle.done(); }
+
+		// run the coroutine until it completes or waits for the source
+		void resume() { m_handle.resume(); }
+
+		// the value of a completed coroutine, rethrows its exception
+		T get()
+		{
+#ifdef JSON_LITE_EXCEPTIONS
+			if (m_handle.promise().exception)
+				std::rethrow_exception(m_handle.promise().exception);
+#endif
+			return std::move(m_handle.promise().value);
+		}
+
+		bool await_ready() const noexcept { return m_handle.done(); }
+
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+		{
+			m_handle.promise().continuation = awaiting;
+			return m_handle;
+		}
+
+		T await_resume() { return get(); }
+
+	private:
+
+		explicit async_task(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+
+		std::coroutine_handle<promise_type> m_handle;
+	};
+
+	// Parse a JSON value from `source` into `out` without throwing, suspending while the source has no bytes.
+	// Only a buffer of `buffer_size` bytes, the token being read and the value are kept while waiting,
+	// never the whole text. The bytes read after the value are discarded.
+	// `source` and `out` must outlive the returned task.
+	// example:
+	// ```cpp
+	// Json json;
+	// json_lite::parse_result result = co_await json_lite::async_parse(socket, json);
+	// ```
+	template <async_byte_source Source>
+	async_task<parse_result> async_parse(Source& source, Json& out, parse_limits limits = parse_limits(), size_t buffer_size = 512)
+	{
+		json_sax_builder builder(out);
+		json_push_parser parser(builder, limits);
+		const std::unique_ptr<char[]> buffer(new char[buffer_size]);
+		while (!parser.done() && parser.result())
+		{
+			const size_t size = co_await source.async_read_some(buffer.get(), buffer_size);
+			if (size == 0)
+				parser.finish();
+			else
+				parser.feed(buffer.get(), size);
+		}
+		co_return parser.result();
+	}
+
+	// Parse a JSON value from `source`, throws `Json::parsing_error` on failure.
+	// `source` must outlive the returned task.
+	// example:
+	// ```cpp
+	// Json json = co_await json_lite::async_parse(socket);
+	// ```
+	template <async_byte_source Source>
+	async_task<Json> async_parse(Source& source, parse_limits limits = parse_limits(), size_t buffer_size = 512)
+	{
+		Json json;
+		const parse_result result = co_await async_parse(source, json, limits, buffer_size);
+		if (!result)
+			JSON_LITE_THROW(Json::parsing_error(to_string(result.error)));
+		co_return json;
+	}
+}
+
+#endif
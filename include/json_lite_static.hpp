@@ -0,0 +1,690 @@
+#pragma once
+
+// Compile time JSON literals: `R"({...})"_json_static` is parsed by the compiler into a snapshot
+// image (see `save_snapshot()`) stored as constant data, and read through a `snapshot_value`.
+// This header needs C++20, `json_lite.hpp` itself stays C++11.
+
+#include "json_lite.hpp"
+
+#if __has_include(<version>)
+	#include <version>
+#endif
+
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L && \
+	defined(__cpp_consteval) && defined(__cpp_lib_constexpr_vector) && defined(__cpp_lib_bit_cast)
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <limits>
+
+#define JSON_LITE_STATIC
+
+namespace json_lite
+{
+	namespace detail
+	{
+		// the text of a `_json_static` literal, usable as a template argument
+		template <size_t N>
+		struct static_text
+		{
+			constexpr static_text(const char (&text)[N])
+			{
+				for (size_t i = 0; i < N; ++i)
+					data[i] = text[i];
+			}
+
+			char data[N];
+		};
+
+		// Not constexpr: reaching it while a literal is parsed at compile time makes the
+		// literal a compile error, the notes of the error show the `parse_error`.
+		inline void invalid_json_literal(parse_error error)
+		{
+			(void)error; // unused without exceptions, `JSON_LITE_THROW` aborts
+			JSON_LITE_THROW(Json::parsing_error(to_string(error)));
+		}
+
+		// ================================
+		//        Number conversion
+		// ================================
+
+		// an unsigned big integer, 32 bit limbs from the least significant, no leading zero limbs
+		using big_integer = std::vector<uint32_t>;
+
+		constexpr void big_multiply_add(big_integer& a, uint32_t factor, uint32_t addend)
+		{
+			uint64_t carry = addend;
+			for (uint32_t& limb : a)
+			{
+				const uint64_t value = uint64_t(limb) * factor + carry;
+				limb = static_cast<uint32_t>(value);
+				carry = value >> 32;
+			}
+			if (carry != 0)
+				a.push_back(static_cast<uint32_t>(carry));
+		}
+
+		constexpr size_t big_bit_length(const big_integer& a)
+		{
+			return a.empty() ? 0 : (a.size() - 1) * 32 + std::bit_width(a.back());
+		}
+
+		constexpr big_integer big_shift_left(const big_integer& a, size_t bits)
+		{
+			if (a.empty())
+				return a;
+			big_integer result(bits / 32, 0);
+			const unsigned shift = bits % 32;
+			uint32_t carry = 0;
+			for (uint32_t limb : a)
+			{
+				result.push_back((limb << shift) | carry);
+				carry = shift == 0 ? 0 : limb >> (32 - shift);
+			}
+			if (carry != 0)
+				result.push_back(carry);
+			return result;
+		}
+
+		constexpr int big_compare(const big_integer& a, const big_integer& b)
+		{
+			if (a.size() != b.size())
+				return a.size() < b.size() ? -1 : 1;
+			for (size_t i = a.size(); i-- > 0;)
+				if (a[i] != b[i])
+					return a[i] < b[i] ? -1 : 1;
+			return 0;
+		}
+
+		// `a -= b`, `a` must not be less than `b`
+		constexpr void big_subtract(big_integer& a, const big_integer& b)
+		{
+			uint64_t borrow = 0;
+			for (size_t i = 0; i < a.size(); ++i)
+			{
+				const uint64_t subtrahend = (i < b.size() ? b[i] : 0) + borrow;
+				borrow = a[i] < subtrahend ? 1 : 0;
+				a[i] = static_cast<uint32_t>(uint64_t(a[i]) + (borrow << 32) - subtrahend);
+			}
+			while (!a.empty() && a.back() == 0)
+				a.pop_back();
+		}
+
+		// The double nearest to `digits` × 10^`exponent` (ties to even), the same result of `strtod()`.
+		// `digits` are decimal digits without leading zeros.
+		// The quotient of two big integers is computed to 56 or 57 bits plus a sticky bit, enough to round exactly.
+		constexpr double decimal_to_double(const std::vector<char>& digits, long exponent)
+		{
+			if (digits.empty())
+				return 0;
+			// the value is less than 10^magnitude and at least 10^(magnitude - 1)
+			const long magnitude = exponent + static_cast<long>(digits.size());
+			if (magnitude > 310)
+				return std::numeric_limits<double>::infinity();
+			if (magnitude < -330)
+				return 0;
+
+			big_integer numerator;
+			for (char digit : digits)
+				big_multiply_add(numerator, 10, static_cast<uint32_t>(digit - '0'));
+			big_integer denominator(1, 1);
+			for (long i = 0; i < (exponent < 0 ? -exponent : exponent); ++i)
+				big_multiply_add(exponent < 0 ? denominator : numerator, 10, 0);
+
+			// value = quotient × 2^-scale, with a quotient of 56 or 57 bits
+			const long scale = 56 - (static_cast<long>(big_bit_length(numerator)) - static_cast<long>(big_bit_length(denominator)));
+			if (scale > 0)
+				numerator = big_shift_left(numerator, static_cast<size_t>(scale));
+			else
+				denominator = big_shift_left(denominator, static_cast<size_t>(-scale));
+			uint64_t quotient = 0;
+			for (int bit = 57; bit >= 0; --bit)
+			{
+				const big_integer shifted = big_shift_left(denominator, static_cast<size_t>(bit));
+				if (big_compare(numerator, shifted) >= 0)
+				{
+					big_subtract(numerator, shifted);
+					quotient |= uint64_t(1) << bit;
+				}
+			}
+			const bool sticky = !numerator.empty();
+
+			// round to 53 bits, or less for subnormal numbers
+			long binary_exponent = -scale;
+			long drop = static_cast<long>(std::bit_width(quotient)) - 53;
+			if (binary_exponent + drop < -1074)
+				drop = -1074 - binary_exponent;
+			if (drop > 57)
+				return 0;
+			uint64_t mantissa = quotient >> drop;
+			const uint64_t rest = quotient & ((uint64_t(1) << drop) - 1);
+			const uint64_t half = uint64_t(1) << (drop - 1);
+			if (rest > half || (rest == half && (sticky || (mantissa & 1) != 0)))
+				++mantissa;
+			binary_exponent += drop;
+			if (mantissa == uint64_t(1) << 53)
+			{
+				mantissa >>= 1;
+				++binary_exponent;
+			}
+			if (mantissa < uint64_t(1) << 52)
+				return std::bit_cast<double>(mantissa); // subnormal
+			const long biased = binary_exponent + 52 + 1023;
+			if (biased >= 2047)
+				return std::numeric_limits<double>::infinity();
+			return std::bit_cast<double>((uint64_t(biased) << 52) | (mantissa - (uint64_t(1) << 52)));
+		}
+
+		// ================================
+		//         Literal parsing
+		// ================================
+
+		// a value of a parsed literal
+		struct static_node
+		{
+			json_data_type type = json_data_type::null;
+			uint64_t payload = 0;         // booleans, integers and floating point bits
+			size_t string_begin = 0;      // strings: the content in the string pool
+			size_t string_size = 0;
+			std::vector<size_t> children; // arrays: the elements, objects: key and value pairs sorted by key
+		};
+
+		// The parser of `_json_static` literals, at compile time.
+		// It accepts what `Json::parse()` accepts and converts numbers the same way, except that
+		// content after the value is an error. Objects keep the last of repeated keys, like `Json::parse()`.
+		class static_parser
+		{
+		public:
+
+			constexpr static_parser(const char* text, size_t size) : m_text(text), m_size(size) {}
+
+			// parse the literal, the root is the first node
+			constexpr void parse()
+			{
+				enum class state { value, key, after_value };
+
+				skip_whitespace();
+				if (m_p == m_size)
+					invalid_json_literal(parse_error::empty_input);
+				std::vector<size_t> frames; // the open containers
+				size_t key = 0;             // the key of the member being parsed
+				state s = state::value;
+				while (true)
+				{
+					switch (s)
+					{
+					case state::value:
+					{
+						skip_whitespace();
+						expect_more();
+						const size_t node = m_nodes.size();
+						m_nodes.emplace_back();
+						if (!frames.empty())
+						{
+							std::vector<size_t>& children = m_nodes[frames.back()].children;
+							if (m_nodes[frames.back()].type == json_data_type::object)
+								children.push_back(key);
+							children.push_back(node);
+						}
+						const char c = m_text[m_p];
+						if (c == '[' || c == '{')
+						{
+							m_nodes[node].type = c == '{' ? json_data_type::object : json_data_type::array;
+							frames.push_back(node);
+							++m_p;
+							skip_whitespace();
+							if (m_p != m_size && m_text[m_p] == (c == '{' ? '}' : ']'))
+							{
+								// empty container
+								frames.pop_back();
+								++m_p;
+								s = state::after_value;
+							}
+							else
+								s = c == '{' ? state::key : state::value;
+						}
+						else
+						{
+							parse_scalar(node);
+							s = state::after_value;
+						}
+						break;
+					}
+
+					case state::key:
+						skip_whitespace();
+						expect_more();
+						if (m_text[m_p] != '"')
+							invalid_json_literal(parse_error::unexpected_character);
+						key = m_nodes.size();
+						m_nodes.emplace_back();
+						parse_string(key);
+						skip_whitespace();
+						expect_more();
+						if (m_text[m_p] != ':')
+							invalid_json_literal(parse_error::unexpected_character);
+						++m_p;
+						s = state::value;
+						break;
+
+					case state::after_value:
+						skip_whitespace();
+						if (frames.empty())
+						{
+							// a literal holds a single value
+							if (m_p != m_size)
+								invalid_json_literal(parse_error::unexpected_character);
+							return;
+						}
+						expect_more();
+						{
+							const bool is_object = m_nodes[frames.back()].type == json_data_type::object;
+							const char closing = is_object ? '}' : ']';
+							if (m_text[m_p] == ',')
+							{
+								++m_p;
+								skip_whitespace();
+								if (m_p != m_size && m_text[m_p] == closing)
+								{
+									// trailing comma, accepted
+									close(frames);
+									++m_p;
+								}
+								else
+									s = is_object ? state::key : state::value;
+							}
+							else if (m_text[m_p] == closing)
+							{
+								close(frames);
+								++m_p;
+							}
+							else
+								invalid_json_literal(parse_error::unexpected_character);
+						}
+						break;
+					}
+				}
+			}
+
+			// the nodes in breadth first order, the order of a snapshot
+			constexpr std::vector<size_t> breadth_first() const
+			{
+				std::vector<size_t> order(1, 0);
+				for (size_t i = 0; i < order.size(); ++i)
+					for (size_t child : m_nodes[order[i]].children)
+						order.push_back(child);
+				return order;
+			}
+
+			constexpr const std::vector<static_node>& nodes() const { return m_nodes; }
+
+			constexpr const std::vector<char>& strings() const { return m_strings; }
+
+		private:
+
+			constexpr void skip_whitespace()
+			{
+				while (m_p != m_size && (m_text[m_p] == ' ' || (m_text[m_p] >= '\t' && m_text[m_p] <= '\r')))
+					++m_p;
+			}
+
+			constexpr void expect_more() const
+			{
+				if (m_p == m_size)
+					invalid_json_literal(parse_error::unexpected_end);
+			}
+
+			constexpr bool matches(const char* literal, size_t size) const
+			{
+				if (m_size - m_p < size)
+					return false;
+				for (size_t i = 0; i < size; ++i)
+					if (m_text[m_p + i] != literal[i])
+						return false;
+				return true;
+			}
+
+			constexpr void parse_scalar(size_t node)
+			{
+				switch (m_text[m_p])
+				{
+				case 'n':
+					if (!matches("null", 4))
+						invalid_json_literal(parse_error::invalid_literal);
+					m_p += 4;
+					break;
+				case 't':
+				case 'f':
+				{
+					const bool value = m_text[m_p] == 't';
+					if (!matches(value ? "true" : "false", value ? 4 : 5))
+						invalid_json_literal(parse_error::invalid_literal);
+					m_nodes[node].type = json_data_type::boolean;
+					m_nodes[node].payload = value ? 1 : 0;
+					m_p += value ? 4 : 5;
+					break;
+				}
+				case '"':
+					parse_string(node);
+					break;
+				case '-':
+				case '.':
+				case '0': case '1': case '2': case '3': case '4':
+				case '5': case '6': case '7': case '8': case '9':
+					parse_number(node);
+					break;
+				default:
+					invalid_json_literal(parse_error::unexpected_character);
+				}
+			}
+
+			constexpr void parse_string(size_t node)
+			{
+				const size_t begin = m_strings.size();
+				++m_p; // skip the opening quote
+				while (true)
+				{
+					expect_more();
+					char c = m_text[m_p++];
+					if (c == '"')
+						break;
+					if (c == '\\')
+					{
+						expect_more();
+						switch (m_text[m_p++])
+						{
+						case '"': c = '"'; break;
+						case '\\': c = '\\'; break;
+						case '/': c = '/'; break;
+						case 'b': c = '\b'; break;
+						case 'f': c = '\f'; break;
+						case 'n': c = '\n'; break;
+						case 'r': c = '\r'; break;
+						case 't': c = '\t'; break;
+						case 'u': invalid_json_literal(parse_error::unsupported_unicode); break;
+						default: invalid_json_literal(parse_error::invalid_escape); break;
+						}
+					}
+					m_strings.push_back(c);
+				}
+				m_nodes[node].type = json_data_type::string;
+				m_nodes[node].string_begin = begin;
+				m_nodes[node].string_size = m_strings.size() - begin;
+			}
+
+			static constexpr bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+			// the same token of the tokenizer, validated and converted as `strtoll()` and `strtod()` would
+			constexpr void parse_number(size_t node)
+			{
+				const size_t begin = m_p;
+				bool is_float = false;
+				if (m_text[m_p] == '-')
+					++m_p;
+				while (m_p != m_size)
+				{
+					const char c = m_text[m_p];
+					if (c == '.')
+						is_float = true;
+					else if (c == 'e' || c == 'E')
+					{
+						is_float = true;
+						if (m_p + 1 != m_size && (m_text[m_p + 1] == '+' || m_text[m_p + 1] == '-'))
+							++m_p;
+					}
+					else if (!is_digit(c))
+						break;
+					++m_p;
+				}
+
+				size_t q = begin;
+				const bool negative = m_text[q] == '-';
+				if (negative)
+					++q;
+				std::vector<char> digits; // significant digits
+				long exponent = 0;
+				bool has_digits = false;
+				for (; q != m_p && is_digit(m_text[q]); ++q)
+				{
+					has_digits = true;
+					if (!digits.empty() || m_text[q] != '0')
+						digits.push_back(m_text[q]);
+				}
+
+				if (!is_float && has_digits && digits.size() <= 19)
+				{
+					uint64_t magnitude = 0;
+					for (char digit : digits)
+						magnitude = magnitude * 10 + static_cast<uint64_t>(digit - '0');
+					const uint64_t limit = uint64_t(std::numeric_limits<json_int>::max()) + (negative ? 1 : 0);
+					if (magnitude <= limit)
+					{
+						m_nodes[node].type = json_data_type::integer;
+						m_nodes[node].payload = negative ? 0 - magnitude : magnitude;
+						return;
+					}
+					// out of range integers are stored as floating point
+				}
+
+				if (q != m_p && m_text[q] == '.')
+				{
+					for (++q; q != m_p && is_digit(m_text[q]); ++q)
+					{
+						has_digits = true;
+						--exponent;
+						if (!digits.empty() || m_text[q] != '0')
+							digits.push_back(m_text[q]);
+					}
+				}
+				if (!has_digits)
+					invalid_json_literal(parse_error::invalid_number);
+				if (q != m_p && (m_text[q] == 'e' || m_text[q] == 'E'))
+				{
+					++q;
+					const bool negative_exponent = q != m_p && m_text[q] == '-';
+					if (q != m_p && (m_text[q] == '+' || m_text[q] == '-'))
+						++q;
+					if (q == m_p || !is_digit(m_text[q]))
+						invalid_json_literal(parse_error::invalid_number);
+					long value = 0;
+					for (; q != m_p && is_digit(m_text[q]); ++q)
+						if (value < 100000)
+							value = value * 10 + (m_text[q] - '0');
+					exponent += negative_exponent ? -value : value;
+				}
+				if (q != m_p)
+					invalid_json_literal(parse_error::invalid_number);
+
+				while (!digits.empty() && digits.back() == '0')
+				{
+					digits.pop_back();
+					++exponent;
+				}
+				const double value = decimal_to_double(digits, exponent);
+				m_nodes[node].type = json_data_type::floating_point;
+				m_nodes[node].payload = std::bit_cast<uint64_t>(negative ? -value : value);
+			}
+
+			// same ordering as `std::string::compare`
+			constexpr bool key_less(size_t a, size_t b) const
+			{
+				const static_node& x = m_nodes[a];
+				const static_node& y = m_nodes[b];
+				const size_t size = x.string_size < y.string_size ? x.string_size : y.string_size;
+				for (size_t i = 0; i < size; ++i)
+				{
+					const unsigned char cx = static_cast<unsigned char>(m_strings[x.string_begin + i]);
+					const unsigned char cy = static_cast<unsigned char>(m_strings[y.string_begin + i]);
+					if (cx != cy)
+						return cx < cy;
+				}
+				return x.string_size < y.string_size;
+			}
+
+			// closes the container on top of the stack, object members are sorted and the last of repeated keys kept
+			constexpr void close(std::vector<size_t>& frames)
+			{
+				static_node& container = m_nodes[frames.back()];
+				frames.pop_back();
+				if (container.type != json_data_type::object)
+					return;
+
+				// the index of each member, the members with the same key are sorted by position
+				std::vector<size_t> members;
+				for (size_t i = 0; i < container.children.size(); i += 2)
+					members.push_back(i);
+				std::sort(members.begin(), members.end(), [&](size_t a, size_t b) {
+					const size_t key_a = container.children[a];
+					const size_t key_b = container.children[b];
+					if (key_less(key_a, key_b))
+						return true;
+					return !key_less(key_b, key_a) && a < b;
+				});
+				std::vector<size_t> children;
+				for (size_t i = 0; i < members.size(); ++i)
+				{
+					const size_t key = container.children[members[i]];
+					if (i + 1 < members.size() && !key_less(key, container.children[members[i + 1]]))
+						continue; // repeated, a later one wins
+					children.push_back(key);
+					children.push_back(container.children[members[i] + 1]);
+				}
+				container.children = children;
+			}
+
+			const char* m_text;
+			size_t m_size;
+			size_t m_p = 0;
+			std::vector<static_node> m_nodes;
+			std::vector<char> m_strings;
+		};
+
+		// ================================
+		//          Snapshot image
+		// ================================
+
+		// the layout of json_lite_snapshot.cpp: a 32 byte header, 16 byte nodes, the string table
+		const size_t static_header_size = 32;
+		const size_t static_node_size = 16;
+
+		template <size_t Size>
+		constexpr void put_native(std::array<char, Size>& image, size_t at, uint64_t value, size_t size)
+		{
+			for (size_t i = 0; i < size; ++i)
+			{
+				const size_t shift = std::endian::native == std::endian::little ? i * 8 : (size - 1 - i) * 8;
+				image[at + i] = static_cast<char>((value >> shift) & 0xff);
+			}
+		}
+
+		template <static_text Text>
+		consteval size_t static_image_size()
+		{
+			static_parser parser(Text.data, sizeof(Text.data) - 1);
+			parser.parse();
+			const std::vector<size_t> order = parser.breadth_first();
+			size_t strings_size = 0;
+			for (size_t node : order)
+				if (parser.nodes()[node].type == json_data_type::string)
+					strings_size += parser.nodes()[node].string_size + 1;
+			return static_header_size + order.size() * static_node_size + strings_size;
+		}
+
+		// the snapshot image of a literal, the same `save_snapshot()` would write for `Json::parse(text)`
+		template <static_text Text, size_t Size>
+		consteval std::array<char, Size> make_static_image()
+		{
+			static_parser parser(Text.data, sizeof(Text.data) - 1);
+			parser.parse();
+			const std::vector<size_t> order = parser.breadth_first();
+			const std::vector<static_node>& nodes = parser.nodes();
+
+			std::array<char, Size> image{};
+			const char magic[8] = { 'J', 'L', 'S', 'N', 'A', 'P', '\0', '\0' };
+			for (size_t i = 0; i < 8; ++i)
+				image[i] = magic[i];
+			put_native(image, 8, 1, 4); // version
+			put_native(image, 12, 0x01020304, 4); // byte order
+			put_native(image, 16, order.size(), 8);
+			const size_t strings_at = static_header_size + order.size() * static_node_size;
+			put_native(image, 24, Size - strings_at, 8);
+
+			// the children are assigned in the same order of the visit
+			uint64_t next_child = 1;
+			size_t next_string = 0;
+			for (size_t i = 0; i < order.size(); ++i)
+			{
+				const static_node& node = nodes[order[i]];
+				const size_t at = static_header_size + i * static_node_size;
+				uint64_t count = 0;
+				uint64_t payload = node.payload;
+				switch (node.type)
+				{
+				case json_data_type::string:
+					count = node.string_size;
+					payload = next_string;
+					for (size_t j = 0; j < node.string_size; ++j)
+						image[strings_at + next_string + j] = parser.strings()[node.string_begin + j];
+					next_string += node.string_size + 1;
+					break;
+				case json_data_type::array:
+				case json_data_type::object:
+					count = node.type == json_data_type::array ? node.children.size() : node.children.size() / 2;
+					payload = next_child;
+					next_child += node.children.size();
+					break;
+				default:
+					break;
+				}
+				if (count > 0xffffffff)
+					invalid_json_literal(parse_error::string_too_long);
+				put_native(image, at, static_cast<uint64_t>(node.type), 1);
+				put_native(image, at + 4, count, 4);
+				put_native(image, at + 8, payload, 8);
+			}
+			return image;
+		}
+
+		// the constant image of a literal, one per distinct text
+		template <static_text Text>
+		struct static_image
+		{
+			alignas(8) static constexpr std::array<char, static_image_size<Text>()> data = make_static_image<Text, static_image_size<Text>()>();
+		};
+
+		// The snapshot of a literal, opened on its first use. The image is generated by the compiler
+		// with the layout of `save_snapshot()`, so only its header is checked, not its nodes.
+		struct static_document
+		{
+			template <static_text Text>
+			static snapshot_value root()
+			{
+				static const snapshot document(static_image<Text>::data.data(), static_image<Text>::data.size(), false);
+				return document.root();
+			}
+		};
+	}
+
+	inline namespace literals
+	{
+		// A JSON document parsed at compile time.
+		// The text is validated by the compiler (a malformed literal does not compile) and stored
+		// as a snapshot image in constant data (flash/rodata), nothing is parsed or allocated at run time:
+		// the first use only checks the header of the image, its nodes are valid by construction and are
+		// not validated again. The result is a read-only view with the accessors of a const `Json`.
+		// example:
+		// ```cpp
+		// using namespace json_lite::literals;
+		// const json_lite::snapshot_value defaults = R"({"wifi": {"retries": 5}, "name": "sensor"})"_json_static;
+		// int retries = (json_lite::json_int)defaults["wifi"]["retries"];
+		// ```
+		template <detail::static_text Text>
+		snapshot_value operator""_json_static()
+		{
+			return detail::static_document::root<Text>();
+		}
+	}
+}
+
+#endif
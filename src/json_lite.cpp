@@ -7,12 +7,25 @@
 #endif
 
 #include "json_lite.hpp"
+#include "json_lite_internal.hpp"
+#include "json_lite_parser.hpp"
 
 #ifdef JSON_LITE_PRINTABLE
 	#include <Print.h>
 #endif
 
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#if defined(__SSE2__) || defined(__AVX2__)
+	#include <immintrin.h>
+#elif defined(__ARM_NEON)
+	#include <arm_neon.h>
+#endif
 
 namespace json_lite
 {
@@ -41,6 +54,8 @@ namespace json_lite
 		m_data_type(other.m_data_type), // copy the data type
 		m_value(null_value_t())         // initialize the to empty, copy it later in the switch
 	{
+		JSON_LITE_STAT_ADD(nodes_created, 1);
+		JSON_LITE_STAT_ADD(copies, 1);
 		switch (m_data_type)
 		{
 		case json_data_type::null:
@@ -57,24 +72,39 @@ namespace json_lite
 			break;
 		case json_data_type::string:
 			new (&m_value.string) std::string(other.m_value.string);
+			JSON_LITE_STAT_ADD(bytes_allocated, m_value.string.capacity());
 			break;
 		case json_data_type::array:
 			new (&m_value.array) std::vector<Json>(other.m_value.array);
+			JSON_LITE_STAT_ADD(bytes_allocated, m_value.array.capacity() * sizeof(Json));
 			break;
 		case json_data_type::object:
 			new (&m_value.object) std::map<std::string, Json>(other.m_value.object);
 			break;
+		case json_data_type::integer_array:
+			new (&m_value.integer_array) std::vector<Int>(other.m_value.integer_array);
+			JSON_LITE_STAT_ADD(bytes_allocated, m_value.integer_array.capacity() * sizeof(Int));
+			break;
+		case json_data_type::floating_point_array:
+			new (&m_value.floating_array) std::vector<Float>(other.m_value.floating_array);
+			JSON_LITE_STAT_ADD(bytes_allocated, m_value.floating_array.capacity() * sizeof(Float));
+			break;
+		case json_data_type::raw_number:
+			new (&m_value.raw_number) json_raw_number(other.m_value.raw_number);
+			break;
 		default:
-			throw std::runtime_error("Json::json_value(const json_value& other): unknown json_data_type");
+			JSON_LITE_THROW(std::runtime_error("Json::json_value(const json_value& other): unknown json_data_type"));
 			break;
 		};
 	}
 
 	////////////////////////////////////////////////////////////////
-	Json::Json(Json&& other) :
+	Json::Json(Json&& other) noexcept :
 		m_data_type(other.m_data_type), // copy the data type
 		m_value(null_value_t())         // initialize the to empty, move it later in the switch
 	{
+		JSON_LITE_STAT_ADD(nodes_created, 1);
+		JSON_LITE_STAT_ADD(moves, 1);
 		switch (m_data_type)
 		{
 		case json_data_type::null:
@@ -98,8 +128,18 @@ namespace json_lite
 		case json_data_type::object:
 			new (&m_value.object) std::map<std::string, Json>(std::move(other.m_value.object));
 			break;
+		case json_data_type::integer_array:
+			new (&m_value.integer_array) std::vector<Int>(std::move(other.m_value.integer_array));
+			break;
+		case json_data_type::floating_point_array:
+			new (&m_value.floating_array) std::vector<Float>(std::move(other.m_value.floating_array));
+			break;
+		case json_data_type::raw_number:
+			new (&m_value.raw_number) json_raw_number(std::move(other.m_value.raw_number));
+			break;
 		default:
-			throw std::runtime_error("Json::json_value(json_value&& other): unknown json_data_type");
+			// moves cannot throw
+			assert(false && "Json::json_value(json_value&& other): unknown json_data_type");
 			break;
 		};
 	}
@@ -128,8 +168,18 @@ namespace json_lite
 		case json_data_type::object:
 			m_value.object.~map();
 			break;
+		case json_data_type::integer_array:
+			m_value.integer_array.~vector();
+			break;
+		case json_data_type::floating_point_array:
+			m_value.floating_array.~vector();
+			break;
+		case json_data_type::raw_number:
+			m_value.raw_number.~json_raw_number();
+			break;
 		default:
-			throw std::runtime_error("Json::~json_value() - unknown json_data_type");
+			// destructors cannot throw
+			assert(false && "Json::~json_value() - unknown json_data_type");
 			break;
 		};
 
@@ -141,21 +191,73 @@ namespace json_lite
 	//           Assignments
 	// ================================
 
+	namespace
+	{
+		// Assign an object to another one. With the same keys the values are assigned one by one, so
+		// that they reuse their storage: `std::map` assignment reuses the nodes but reconstructs their content.
+		void assign_members(std::map<std::string, Json>& object, const std::map<std::string, Json>& other)
+		{
+			if (object.size() == other.size() && std::equal(object.begin(), object.end(), other.begin(),
+				[](const std::pair<const std::string, Json>& a, const std::pair<const std::string, Json>& b) { return a.first == b.first; }))
+			{
+				auto it = object.begin();
+				for (const auto& member : other)
+					(it++)->second = member.second;
+			}
+			else
+				object = other;
+		}
+	}
+
 	////////////////////////////////////////////////////////////////
 	Json& Json::operator=(const Json& other)
 	{
-		if (this != &other)
+		if (this == &other)
+			return *this;
+
+		// same type: assign the value, reusing its storage (string and vector capacity,
+		// elements and map nodes are assigned recursively)
+		if (m_data_type == other.m_data_type)
 		{
-			// the simplest way to implement this is destroy the current value and
-			// re-create it by calling the copy constructor
-			this->~Json();
-			new (this) Json(other); // in place copy constructor
+			switch (m_data_type)
+			{
+			case json_data_type::string:
+				JSON_LITE_STAT_ADD(copies, 1);
+				m_value.string = other.m_value.string;
+				return *this;
+			case json_data_type::array:
+				JSON_LITE_STAT_ADD(copies, 1);
+				m_value.array = other.m_value.array;
+				return *this;
+			case json_data_type::object:
+				JSON_LITE_STAT_ADD(copies, 1);
+				assign_members(m_value.object, other.m_value.object);
+				return *this;
+			case json_data_type::integer_array:
+				JSON_LITE_STAT_ADD(copies, 1);
+				m_value.integer_array = other.m_value.integer_array;
+				return *this;
+			case json_data_type::floating_point_array:
+				JSON_LITE_STAT_ADD(copies, 1);
+				m_value.floating_array = other.m_value.floating_array;
+				return *this;
+			case json_data_type::raw_number:
+				JSON_LITE_STAT_ADD(copies, 1);
+				m_value.raw_number = other.m_value.raw_number;
+				return *this;
+			default:
+				break;
+			}
 		}
+
+		// otherwise destroy the current value and re-create it by calling the copy constructor
+		this->~Json();
+		new (this) Json(other); // in place copy constructor
 		return *this;
 	}
 
 	////////////////////////////////////////////////////////////////
-	Json& Json::operator=(Json&& other)
+	Json& Json::operator=(Json&& other) noexcept
 	{
 		if (this != &other)
 		{
@@ -210,6 +312,11 @@ namespace json_lite
 	////////////////////////////////////////////////////////////////
 	Json& Json::operator=(const char* value)
 	{
+		if (m_data_type == json_data_type::string)
+		{
+			m_value.string = value; // reuse the capacity
+			return *this;
+		}
 		this->~Json();
 		new (this) Json(value);
 		return *this;
@@ -218,6 +325,11 @@ namespace json_lite
 	////////////////////////////////////////////////////////////////
 	Json& Json::operator=(const std::string& value)
 	{
+		if (m_data_type == json_data_type::string)
+		{
+			m_value.string = value; // reuse the capacity
+			return *this;
+		}
 		this->~Json();
 		new (this) Json(value);
 		return *this;
@@ -226,6 +338,11 @@ namespace json_lite
 	////////////////////////////////////////////////////////////////
 	Json& Json::operator=(std::string&& value)
 	{
+		if (m_data_type == json_data_type::string)
+		{
+			m_value.string = std::move(value);
+			return *this;
+		}
 		this->~Json();
 		new (this) Json(std::move(value));
 		return *this;
@@ -234,6 +351,11 @@ namespace json_lite
 	////////////////////////////////////////////////////////////////
 	Json& Json::operator=(const std::vector<Json>& value)
 	{
+		if (m_data_type == json_data_type::array)
+		{
+			m_value.array = value; // reuse the capacity and the elements
+			return *this;
+		}
 		this->~Json();
 		new (this) Json(value);
 		return *this;
@@ -242,6 +364,11 @@ namespace json_lite
 	////////////////////////////////////////////////////////////////
 	Json& Json::operator=(std::vector<Json>&& value)
 	{
+		if (m_data_type == json_data_type::array)
+		{
+			m_value.array = std::move(value);
+			return *this;
+		}
 		this->~Json();
 		new (this) Json(std::move(value));
 		return *this;
@@ -250,6 +377,11 @@ namespace json_lite
 	////////////////////////////////////////////////////////////////
 	Json& Json::operator=(const std::map<std::string, Json>& value)
 	{
+		if (m_data_type == json_data_type::object)
+		{
+			assign_members(m_value.object, value);
+			return *this;
+		}
 		this->~Json();
 		new (this) Json(value);
 		return *this;
@@ -258,6 +390,11 @@ namespace json_lite
 	////////////////////////////////////////////////////////////////
 	Json& Json::operator=(std::map<std::string, Json>&& value)
 	{
+		if (m_data_type == json_data_type::object)
+		{
+			m_value.object = std::move(value);
+			return *this;
+		}
 		this->~Json();
 		new (this) Json(std::move(value));
 		return *this;
@@ -291,6 +428,7 @@ namespace json_lite
 		case json_data_type::integer:
 			return json_type::number;
 		case json_data_type::floating_point:
+		case json_data_type::raw_number:
 			return json_type::number;
 		case json_data_type::string:
 			return json_type::string;
@@ -298,12 +436,41 @@ namespace json_lite
 			return json_type::array;
 		case json_data_type::object:
 			return json_type::object;
+		case json_data_type::integer_array:
+		case json_data_type::floating_point_array:
+			return json_type::array;
 		default:
-			throw std::runtime_error("Json::type() - unknown json_data_type");
+			JSON_LITE_THROW(std::runtime_error("Json::type() - unknown json_data_type"));
 			break;
 		};
 	}
 
+	////////////////////////////////////////////////////////////////
+	void Json::clear_keep_capacity()
+	{
+		switch (m_data_type)
+		{
+		case json_data_type::string:
+			m_value.string.clear();
+			break;
+		case json_data_type::array:
+			m_value.array.clear();
+			break;
+		case json_data_type::object:
+			m_value.object.clear();
+			break;
+		case json_data_type::integer_array:
+			m_value.integer_array.clear();
+			break;
+		case json_data_type::floating_point_array:
+			m_value.floating_array.clear();
+			break;
+		default:
+			*this = nullptr;
+			break;
+		}
+	}
+
 	////////////////////////////////////////////////////////////////
 	void Json::to_null()
 	{
@@ -327,7 +494,7 @@ namespace json_lite
 	{
 		if (m_data_type != json_data_type::null)
 			// note: same string for all getters to save space
-			throw std::runtime_error("Json::get<...>() - wrong type");
+			JSON_LITE_THROW(std::runtime_error("Json::get<...>() - wrong type"));
 		return m_value.null_value;
 	}
 
@@ -335,23 +502,27 @@ namespace json_lite
 	template <> typename json_data_type_to_type<json_data_type::boolean>::type& Json::get<json_data_type::boolean>()
 	{
 		if (m_data_type != json_data_type::boolean)
-			throw std::runtime_error("Json::get<...>() - wrong type");
+			JSON_LITE_THROW(std::runtime_error("Json::get<...>() - wrong type"));
 		return m_value.boolean;
 	}
 
 	////////////////////////////////////////////////////////////////
 	template <> typename json_data_type_to_type<json_data_type::integer>::type& Json::get<json_data_type::integer>()
 	{
+		if (m_data_type == json_data_type::raw_number && m_value.raw_number.is_integer())
+			*this = m_value.raw_number.m_number.integer;
 		if (m_data_type != json_data_type::integer)
-			throw std::runtime_error("Json::get<...>() - wrong type");
+			JSON_LITE_THROW(std::runtime_error("Json::get<...>() - wrong type"));
 		return m_value.integer;
 	}
 
 	////////////////////////////////////////////////////////////////
 	template <> typename json_data_type_to_type<json_data_type::floating_point>::type& Json::get<json_data_type::floating_point>()
 	{
+		if (m_data_type == json_data_type::raw_number && !m_value.raw_number.is_integer())
+			*this = m_value.raw_number.m_number.floating;
 		if (m_data_type != json_data_type::floating_point)
-			throw std::runtime_error("Json::get<...>() - wrong type");
+			JSON_LITE_THROW(std::runtime_error("Json::get<...>() - wrong type"));
 		return m_value.floating;
 	}
 
@@ -359,7 +530,7 @@ namespace json_lite
 	template <> typename json_data_type_to_type<json_data_type::string>::type& Json::get<json_data_type::string>()
 	{
 		if (m_data_type != json_data_type::string)
-			throw std::runtime_error("Json::get<...>() - wrong type");
+			JSON_LITE_THROW(std::runtime_error("Json::get<...>() - wrong type"));
 		return m_value.string;
 	}
 
@@ -367,7 +538,7 @@ namespace json_lite
 	template <> typename json_data_type_to_type<json_data_type::array>::type& Json::get<json_data_type::array>()
 	{
 		if (m_data_type != json_data_type::array)
-			throw std::runtime_error("Json::get<...>() - wrong type");
+			JSON_LITE_THROW(std::runtime_error("Json::get<...>() - wrong type"));
 		return m_value.array;
 	}
 
@@ -375,15 +546,39 @@ namespace json_lite
 	template <> typename json_data_type_to_type<json_data_type::object>::type& Json::get<json_data_type::object>()
 	{
 		if (m_data_type != json_data_type::object)
-			throw std::runtime_error("Json::get<...>() - wrong type");
+			JSON_LITE_THROW(std::runtime_error("Json::get<...>() - wrong type"));
 		return m_value.object;
 	}
 
+	////////////////////////////////////////////////////////////////
+	template <> typename json_data_type_to_type<json_data_type::integer_array>::type& Json::get<json_data_type::integer_array>()
+	{
+		if (m_data_type != json_data_type::integer_array)
+			JSON_LITE_THROW(std::runtime_error("Json::get<...>() - wrong type"));
+		return m_value.integer_array;
+	}
+
+	////////////////////////////////////////////////////////////////
+	template <> typename json_data_type_to_type<json_data_type::floating_point_array>::type& Json::get<json_data_type::floating_point_array>()
+	{
+		if (m_data_type != json_data_type::floating_point_array)
+			JSON_LITE_THROW(std::runtime_error("Json::get<...>() - wrong type"));
+		return m_value.floating_array;
+	}
+
+	////////////////////////////////////////////////////////////////
+	template <> typename json_data_type_to_type<json_data_type::raw_number>::type& Json::get<json_data_type::raw_number>()
+	{
+		if (m_data_type != json_data_type::raw_number)
+			JSON_LITE_THROW(std::runtime_error("Json::get<...>() - wrong type"));
+		return m_value.raw_number;
+	}
+
 	////////////////////////////////////////////////////////////////
 	template <> const typename json_data_type_to_type<json_data_type::null>::type& Json::get<json_data_type::null>() const
 	{
 		if (m_data_type != json_data_type::null)
-			throw std::runtime_error("Json::get<...>() - wrong type");
+			JSON_LITE_THROW(std::runtime_error("Json::get<...>() - wrong type"));
 		return m_value.null_value;
 	}
 
@@ -391,23 +586,27 @@ namespace json_lite
 	template <> const typename json_data_type_to_type<json_data_type::boolean>::type& Json::get<json_data_type::boolean>() const
 	{
 		if (m_data_type != json_data_type::boolean)
-			throw std::runtime_error("Json::get<...>() - wrong type");
+			JSON_LITE_THROW(std::runtime_error("Json::get<...>() - wrong type"));
 		return m_value.boolean;
 	}
 
 	////////////////////////////////////////////////////////////////
 	template <> const typename json_data_type_to_type<json_data_type::integer>::type& Json::get<json_data_type::integer>() const
 	{
+		if (m_data_type == json_data_type::raw_number && m_value.raw_number.is_integer())
+			return m_value.raw_number.m_number.integer;
 		if (m_data_type != json_data_type::integer)
-			throw std::runtime_error("Json::get<...>() - wrong type");
+			JSON_LITE_THROW(std::runtime_error("Json::get<...>() - wrong type"));
 		return m_value.integer;
 	}
 
 	////////////////////////////////////////////////////////////////
 	template <> const typename json_data_type_to_type<json_data_type::floating_point>::type& Json::get<json_data_type::floating_point>() const
 	{
+		if (m_data_type == json_data_type::raw_number && !m_value.raw_number.is_integer())
+			return m_value.raw_number.m_number.floating;
 		if (m_data_type != json_data_type::floating_point)
-			throw std::runtime_error("Json::get<...>() - wrong type");
+			JSON_LITE_THROW(std::runtime_error("Json::get<...>() - wrong type"));
 		return m_value.floating;
 	}
 
@@ -415,7 +614,7 @@ namespace json_lite
 	template <> const typename json_data_type_to_type<json_data_type::string>::type& Json::get<json_data_type::string>() const
 	{
 		if (m_data_type != json_data_type::string)
-			throw std::runtime_error("Json::get<...>() - wrong type");
+			JSON_LITE_THROW(std::runtime_error("Json::get<...>() - wrong type"));
 		return m_value.string;
 	}
 
@@ -423,7 +622,7 @@ namespace json_lite
 	template <> const typename json_data_type_to_type<json_data_type::array>::type& Json::get<json_data_type::array>() const
 	{
 		if (m_data_type != json_data_type::array)
-			throw std::runtime_error("Json::get<...>() - wrong type");
+			JSON_LITE_THROW(std::runtime_error("Json::get<...>() - wrong type"));
 		return m_value.array;
 	}
 
@@ -431,15 +630,44 @@ namespace json_lite
 	template <> const typename json_data_type_to_type<json_data_type::object>::type& Json::get<json_data_type::object>() const
 	{
 		if (m_data_type != json_data_type::object)
-			throw std::runtime_error("Json::get<...>() - wrong type");
+			JSON_LITE_THROW(std::runtime_error("Json::get<...>() - wrong type"));
 		return m_value.object;
 	}
 
+	////////////////////////////////////////////////////////////////
+	template <> const typename json_data_type_to_type<json_data_type::integer_array>::type& Json::get<json_data_type::integer_array>() const
+	{
+		if (m_data_type != json_data_type::integer_array)
+			JSON_LITE_THROW(std::runtime_error("Json::get<...>() - wrong type"));
+		return m_value.integer_array;
+	}
+
+	////////////////////////////////////////////////////////////////
+	template <> const typename json_data_type_to_type<json_data_type::floating_point_array>::type& Json::get<json_data_type::floating_point_array>() const
+	{
+		if (m_data_type != json_data_type::floating_point_array)
+			JSON_LITE_THROW(std::runtime_error("Json::get<...>() - wrong type"));
+		return m_value.floating_array;
+	}
+
+	////////////////////////////////////////////////////////////////
+	template <> const typename json_data_type_to_type<json_data_type::raw_number>::type& Json::get<json_data_type::raw_number>() const
+	{
+		if (m_data_type != json_data_type::raw_number)
+			JSON_LITE_THROW(std::runtime_error("Json::get<...>() - wrong type"));
+		return m_value.raw_number;
+	}
+
 	////////////////////////////////////////////////////////////////
 	std::vector<Json>& Json::as_array()
 	{
 		if (this->data_type() == json_data_type::array)
 			return this->get<json_data_type::array>();
+		else if (this->is_packed())
+		{
+			this->unpack();
+			return this->get<json_data_type::array>();
+		}
 		else
 		{
 			this->to_array();
@@ -453,7 +681,7 @@ namespace json_lite
 		if (this->data_type() == json_data_type::array)
 			return this->get<json_data_type::array>();
 		else
-			throw std::runtime_error("Json::as_array() - wrong type");
+			JSON_LITE_THROW(std::runtime_error("Json::as_array() - wrong type"));
 	}
 
 	////////////////////////////////////////////////////////////////
@@ -474,7 +702,87 @@ namespace json_lite
 		if (this->data_type() == json_data_type::object)
 			return this->get<json_data_type::object>();
 		else
-			throw std::runtime_error("Json::as_object() - wrong type");
+			JSON_LITE_THROW(std::runtime_error("Json::as_object() - wrong type"));
+	}
+
+	// ================================
+	//          Packed arrays
+	// ================================
+
+	////////////////////////////////////////////////////////////////
+	bool Json::pack()
+	{
+		if (this->is_packed())
+			return true;
+		if (m_data_type != json_data_type::array || m_value.array.empty())
+			return false;
+
+		const std::vector<Json>& array = m_value.array;
+		const json_data_type element_type = array.front().data_type();
+		if (element_type != json_data_type::integer && element_type != json_data_type::floating_point)
+			return false;
+		for (const Json& value : array)
+			if (value.data_type() != element_type)
+				return false;
+
+		if (element_type == json_data_type::integer)
+		{
+			std::vector<Int> packed;
+			packed.reserve(array.size());
+			for (const Json& value : array)
+				packed.push_back(value.m_value.integer);
+			JSON_LITE_STAT_ADD(bytes_allocated, packed.capacity() * sizeof(Int));
+			this->~Json();
+			new (this) Json(std::move(packed));
+		}
+		else
+		{
+			std::vector<Float> packed;
+			packed.reserve(array.size());
+			for (const Json& value : array)
+				packed.push_back(value.m_value.floating);
+			JSON_LITE_STAT_ADD(bytes_allocated, packed.capacity() * sizeof(Float));
+			this->~Json();
+			new (this) Json(std::move(packed));
+		}
+		return true;
+	}
+
+	////////////////////////////////////////////////////////////////
+	void Json::unpack()
+	{
+		std::vector<Json> array;
+		if (m_data_type == json_data_type::integer_array)
+		{
+			array.reserve(m_value.integer_array.size());
+			for (Int value : m_value.integer_array)
+				array.emplace_back(value);
+		}
+		else if (m_data_type == json_data_type::floating_point_array)
+		{
+			array.reserve(m_value.floating_array.size());
+			for (Float value : m_value.floating_array)
+				array.emplace_back(value);
+		}
+		else
+			return;
+		JSON_LITE_STAT_ADD(bytes_allocated, array.capacity() * sizeof(Json));
+		*this = make_array_t();
+		m_value.array.swap(array);
+	}
+
+	////////////////////////////////////////////////////////////////
+	array_view<Json::Int> Json::integers() const
+	{
+		const std::vector<Int>& values = this->get<json_data_type::integer_array>();
+		return array_view<Int>(values.data(), values.size());
+	}
+
+	////////////////////////////////////////////////////////////////
+	array_view<Json::Float> Json::floating_points() const
+	{
+		const std::vector<Float>& values = this->get<json_data_type::floating_point_array>();
+		return array_view<Float>(values.data(), values.size());
 	}
 
 	////////////////////////////////////////////////////////////////
@@ -508,7 +816,9 @@ namespace json_lite
 	////////////////////////////////////////////////////////////////
 	Json& Json::operator[](const std::string& key)
 	{
-		return this->as_object()[key];
+		auto& object = this->as_object();
+		JSON_LITE_STAT_ADD(map_insertions, object.count(key) == 0 ? 1 : 0);
+		return object[key];
 	}
 
 	////////////////////////////////////////////////////////////////
@@ -520,7 +830,7 @@ namespace json_lite
 	////////////////////////////////////////////////////////////////
 	Json& Json::operator[](const char* key)
 	{
-		return this->as_object()[key];
+		return (*this)[std::string(key)];
 	}
 
 	////////////////////////////////////////////////////////////////
@@ -559,6 +869,23 @@ namespace json_lite
 		return this->as_object().find(key) != this->as_object().end();
 	}
 
+	////////////////////////////////////////////////////////////////
+	void Json::reserve(size_t size)
+	{
+		switch (m_data_type)
+		{
+		case json_data_type::integer_array:
+			m_value.integer_array.reserve(size);
+			break;
+		case json_data_type::floating_point_array:
+			m_value.floating_array.reserve(size);
+			break;
+		default:
+			as_array().reserve(size);
+			break;
+		}
+	}
+
 	////////////////////////////////////////////////////////////////
 	Json::operator bool() const
 	{
@@ -620,300 +947,231 @@ namespace json_lite
 	}
 
 	////////////////////////////////////////////////////////////////
-	Json Json::parse(const char* str)
+	const char* to_string(parse_error error)
 	{
-		return Json::parse(str, str + strlen(str));
+		switch (error)
+		{
+		case parse_error::none:
+			return "no error";
+		case parse_error::empty_input:
+			return "empty input";
+		case parse_error::unexpected_end:
+			return "unexpected end of input";
+		case parse_error::unexpected_character:
+			return "unexpected character";
+		case parse_error::invalid_literal:
+			return "invalid literal";
+		case parse_error::invalid_number:
+			return "invalid number";
+		case parse_error::invalid_escape:
+			return "invalid escape sequence";
+		case parse_error::unsupported_unicode:
+			return "unicode escapes are not supported";
+		case parse_error::input_too_large:
+			return "input too large";
+		case parse_error::depth_limit_exceeded:
+			return "nesting depth limit exceeded";
+		case parse_error::node_limit_exceeded:
+			return "node limit exceeded";
+		case parse_error::string_too_long:
+			return "string too long";
+		case parse_error::unsupported_type:
+			return "unsupported type";
+		default:
+			return "unknown error";
+		}
 	}
 
-	namespace
+	using namespace detail;
+
+	// ================================================================
+	//                        Instrumentation
+	// ================================================================
+
+#ifdef JSON_LITE_INSTRUMENTATION
+	namespace detail
 	{
-		const char* skip_whitespace(const char* p, const char* end)
-		{
-			while (p != end && isspace(*p))
-				++p;
-			return p;
-		}
+		thread_local json_stats current_stats;
+	}
+#endif
 
-		const char* parse_json(const char* begin, const char* end, Json& obj);
+	////////////////////////////////////////////////////////////////
+	json_stats thread_stats()
+	{
+#ifdef JSON_LITE_INSTRUMENTATION
+		return detail::current_stats;
+#else
+		return json_stats();
+#endif
+	}
 
-		bool will_null_parse(const char* begin, const char* end)
-		{
-			return begin != end && begin[0] == 'n';
-		}
+	////////////////////////////////////////////////////////////////
+	void reset_thread_stats()
+	{
+#ifdef JSON_LITE_INSTRUMENTATION
+		detail::current_stats = json_stats();
+#endif
+	}
 
-		bool will_boolean_parse(const char* begin, const char* end)
-		{
-			return begin != end && (begin[0] == 't' || begin[0] == 'f');
-		}
+	////////////////////////////////////////////////////////////////
+	Json Json::parse(const char* str)
+	{
+		return Json::parse(str, str + strlen(str));
+	}
 
-		bool will_number_parse(const char* begin, const char* end)
-		{
-			return begin != end && (
-				begin[0] == '-' ||
-				(begin[0] >= '0' && begin[0] <= '9') ||
-				begin[0] == '.'
-				);
-		}
+	////////////////////////////////////////////////////////////////
+	Json Json::parse(const char* begin, const char* end)
+	{
+		return parse(begin, end, parse_limits());
+	}
 
-		bool will_string_parse(const char* begin, const char* end)
-		{
-			return begin != end && begin[0] == '"';
-		}
+	////////////////////////////////////////////////////////////////
+	Json Json::parse(const std::string& str)
+	{
+		return parse(str.c_str(), str.c_str() + str.size());
+	}
 
-		bool will_array_parse(const char* begin, const char* end)
-		{
-			return begin != end && begin[0] == '[';
-		}
+	////////////////////////////////////////////////////////////////
+	Json Json::parse(const char* begin, const char* end, const parse_limits& limits)
+	{
+		parse_options options;
+		static_cast<parse_limits&>(options) = limits;
+		return parse(begin, end, options);
+	}
 
-		bool will_object_parse(const char* begin, const char* end)
-		{
-			return begin != end && begin[0] == '{';
-		}
+	////////////////////////////////////////////////////////////////
+	Json Json::parse(const char* begin, const char* end, const parse_options& options)
+	{
+		Json obj;
+		if (skip_whitespace(begin, end) == end)
+			JSON_LITE_THROW(parsing_error(to_string(parse_error::empty_input)));
+		parser<throwing_policy>(options).parse(begin, end, obj);
+		return obj;
+	}
 
-		const char* parse_json_null(const char* begin, const char* end, Json& obj)
-		{
-			if (end - begin < 4)
-				throw std::runtime_error("parse_json_null() - invalid json");
-			if (strncmp(begin, "null", 4) != 0)
-				throw std::runtime_error("parse_json_null() - invalid json");
-			obj = nullptr;
-			return begin + 4;
-		}
+	////////////////////////////////////////////////////////////////
+	parse_result Json::parse(const char* begin, const char* end, Json& out)
+	{
+		return parse(begin, end, out, parse_limits());
+	}
 
-		const char* parse_json_boolean(const char* begin, const char* end, Json& obj)
-		{
-			if (strncmp(begin, "true", 4) == 0)
-			{
-				obj = true;
-				return begin + 4;
-			}
+	////////////////////////////////////////////////////////////////
+	parse_result Json::parse(const std::string& str, Json& out)
+	{
+		return parse(str.c_str(), str.c_str() + str.size(), out);
+	}
 
-			if (strncmp(begin, "false", 5) == 0)
-			{
-				obj = false;
-				return begin + 5;
-			}
+	////////////////////////////////////////////////////////////////
+	parse_result Json::parse(const char* begin, const char* end, Json& out, const parse_limits& limits)
+	{
+		parse_options options;
+		static_cast<parse_limits&>(options) = limits;
+		return parse(begin, end, out, options);
+	}
 
-			throw Json::parsing_error("parse_json_boolean() - invalid boolean");
-		}
+	////////////////////////////////////////////////////////////////
+	parse_result Json::parse(const char* begin, const char* end, Json& out, const parse_options& options)
+	{
+		parser<status_policy> json_parser(options);
+		return parse_document(json_parser, begin, end, out);
+	}
 
-		const char* parse_json_number(const char* begin, const char* end, Json& obj)
+	namespace detail
+	{
+		namespace
 		{
-			const char* p = begin;
-			bool is_float = false;
-			while (p != end)
-			{
-				if (*p == '.' || *p == 'e' || *p == 'E')
-					is_float = true;
-				else if (!isdigit(*p))
-					break;
-				++p;
-			}
-			if (is_float)
+			// the bytes that may need escaping: quotes, backslashes and control characters
+			// (only \b, \f, \n, \r and \t are escaped, the other control characters are copied)
+			inline bool needs_escape(unsigned char c)
 			{
-				obj = (Json::Float)atof(begin);
+				return c == '"' || c == '\\' || c < 0x20;
 			}
-			else
-			{
-				obj = (Json::Int)atoi(begin);
-			}
-			return p;
-		}
 
-		const char* parse_json_string(const char* begin, const char* end, Json& obj)
-		{
-			if (*begin != '\"')
-				throw Json::parsing_error("parse_json_string() - invalid string");
-			++begin;
-			const char* p = begin;
-			std::string str;
-			while (p != end)
+			// The first byte in [p, end) that may need escaping, or `end`.
+			// Most strings need no escaping at all: blocks of clean bytes are skipped 16 or 32
+			// at a time with SSE2, AVX2 or NEON, or a machine word at a time (SWAR) elsewhere,
+			// the block containing the byte is then scanned one byte at a time.
+			const char* find_escape(const char* p, const char* end)
 			{
-				if (*p == '\"')
-				{
-					str.append(begin, p);
-					obj = str;
-					return p + 1;
-				}
-				else if (*p == '\\')
+#if defined(__AVX2__)
+				const __m256i quote32 = _mm256_set1_epi8('"');
+				const __m256i backslash32 = _mm256_set1_epi8('\\');
+				const __m256i control32 = _mm256_set1_epi8(0x1f);
+				while (end - p >= 32)
 				{
-					str.append(begin, p);
-					++p;
-					if (p == end)
-						throw Json::parsing_error("parse_json_string() - invalid string");
-					switch (*p)
-					{
-					case '\"':
-						str.push_back('\"');
-						break;
-					case '\\':
-						str.push_back('\\');
-						break;
-					case '/':
-						str.push_back('/');
-						break;
-					case 'b':
-						str.push_back('\b');
-						break;
-					case 'f':
-						str.push_back('\f');
-						break;
-					case 'n':
-						str.push_back('\n');
+					const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+					// unsigned v <= 0x1f  <=>  max(v, 0x1f) == 0x1f
+					const __m256i hits = _mm256_or_si256(
+						_mm256_or_si256(_mm256_cmpeq_epi8(v, quote32), _mm256_cmpeq_epi8(v, backslash32)),
+						_mm256_cmpeq_epi8(_mm256_max_epu8(v, control32), control32));
+					if (_mm256_movemask_epi8(hits) != 0)
 						break;
-					case 'r':
-						str.push_back('\r');
-						break;
-					case 't':
-						str.push_back('\t');
-						break;
-					case 'u':
-						throw Json::parsing_error("parse_json_string() - unicode not supported");
-					default:
-						throw Json::parsing_error("parse_json_string() - invalid string");
-					}
-					++p;
-					begin = p;
-				}
-				else
-				{
-					++p;
-				}
-			}
-			throw Json::parsing_error("parse_json_string() - invalid string");
-		}
-
-		const char* parse_json_array(const char* begin, const char* end, Json& obj)
-		{
-			if (*begin != '[')
-				throw Json::parsing_error("parse_json_array() - invalid array");
-			++begin;
-			Json array = Json::make_array();
-			while (begin != end)
-			{
-				begin = skip_whitespace(begin, end);
-				if (begin == end)
-					throw Json::parsing_error("parse_json_array() - invalid array");
-				if (*begin == ']')
-				{
-					obj = array;
-					return begin + 1;
+					p += 32;
 				}
-				Json value;
-				begin = parse_json(begin, end, value);
-				array.as_array().push_back(value);
-				begin = skip_whitespace(begin, end);
-				if (begin == end)
-					throw Json::parsing_error("parse_json_array() - invalid array");
-				if (*begin == ']')
+#endif
+#if defined(__SSE2__)
+				const __m128i quote = _mm_set1_epi8('"');
+				const __m128i backslash = _mm_set1_epi8('\\');
+				const __m128i control = _mm_set1_epi8(0x1f);
+				while (end - p >= 16)
 				{
-					obj = array;
-					return begin + 1;
+					const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+					const __m128i hits = _mm_or_si128(
+						_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+						_mm_cmpeq_epi8(_mm_max_epu8(v, control), control));
+					if (_mm_movemask_epi8(hits) != 0)
+						break;
+					p += 16;
 				}
-				if (*begin != ',')
-					throw Json::parsing_error("parse_json_array() - invalid array");
-				++begin;
-			}
-			throw Json::parsing_error("parse_json_array() - invalid array");
-		}
-
-		const char* parse_json_object(const char* begin, const char* end, Json& obj)
-		{
-			if (*begin != '{')
-				throw Json::parsing_error("parse_json_obj() - invalid object");
-			++begin;
-			Json object = Json::make_object();
-			while (begin != end)
-			{
-				begin = skip_whitespace(begin, end);
-				if (begin == end)
-					throw Json::parsing_error("parse_json_obj() - invalid object");
-				if (*begin == '}')
+#elif defined(__ARM_NEON)
+				const uint8x16_t quote = vdupq_n_u8('"');
+				const uint8x16_t backslash = vdupq_n_u8('\\');
+				const uint8x16_t space = vdupq_n_u8(0x20);
+				while (end - p >= 16)
 				{
-					obj = object;
-					return begin + 1;
+					const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+					const uint64x2_t hits = vreinterpretq_u64_u8(vorrq_u8(vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, backslash)), vcltq_u8(v, space)));
+					if ((vgetq_lane_u64(hits, 0) | vgetq_lane_u64(hits, 1)) != 0)
+						break;
+					p += 16;
 				}
-				Json key;
-				begin = parse_json_string(begin, end, key);
-				begin = skip_whitespace(begin, end);
-				if (begin == end)
-					throw Json::parsing_error("parse_json_obj() - invalid object");
-				if (*begin != ':')
-					throw Json::parsing_error("parse_json_obj() - invalid object");
-				++begin;
-				begin = skip_whitespace(begin, end);
-				if (begin == end)
-					throw Json::parsing_error("parse_json_obj() - invalid object");
-				Json value;
-				begin = parse_json(begin, end, value);
-				object[key.get<json_data_type::string>()] = value;
-				begin = skip_whitespace(begin, end);
-				if (begin == end)
-					throw Json::parsing_error("parse_json_obj() - invalid object");
-				if (*begin == '}')
+#else
+				// a byte of `x` is zero  <=>  (x - 0x01..01) & ~x & 0x80..80 != 0
+				// a byte of `x` is < 0x20  <=>  (x - 0x20..20) & ~x & 0x80..80 != 0
+				const size_t ones = ~static_cast<size_t>(0) / 0xff;
+				while (static_cast<size_t>(end - p) >= sizeof(size_t))
 				{
-					obj = object;
-					return begin + 1;
+					size_t word;
+					memcpy(&word, p, sizeof(word));
+					const size_t quote = word ^ (ones * '"');
+					const size_t backslash = word ^ (ones * '\\');
+					const size_t hits = ((quote - ones) & ~quote) | ((backslash - ones) & ~backslash) | ((word - ones * 0x20) & ~word);
+					if ((hits & (ones * 0x80)) != 0)
+						break;
+					p += sizeof(word);
 				}
-				if (*begin != ',')
-					throw Json::parsing_error("parse_json_obj() - invalid object");
-				++begin;
+#endif
+				while (p != end && !needs_escape(static_cast<unsigned char>(*p)))
+					++p;
+				return p;
 			}
-			throw Json::parsing_error("parse_json_obj() - invalid object");
 		}
 
-		const char* parse_json(const char* begin, const char* end, Json& obj)
+		void append_escaped(std::string& result, const char* data, size_t size)
 		{
-			if (begin == end)
-				// empty
-				begin;
-
-			begin = skip_whitespace(begin, end);
-
-			if (begin == end)
-				// empty
-				begin;
-
-			if (will_null_parse(begin, end))
-				return parse_json_null(begin, end, obj);
-			else if (will_boolean_parse(begin, end))
-				return parse_json_boolean(begin, end, obj);
-			else if (will_number_parse(begin, end))
-				return parse_json_number(begin, end, obj);
-			else if (will_string_parse(begin, end))
-				return parse_json_string(begin, end, obj);
-			else if (will_array_parse(begin, end))
-				return parse_json_array(begin, end, obj);
-			else if (will_object_parse(begin, end))
-				return parse_json_object(begin, end, obj);
-			else
-				throw Json::parsing_error("parse_json() - invalid json");
-		}
-	}
-
-	////////////////////////////////////////////////////////////////
-	Json Json::parse(const char* begin, const char* end)
-	{
-		Json obj;
-		auto last = parse_json(begin, end, obj);
-		return obj;
-	}
-
-	////////////////////////////////////////////////////////////////
-	Json Json::parse(const std::string& str)
-	{
-		return parse(str.c_str(), str.c_str() + str.size());
-	}
-
-	namespace
-	{
-		std::string dump_string(const std::string& str)
-		{
-			std::string result;
-			result.reserve(str.size() + 2);
 			result.push_back('"');
-			for (auto c : str)
+			const char* const end = data + size;
+			const char* p = data;
+			while (true)
 			{
+				// copy the clean run at once
+				const char* special = find_escape(p, end);
+				result.append(p, special);
+				if (special == end)
+					break;
+				const char c = *special;
+				if (c == '"' || c == '\\' || c == '\b' || c == '\f' || c == '\n' || c == '\r' || c == '\t')
+					JSON_LITE_STAT_ADD(string_escapes, 1);
 				switch (c)
 				{
 				case '"':
@@ -941,9 +1199,9 @@ namespace json_lite
 					result.push_back(c);
 					break;
 				}
+				p = special + 1;
 			}
 			result.push_back('"');
-			return result;
 		}
 
 		void dump_to_string(const Json& json, std::string& str)
@@ -972,9 +1230,16 @@ namespace json_lite
 				return;
 			}
 
+			if (json.is(json_data_type::raw_number))
+			{
+				str += json.get<json_data_type::raw_number>().text();
+				return;
+			}
+
 			if (json.is(json_data_type::string))
 			{
-				str += dump_string(json.get<json_data_type::string>());
+				const std::string& value = json.get<json_data_type::string>();
+				append_escaped(str, value.data(), value.size());
 				return;
 			}
 
@@ -991,6 +1256,34 @@ namespace json_lite
 				return;
 			}
 
+			if (json.is(json_data_type::integer_array))
+			{
+				str += '[';
+				const auto& array = json.get<json_data_type::integer_array>();
+				for (size_t i = 0; i < array.size(); ++i)
+				{
+					if (i != 0)
+						str += ',';
+					str += std::to_string(array[i]);
+				}
+				str += ']';
+				return;
+			}
+
+			if (json.is(json_data_type::floating_point_array))
+			{
+				str += '[';
+				const auto& array = json.get<json_data_type::floating_point_array>();
+				for (size_t i = 0; i < array.size(); ++i)
+				{
+					if (i != 0)
+						str += ',';
+					str += std::to_string(array[i]);
+				}
+				str += ']';
+				return;
+			}
+
 			if (json.is(json_data_type::object))
 			{
 				str += '{';
@@ -998,8 +1291,8 @@ namespace json_lite
 				{
 					if (it != json.get<json_data_type::object>().begin())
 						str += ',';
-					str += dump_string(it->first);
-					str += ":";
+					append_escaped(str, it->first.data(), it->first.size());
+					str += ':';
 					dump_to_string(it->second, str);
 				}
 				str += '}';
@@ -1011,6 +1304,7 @@ namespace json_lite
 	////////////////////////////////////////////////////////////////
 	std::string Json::dump() const
 	{
+		JSON_LITE_PROBE(dump);
 		std::string str;
 		dump_to_string(*this, str);
 		return str;
@@ -1057,48 +1351,201 @@ namespace json_lite
 	Json::value_union_t::value_union_t(const char* value)
 	{
 		new (&string) std::string(value);
-		string = value;
+		JSON_LITE_STAT_ADD(bytes_allocated, string.capacity());
 	}
 
 	////////////////////////////////////////////////////////////////
 	Json::value_union_t::value_union_t(const std::string& value)
 	{
 		new (&string) std::string(value);
-		string = value;
+		JSON_LITE_STAT_ADD(bytes_allocated, string.capacity());
 	}
 
 	////////////////////////////////////////////////////////////////
 	Json::value_union_t::value_union_t(std::string&& value)
 	{
 		new (&string) std::string(std::move(value));
-		string = std::move(value);
 	}
 
 	////////////////////////////////////////////////////////////////
 	Json::value_union_t::value_union_t(const std::vector<Json>& value)
 	{
 		new (&array) std::vector<Json>(value);
-		array = value;
+		JSON_LITE_STAT_ADD(bytes_allocated, array.capacity() * sizeof(Json));
 	}
 
 	////////////////////////////////////////////////////////////////
 	Json::value_union_t::value_union_t(std::vector<Json>&& value)
 	{
 		new (&array) std::vector<Json>(std::move(value));
-		array = std::move(value);
 	}
 
 	////////////////////////////////////////////////////////////////
 	Json::value_union_t::value_union_t(const std::map<std::string, Json>& value)
 	{
 		new (&object) std::map<std::string, Json>(value);
-		object = value;
 	}
 
 	////////////////////////////////////////////////////////////////
 	Json::value_union_t::value_union_t(std::map<std::string, Json>&& value)
 	{
 		new (&object) std::map<std::string, Json>(std::move(value));
-		object = std::move(value);
+	}
+
+	////////////////////////////////////////////////////////////////
+	Json::value_union_t::value_union_t(const std::vector<Int>& value)
+	{
+		new (&integer_array) std::vector<Int>(value);
+	}
+
+	////////////////////////////////////////////////////////////////
+	Json::value_union_t::value_union_t(std::vector<Int>&& value)
+	{
+		new (&integer_array) std::vector<Int>(std::move(value));
+	}
+
+	////////////////////////////////////////////////////////////////
+	Json::value_union_t::value_union_t(const std::vector<Float>& value)
+	{
+		new (&floating_array) std::vector<Float>(value);
+	}
+
+	////////////////////////////////////////////////////////////////
+	Json::value_union_t::value_union_t(std::vector<Float>&& value)
+	{
+		new (&floating_array) std::vector<Float>(std::move(value));
+	}
+
+	////////////////////////////////////////////////////////////////
+	Json::value_union_t::value_union_t(json_raw_number&& value)
+	{
+		new (&raw_number) json_raw_number(std::move(value));
+	}
+
+	// ================================================================
+	//                          Raw numbers
+	// ================================================================
+
+	////////////////////////////////////////////////////////////////
+	json_raw_number::state json_raw_number::convert() const
+	{
+		state current = state::text;
+		if (!m_state.compare_exchange_strong(current, state::converting, std::memory_order_acquire))
+		{
+			// converted, or being converted by another thread
+			while (current == state::converting)
+			{
+				std::this_thread::yield();
+				current = m_state.load(std::memory_order_acquire);
+			}
+			return current;
+		}
+
+		// the text is a valid JSON number, converted as `tokenizer::parse_json_number()` does
+		const char* str = m_text.c_str();
+		char* str_end = nullptr;
+		state result = state::floating_point;
+		if (m_text.find_first_of(".eE") == std::string::npos)
+		{
+			errno = 0;
+			const long long value = strtoll(str, &str_end, 10);
+			if (errno != ERANGE)
+			{
+				m_number.integer = value;
+				result = state::integer;
+			}
+			// out of range integers are stored as floating point
+		}
+		if (result == state::floating_point)
+			m_number.floating = strtod(str, &str_end);
+		m_state.store(result, std::memory_order_release);
+		return result;
+	}
+
+	// ================================================================
+	//                        json_sax_builder
+	// ================================================================
+
+	////////////////////////////////////////////////////////////////
+	Json& json_sax_builder::next_value()
+	{
+		if (m_stack.empty())
+			return m_out;
+		Json& container = *m_stack.back();
+		if (container.is(json_data_type::object))
+		{
+			JSON_LITE_STAT_ADD(map_insertions, 1);
+			return container.get<json_data_type::object>()[std::move(m_key)];
+		}
+		auto& array = container.get<json_data_type::array>();
+		array.emplace_back();
+		return array.back();
+	}
+
+	////////////////////////////////////////////////////////////////
+	void json_sax_builder::null_value()
+	{
+		next_value() = nullptr;
+	}
+
+	////////////////////////////////////////////////////////////////
+	void json_sax_builder::boolean_value(bool value)
+	{
+		next_value() = value;
+	}
+
+	////////////////////////////////////////////////////////////////
+	void json_sax_builder::integer_value(json_int value)
+	{
+		next_value() = value;
+	}
+
+	////////////////////////////////////////////////////////////////
+	void json_sax_builder::floating_point_value(json_float value)
+	{
+		next_value() = value;
+	}
+
+	////////////////////////////////////////////////////////////////
+	void json_sax_builder::string_value(const char* data, size_t size)
+	{
+		next_value() = std::string(data, size);
+	}
+
+	////////////////////////////////////////////////////////////////
+	void json_sax_builder::begin_array(size_t size)
+	{
+		Json& value = next_value();
+		value = Json::make_array_t();
+		if (size != unknown_size)
+			// the size comes from the input, cap the reservation in case it is hostile
+			value.get<json_data_type::array>().reserve(size < 1024 ? size : 1024);
+		m_stack.push_back(&value);
+	}
+
+	////////////////////////////////////////////////////////////////
+	void json_sax_builder::end_array()
+	{
+		m_stack.pop_back();
+	}
+
+	////////////////////////////////////////////////////////////////
+	void json_sax_builder::begin_object(size_t)
+	{
+		Json& value = next_value();
+		value = Json::make_object_t();
+		m_stack.push_back(&value);
+	}
+
+	////////////////////////////////////////////////////////////////
+	void json_sax_builder::key(const char* data, size_t size)
+	{
+		m_key.assign(data, size);
+	}
+
+	////////////////////////////////////////////////////////////////
+	void json_sax_builder::end_object()
+	{
+		m_stack.pop_back();
 	}
 }
\ No newline at end of file
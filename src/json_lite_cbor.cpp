@@ -0,0 +1,629 @@
+#include "json_lite.hpp"
+#include "json_lite_internal.hpp"
+
+// CBOR support, see https://www.rfc-editor.org/rfc/rfc8949
+
+namespace json_lite
+{
+	using namespace detail;
+
+	namespace
+	{
+		const unsigned major_unsigned = 0;
+		const unsigned major_negative = 1;
+		const unsigned major_bytes = 2;
+		const unsigned major_text = 3;
+		const unsigned major_array = 4;
+		const unsigned major_map = 5;
+		const unsigned major_tag = 6;
+		const unsigned major_simple = 7;
+
+		const unsigned char cbor_break = 0xff;
+
+		double half_to_double(uint16_t half)
+		{
+			const int exponent = (half >> 10) & 0x1f;
+			const int fraction = half & 0x3ff;
+			double value;
+			if (exponent == 0)
+				value = std::ldexp(fraction, -24);
+			else if (exponent != 31)
+				value = std::ldexp(fraction + 1024, exponent - 25);
+			else
+				value = fraction == 0 ? INFINITY : NAN;
+			return (half & 0x8000) ? -value : value;
+		}
+
+		// converts `value` to half precision, returns false if this is not lossless
+		bool double_to_half(double value, uint16_t& half)
+		{
+			const uint16_t sign = std::signbit(value) ? 0x8000 : 0;
+			if (std::isnan(value))
+			{
+				half = 0x7e00;
+				return true;
+			}
+			if (std::isinf(value))
+			{
+				half = sign | 0x7c00;
+				return true;
+			}
+			if (value == 0)
+			{
+				half = sign;
+				return true;
+			}
+
+			int exponent;
+			const double mantissa = std::frexp(std::fabs(value), &exponent); // in [0.5, 1)
+			const int biased = exponent - 1 + 15;
+			if (biased >= 31)
+				return false;
+			if (biased >= 1)
+			{
+				// normal
+				const double fraction = (mantissa * 2 - 1) * 1024;
+				if (fraction != std::floor(fraction))
+					return false;
+				half = static_cast<uint16_t>(sign | (biased << 10) | static_cast<int>(fraction));
+				return true;
+			}
+			// subnormal
+			const double fraction = std::ldexp(std::fabs(value), 24);
+			if (fraction != std::floor(fraction) || fraction >= 1024)
+				return false;
+			half = static_cast<uint16_t>(sign | static_cast<int>(fraction));
+			return true;
+		}
+
+		void write_cbor(const Json& json, cbor_encoder& encoder)
+		{
+			switch (json.data_type())
+			{
+			case json_data_type::null:
+				encoder.null_value();
+				break;
+			case json_data_type::boolean:
+				encoder.boolean_value(json.get<json_data_type::boolean>());
+				break;
+			case json_data_type::integer:
+				encoder.integer_value(json.get<json_data_type::integer>());
+				break;
+			case json_data_type::floating_point:
+				encoder.floating_point_value(json.get<json_data_type::floating_point>());
+				break;
+			case json_data_type::raw_number:
+			{
+				const json_raw_number& number = json.get<json_data_type::raw_number>();
+				if (number.is_integer())
+					encoder.integer_value(number.integer());
+				else
+					encoder.floating_point_value(number.floating_point());
+				break;
+			}
+			case json_data_type::string:
+			{
+				const std::string& str = json.get<json_data_type::string>();
+				encoder.string_value(str.data(), str.size());
+				break;
+			}
+			case json_data_type::array:
+			{
+				const auto& array = json.get<json_data_type::array>();
+				encoder.begin_array(array.size());
+				for (const Json& value : array)
+					write_cbor(value, encoder);
+				encoder.end_array();
+				break;
+			}
+			case json_data_type::object:
+			{
+				const auto& object = json.get<json_data_type::object>();
+				encoder.begin_object(object.size());
+				for (const auto& pair : object)
+				{
+					encoder.key(pair.first.data(), pair.first.size());
+					write_cbor(pair.second, encoder);
+				}
+				encoder.end_object();
+				break;
+			}
+			case json_data_type::integer_array:
+			{
+				const auto& array = json.get<json_data_type::integer_array>();
+				encoder.begin_array(array.size());
+				for (Json::Int value : array)
+					encoder.integer_value(value);
+				encoder.end_array();
+				break;
+			}
+			case json_data_type::floating_point_array:
+			{
+				const auto& array = json.get<json_data_type::floating_point_array>();
+				encoder.begin_array(array.size());
+				for (Json::Float value : array)
+					encoder.floating_point_value(value);
+				encoder.end_array();
+				break;
+			}
+			}
+		}
+	}
+
+	// ================================================================
+	//                          cbor_encoder
+	// ================================================================
+
+	////////////////////////////////////////////////////////////////
+	void cbor_encoder::write_head(unsigned major, uint64_t argument)
+	{
+		const char type = static_cast<char>(major << 5);
+		if (argument < 24)
+			m_out.put(type | static_cast<char>(argument));
+		else if (argument <= 0xff)
+		{
+			m_out.put(type | 24);
+			put_big_endian(m_out, argument, 1);
+		}
+		else if (argument <= 0xffff)
+		{
+			m_out.put(type | 25);
+			put_big_endian(m_out, argument, 2);
+		}
+		else if (argument <= 0xffffffff)
+		{
+			m_out.put(type | 26);
+			put_big_endian(m_out, argument, 4);
+		}
+		else
+		{
+			m_out.put(type | 27);
+			put_big_endian(m_out, argument, 8);
+		}
+	}
+
+	////////////////////////////////////////////////////////////////
+	void cbor_encoder::null_value()
+	{
+		m_out.put(static_cast<char>(0xf6));
+	}
+
+	////////////////////////////////////////////////////////////////
+	void cbor_encoder::boolean_value(bool value)
+	{
+		m_out.put(static_cast<char>(value ? 0xf5 : 0xf4));
+	}
+
+	////////////////////////////////////////////////////////////////
+	void cbor_encoder::integer_value(json_int value)
+	{
+		if (value >= 0)
+			write_head(major_unsigned, static_cast<uint64_t>(value));
+		else
+			// -1 - n, computed without overflowing
+			write_head(major_negative, ~static_cast<uint64_t>(value));
+	}
+
+	////////////////////////////////////////////////////////////////
+	void cbor_encoder::floating_point_value(json_float value)
+	{
+		uint16_t half;
+		if (double_to_half(value, half))
+		{
+			m_out.put(static_cast<char>(0xf9));
+			put_big_endian(m_out, half, 2);
+		}
+		else if (is_exact_float(value))
+		{
+			m_out.put(static_cast<char>(0xfa));
+			put_big_endian(m_out, float_to_bits(static_cast<float>(value)), 4);
+		}
+		else
+		{
+			m_out.put(static_cast<char>(0xfb));
+			put_big_endian(m_out, double_to_bits(value), 8);
+		}
+	}
+
+	////////////////////////////////////////////////////////////////
+	void cbor_encoder::string_value(const char* data, size_t size)
+	{
+		write_head(major_text, size);
+		m_out.write(data, size);
+	}
+
+	////////////////////////////////////////////////////////////////
+	void cbor_encoder::byte_string_value(const char* data, size_t size)
+	{
+		write_head(major_bytes, size);
+		m_out.write(data, size);
+	}
+
+	////////////////////////////////////////////////////////////////
+	void cbor_encoder::begin_array(size_t size)
+	{
+		m_indefinite.push_back(size == unknown_size);
+		if (size == unknown_size)
+			m_out.put(static_cast<char>((major_array << 5) | 31));
+		else
+			write_head(major_array, size);
+	}
+
+	////////////////////////////////////////////////////////////////
+	void cbor_encoder::end_array()
+	{
+		if (m_indefinite.back())
+			m_out.put(static_cast<char>(cbor_break));
+		m_indefinite.pop_back();
+	}
+
+	////////////////////////////////////////////////////////////////
+	void cbor_encoder::begin_object(size_t size)
+	{
+		m_indefinite.push_back(size == unknown_size);
+		if (size == unknown_size)
+			m_out.put(static_cast<char>((major_map << 5) | 31));
+		else
+			write_head(major_map, size);
+	}
+
+	////////////////////////////////////////////////////////////////
+	void cbor_encoder::key(const char* data, size_t size)
+	{
+		string_value(data, size);
+	}
+
+	////////////////////////////////////////////////////////////////
+	void cbor_encoder::end_object()
+	{
+		end_array();
+	}
+
+	////////////////////////////////////////////////////////////////
+	void cbor_encoder::value(const Json& json)
+	{
+		write_cbor(json, *this);
+	}
+
+	// ================================================================
+	//                          cbor_decoder
+	// ================================================================
+
+	////////////////////////////////////////////////////////////////
+	cbor_decoder::cbor_decoder(json_sax& handler, const parse_limits& limits) :
+		m_handler(handler),
+		m_limits(limits)
+	{
+	}
+
+	////////////////////////////////////////////////////////////////
+	void cbor_decoder::reset()
+	{
+		m_frames.clear();
+		m_head_size = 0;
+		m_head_needed = 0;
+		m_string.clear();
+		m_string_remaining = 0;
+		m_string_state = string_state::none;
+		m_nodes = 0;
+		m_offset = 0;
+		m_done = false;
+		m_result = parse_result();
+	}
+
+	////////////////////////////////////////////////////////////////
+	bool cbor_decoder::fail(parse_error error)
+	{
+		m_result.error = error;
+		m_result.offset = m_offset;
+		return false;
+	}
+
+	////////////////////////////////////////////////////////////////
+	size_t cbor_decoder::feed(const char* data, size_t size)
+	{
+		const char* p = data;
+		const char* end = data + size;
+		while (p != end && !m_done && m_result.ok())
+		{
+			if (m_offset >= m_limits.max_input_size)
+			{
+				fail(parse_error::input_too_large);
+				break;
+			}
+
+			if (m_string_state == string_state::definite || m_string_state == string_state::chunk)
+			{
+				// string content, copied in blocks
+				uint64_t available = static_cast<uint64_t>(end - p);
+				if (m_limits.max_input_size - m_offset < available)
+					available = m_limits.max_input_size - m_offset;
+				const size_t n = static_cast<size_t>(m_string_remaining < available ? m_string_remaining : available);
+				m_string.append(p, n);
+				p += n;
+				m_offset += n;
+				m_string_remaining -= n;
+				if (m_string_remaining == 0)
+				{
+					if (m_string_state == string_state::definite)
+						finish_string();
+					else
+						m_string_state = string_state::chunk_header;
+				}
+				continue;
+			}
+
+			// the head of a data item: initial byte and argument
+			const unsigned char byte = static_cast<unsigned char>(*p++);
+			++m_offset;
+			m_head[m_head_size++] = byte;
+			if (m_head_size == 1)
+			{
+				const unsigned info = byte & 0x1f;
+				if (info < 24 || info == 31)
+					m_head_needed = 1;
+				else if (info <= 27)
+					m_head_needed = 1 + (size_t(1) << (info - 24));
+				else
+				{
+					--m_offset;
+					fail(parse_error::unexpected_character);
+					break;
+				}
+			}
+			if (m_head_size == m_head_needed)
+			{
+				m_head_size = 0;
+				if (!process_head())
+					break;
+			}
+		}
+		return p - data;
+	}
+
+	////////////////////////////////////////////////////////////////
+	bool cbor_decoder::process_head()
+	{
+		const unsigned major = m_head[0] >> 5;
+		const unsigned info = m_head[0] & 0x1f;
+		const bool indefinite = info == 31;
+		const uint64_t argument = info < 24 ? info : read_big_endian(reinterpret_cast<const char*>(m_head) + 1, m_head_needed - 1);
+		// for error reporting, the item begins at the initial byte
+		m_offset -= m_head_needed;
+
+		if (m_string_state == string_state::chunk_header)
+		{
+			// inside an indefinite length string only chunks of the same type or a break are valid
+			if (m_head[0] == cbor_break)
+			{
+				m_offset += m_head_needed;
+				finish_string();
+				return true;
+			}
+			if (major != m_string_major || indefinite)
+				return fail(parse_error::unexpected_character);
+			if (argument > m_limits.max_string_length - m_string.size())
+				return fail(parse_error::string_too_long);
+			m_offset += m_head_needed;
+			m_string_remaining = argument;
+			if (argument != 0)
+				m_string_state = string_state::chunk;
+			return true;
+		}
+
+		if (m_head[0] == cbor_break)
+		{
+			if (m_frames.empty() || !m_frames.back().indefinite || !m_frames.back().key_next)
+				return fail(parse_error::unexpected_character);
+			m_offset += m_head_needed;
+			const bool is_object = m_frames.back().is_object;
+			m_frames.pop_back();
+			if (is_object)
+				m_handler.end_object();
+			else
+				m_handler.end_array();
+			complete_item();
+			return true;
+		}
+
+		if (major == major_tag)
+		{
+			// tags are ignored, the tagged item follows
+			if (indefinite)
+				return fail(parse_error::unexpected_character);
+			m_offset += m_head_needed;
+			return true;
+		}
+
+		const bool is_key = !m_frames.empty() && m_frames.back().is_object && m_frames.back().key_next;
+		if (is_key && major != major_text && major != major_bytes)
+			return fail(parse_error::unsupported_type);
+		if (!is_key && ++m_nodes > m_limits.max_nodes)
+			return fail(parse_error::node_limit_exceeded);
+		if (indefinite && (major == major_unsigned || major == major_negative))
+			return fail(parse_error::unexpected_character);
+
+		switch (major)
+		{
+		case major_unsigned:
+			m_offset += m_head_needed;
+			if (argument > static_cast<uint64_t>(INT64_MAX))
+				// does not fit our integer type
+				m_handler.floating_point_value(static_cast<json_float>(argument));
+			else
+				m_handler.integer_value(static_cast<json_int>(argument));
+			complete_item();
+			return true;
+
+		case major_negative:
+			m_offset += m_head_needed;
+			if (argument > static_cast<uint64_t>(INT64_MAX))
+				m_handler.floating_point_value(-1.0 - static_cast<json_float>(argument));
+			else
+				m_handler.integer_value(-1 - static_cast<json_int>(argument));
+			complete_item();
+			return true;
+
+		case major_bytes:
+		case major_text:
+			if (!indefinite && argument > m_limits.max_string_length)
+				return fail(parse_error::string_too_long);
+			m_offset += m_head_needed;
+			m_string.clear();
+			m_string_major = major;
+			m_string_is_key = is_key;
+			m_string_remaining = argument;
+			if (indefinite)
+				m_string_state = string_state::chunk_header;
+			else if (argument != 0)
+				m_string_state = string_state::definite;
+			else
+				finish_string();
+			return true;
+
+		case major_array:
+		case major_map:
+		{
+			if (m_frames.size() >= m_limits.max_depth)
+				return fail(parse_error::depth_limit_exceeded);
+			m_offset += m_head_needed;
+			const bool is_object = major == major_map;
+			if (is_object)
+				m_handler.begin_object(indefinite ? json_sax::unknown_size : static_cast<size_t>(argument));
+			else
+				m_handler.begin_array(indefinite ? json_sax::unknown_size : static_cast<size_t>(argument));
+			if (!indefinite && argument == 0)
+			{
+				if (is_object)
+					m_handler.end_object();
+				else
+					m_handler.end_array();
+				complete_item();
+				return true;
+			}
+			frame f;
+			f.remaining = is_object ? argument * 2 : argument;
+			f.is_object = is_object;
+			f.key_next = true;
+			f.indefinite = indefinite;
+			m_frames.push_back(f);
+			return true;
+		}
+
+		default: // major_simple
+			switch (info)
+			{
+			case 20:
+				m_handler.boolean_value(false);
+				break;
+			case 21:
+				m_handler.boolean_value(true);
+				break;
+			case 22: // null
+			case 23: // undefined
+				m_handler.null_value();
+				break;
+			case 25:
+				m_handler.floating_point_value(half_to_double(static_cast<uint16_t>(argument)));
+				break;
+			case 26:
+				m_handler.floating_point_value(bits_to_float(static_cast<uint32_t>(argument)));
+				break;
+			case 27:
+				m_handler.floating_point_value(bits_to_double(argument));
+				break;
+			default:
+				return fail(parse_error::unsupported_type);
+			}
+			m_offset += m_head_needed;
+			complete_item();
+			return true;
+		}
+	}
+
+	////////////////////////////////////////////////////////////////
+	void cbor_decoder::finish_string()
+	{
+		m_string_state = string_state::none;
+		if (m_string_is_key)
+			m_handler.key(m_string.data(), m_string.size());
+		else
+			m_handler.string_value(m_string.data(), m_string.size());
+		complete_item();
+	}
+
+	////////////////////////////////////////////////////////////////
+	void cbor_decoder::complete_item()
+	{
+		while (true)
+		{
+			if (m_frames.empty())
+			{
+				m_done = true;
+				return;
+			}
+			frame& f = m_frames.back();
+			if (f.is_object)
+				f.key_next = !f.key_next;
+			if (f.indefinite || --f.remaining != 0)
+				return;
+			// the container is complete, this completes an item of the parent
+			const bool is_object = f.is_object;
+			m_frames.pop_back();
+			if (is_object)
+				m_handler.end_object();
+			else
+				m_handler.end_array();
+		}
+	}
+
+	// ================================================================
+	//                            Json
+	// ================================================================
+
+	////////////////////////////////////////////////////////////////
+	void Json::to_cbor(output_sink& sink) const
+	{
+		cbor_encoder encoder(sink);
+		encoder.value(*this);
+	}
+
+	////////////////////////////////////////////////////////////////
+	std::string Json::to_cbor() const
+	{
+		std::string str;
+		string_sink sink(str);
+		this->to_cbor(sink);
+		return str;
+	}
+
+	////////////////////////////////////////////////////////////////
+	parse_result Json::from_cbor(const char* begin, const char* end, Json& out, const parse_limits& limits)
+	{
+		json_sax_builder builder(out);
+		cbor_decoder decoder(builder, limits);
+		const size_t consumed = decoder.feed(begin, end - begin);
+		parse_result result = decoder.result();
+		if (result.ok())
+		{
+			if (decoder.done())
+				result.offset = consumed;
+			else
+			{
+				result.error = parse_error::unexpected_end;
+				result.offset = end - begin;
+			}
+		}
+		return result;
+	}
+
+	////////////////////////////////////////////////////////////////
+	Json Json::from_cbor(const char* begin, const char* end, const parse_limits& limits)
+	{
+		Json obj;
+		const parse_result result = from_cbor(begin, end, obj, limits);
+		if (!result)
+			JSON_LITE_THROW(parsing_error(to_string(result.error)));
+		return obj;
+	}
+}
@@ -0,0 +1,422 @@
+#include "json_lite.hpp"
+#include "json_lite_parser.hpp"
+
+// Pull parser over a JSON text.
+// Scalars, keys and brackets are tokenized one at a time with the tokenizer of the parser,
+// `read_value()` runs the parser on a single value with the limits left by the enclosing containers.
+
+namespace json_lite
+{
+	using namespace detail;
+
+	namespace
+	{
+		// number of values (containers included) in a parsed value, as counted by the parser
+		size_t count_nodes(const Json& json)
+		{
+			switch (json.data_type())
+			{
+			case json_data_type::array:
+			{
+				size_t count = 1;
+				for (const Json& element : json.get<json_data_type::array>())
+					count += count_nodes(element);
+				return count;
+			}
+			case json_data_type::object:
+			{
+				size_t count = 1;
+				for (const auto& member : json.get<json_data_type::object>())
+					count += count_nodes(member.second);
+				return count;
+			}
+			case json_data_type::integer_array:
+				return 1 + json.get<json_data_type::integer_array>().size();
+			case json_data_type::floating_point_array:
+				return 1 + json.get<json_data_type::floating_point_array>().size();
+			default:
+				return 1;
+			}
+		}
+	}
+
+	struct json_cursor::impl
+	{
+		enum class state { value, key, after_value, done, failed };
+
+		impl(const char* begin, const char* end, const parse_options& options) :
+			begin(begin),
+			end(end),
+			p(begin),
+			options(options),
+			nested(options),
+			json_parser(nested)
+		{
+			// the input size is checked here once, the values parsed by `read_value()` are parts of it
+			nested.max_input_size = static_cast<size_t>(-1);
+			if (static_cast<size_t>(end - begin) > options.max_input_size)
+				fail(parse_error::input_too_large, begin + options.max_input_size);
+			else if (skip_whitespace(begin, end) == end)
+			{
+				s = state::failed;
+				result.error = parse_error::empty_input;
+				locate(result, begin, end);
+			}
+		}
+
+		bool fail(parse_error error, const char* where)
+		{
+			s = state::failed;
+			result.error = error;
+			locate(result, begin, where);
+			return false;
+		}
+
+		bool fail_with_parser()
+		{
+			return fail(json_parser.error, json_parser.where);
+		}
+
+		json_token error(parse_error error, const char* where)
+		{
+			fail(error, where);
+			return json_token::error;
+		}
+
+		json_token parser_error()
+		{
+			fail_with_parser();
+			return json_token::error;
+		}
+
+		char closing() const
+		{
+			return frames.back() ? '}' : ']';
+		}
+
+		json_token close()
+		{
+			const bool is_object = frames.back();
+			frames.pop_back();
+			++p;
+			s = state::after_value;
+			return is_object ? json_token::end_object : json_token::end_array;
+		}
+
+		// Move to the beginning of the next value (or key) consuming the separating comma, if any.
+		// Returns false at the end of a container or of the document and on errors.
+		bool advance()
+		{
+			if (s == state::done || s == state::failed)
+				return false;
+			if (s == state::after_value)
+			{
+				if (frames.empty())
+					return false;
+				p = skip_whitespace(p, end);
+				if (p == end)
+					return fail(parse_error::unexpected_end, p);
+				if (*p == closing())
+					return false;
+				if (*p != ',')
+					return fail(parse_error::unexpected_character, p);
+				++p;
+				can_close = true; // trailing comma, accepted
+				s = frames.back() ? state::key : state::value;
+			}
+			p = skip_whitespace(p, end);
+			if (p == end)
+				return fail(parse_error::unexpected_end, p);
+			return !(can_close && !frames.empty() && *p == closing());
+		}
+
+		// a value will be parsed, check the node limit
+		bool count_node()
+		{
+			if (++nodes > options.max_nodes)
+				return fail(parse_error::node_limit_exceeded, p);
+			return true;
+		}
+
+		// the position after the string starting at `from`, without unescaping it
+		const char* skip_string(const char* from)
+		{
+			for (const char* q = from + 1; q != end; ++q)
+			{
+				if (*q == '"')
+					return q + 1;
+				if (*q == '\\' && ++q == end)
+					break;
+			}
+			fail(parse_error::unexpected_end, end);
+			return nullptr;
+		}
+
+		// the position after the container starting at `from`, matching the brackets only
+		const char* skip_container(const char* from)
+		{
+			const char opening = *from;
+			const size_t max_nesting = options.max_depth - frames.size();
+			size_t nesting = 0;
+			for (const char* q = from; q != end; ++q)
+			{
+				switch (*q)
+				{
+				case '[':
+				case '{':
+					if (nesting++ >= max_nesting)
+					{
+						fail(parse_error::depth_limit_exceeded, q);
+						return nullptr;
+					}
+					break;
+				case ']':
+				case '}':
+					if (--nesting == 0)
+					{
+						if (*q != (opening == '{' ? '}' : ']'))
+						{
+							fail(parse_error::unexpected_character, q);
+							return nullptr;
+						}
+						return q + 1;
+					}
+					break;
+				case '"':
+					q = skip_string(q);
+					if (q == nullptr)
+						return nullptr;
+					--q;
+					break;
+				}
+			}
+			fail(parse_error::unexpected_end, end);
+			return nullptr;
+		}
+
+		const char* begin;
+		const char* end;
+		const char* p;
+		state s = state::value;
+		bool can_close = false; // an empty container or a trailing comma, the container can be closed
+		std::vector<bool> frames; // the open containers, true for objects
+		size_t nodes = 0;
+		const parse_options options;
+		parse_options nested; // the limits of the values parsed by `read_value()`
+		parser<status_policy> json_parser;
+		Json scalar;
+		std::string string;
+		parse_result result;
+	};
+
+	////////////////////////////////////////////////////////////////
+	json_cursor::json_cursor(const char* begin, const char* end, const parse_options& options) :
+		m_impl(new impl(begin, end, options))
+	{
+	}
+
+	////////////////////////////////////////////////////////////////
+	json_cursor::~json_cursor() = default;
+
+	////////////////////////////////////////////////////////////////
+	json_token json_cursor::next()
+	{
+		impl& c = *m_impl;
+		if (!c.advance())
+		{
+			if (c.s == impl::state::failed)
+				return json_token::error;
+			if (c.s == impl::state::after_value && c.frames.empty())
+			{
+				// leniency: trailing content after the document is not an error
+				c.s = impl::state::done;
+				c.result.offset = c.p - c.begin;
+			}
+			if (c.s == impl::state::done)
+				return json_token::end;
+			return c.close();
+		}
+
+		if (c.s == impl::state::key)
+		{
+			if (*c.p != '"')
+				return c.error(parse_error::unexpected_character, c.p);
+			c.string.clear();
+			const char* p = c.json_parser.parse_json_string(c.p, c.end, c.string);
+			if (status_policy::failed(p))
+				return c.parser_error();
+			p = skip_whitespace(p, c.end);
+			if (p == c.end)
+				return c.error(parse_error::unexpected_end, p);
+			if (*p != ':')
+				return c.error(parse_error::unexpected_character, p);
+			c.p = p + 1;
+			c.can_close = false;
+			c.s = impl::state::value;
+			return json_token::key;
+		}
+
+		if (!c.count_node())
+			return json_token::error;
+		if (*c.p == '[' || *c.p == '{')
+		{
+			const bool is_object = *c.p == '{';
+			if (c.frames.size() >= c.options.max_depth)
+				return c.error(parse_error::depth_limit_exceeded, c.p);
+			c.frames.push_back(is_object);
+			++c.p;
+			c.can_close = true;
+			c.s = is_object ? impl::state::key : impl::state::value;
+			return is_object ? json_token::begin_object : json_token::begin_array;
+		}
+
+		const char* p;
+		if (*c.p == '"')
+		{
+			c.string.clear();
+			p = c.json_parser.parse_json_string(c.p, c.end, c.string);
+		}
+		else
+			p = c.json_parser.parse_scalar(c.p, c.end, c.scalar);
+		if (status_policy::failed(p))
+			return c.parser_error();
+		const bool is_string = *c.p == '"';
+		c.p = p;
+		c.can_close = false;
+		c.s = impl::state::after_value;
+		if (is_string)
+			return json_token::string;
+		switch (c.scalar.data_type())
+		{
+		case json_data_type::boolean:
+			return json_token::boolean;
+		case json_data_type::integer:
+			return json_token::integer;
+		case json_data_type::floating_point:
+			return json_token::floating_point;
+		case json_data_type::raw_number:
+			// `parse_options::raw_numbers` applies to `read_value()`, the tokens are converted
+			return c.scalar.get<json_data_type::raw_number>().is_integer() ? json_token::integer : json_token::floating_point;
+		default:
+			return json_token::null_value;
+		}
+	}
+
+	////////////////////////////////////////////////////////////////
+	bool json_cursor::boolean() const
+	{
+		return m_impl->scalar.get<json_data_type::boolean>();
+	}
+
+	////////////////////////////////////////////////////////////////
+	json_int json_cursor::integer() const
+	{
+		return m_impl->scalar.get<json_data_type::integer>();
+	}
+
+	////////////////////////////////////////////////////////////////
+	json_float json_cursor::floating_point() const
+	{
+		return m_impl->scalar.get<json_data_type::floating_point>();
+	}
+
+	////////////////////////////////////////////////////////////////
+	const std::string& json_cursor::string() const
+	{
+		return m_impl->string;
+	}
+
+	////////////////////////////////////////////////////////////////
+	bool json_cursor::skip_value()
+	{
+		impl& c = *m_impl;
+		if (!c.advance())
+			return false;
+
+		const char* p = c.p;
+		if (c.s == impl::state::key)
+		{
+			// skip the whole member
+			if (*p != '"')
+				return c.fail(parse_error::unexpected_character, p);
+			p = c.skip_string(p);
+			if (p == nullptr)
+				return false;
+			p = skip_whitespace(p, c.end);
+			if (p == c.end)
+				return c.fail(parse_error::unexpected_end, p);
+			if (*p != ':')
+				return c.fail(parse_error::unexpected_character, p);
+			p = skip_whitespace(p + 1, c.end);
+			if (p == c.end)
+				return c.fail(parse_error::unexpected_end, p);
+			c.p = p;
+		}
+
+		if (!c.count_node())
+			return false;
+		if (*p == '[' || *p == '{')
+			p = c.skip_container(p);
+		else if (*p == '"')
+			p = c.skip_string(p);
+		else
+		{
+			p = c.json_parser.parse_scalar(p, c.end, c.scalar);
+			if (status_policy::failed(p))
+				return c.fail_with_parser();
+		}
+		if (p == nullptr)
+			return false;
+		c.p = p;
+		c.can_close = false;
+		c.s = impl::state::after_value;
+		return true;
+	}
+
+	////////////////////////////////////////////////////////////////
+	bool json_cursor::read_value(Json& out)
+	{
+		impl& c = *m_impl;
+		if (!c.advance() || c.s == impl::state::key)
+			return false;
+
+		// the parser counts the nodes and the depth from zero
+		c.nested.max_depth = c.options.max_depth - c.frames.size();
+		c.nested.max_nodes = c.options.max_nodes - c.nodes;
+		const char* p = c.json_parser.parse(c.p, c.end, out);
+		if (status_policy::failed(p))
+			return c.fail_with_parser();
+		c.nodes += count_nodes(out);
+		c.p = p;
+		c.can_close = false;
+		c.s = impl::state::after_value;
+		return true;
+	}
+
+	////////////////////////////////////////////////////////////////
+	bool json_cursor::read_raw(const char*& begin, const char*& end)
+	{
+		impl& c = *m_impl;
+		if (!c.advance() || c.s == impl::state::key)
+			return false;
+
+		const char* value = c.p;
+		if (!skip_value())
+			return false;
+		begin = value;
+		end = c.p;
+		return true;
+	}
+
+	////////////////////////////////////////////////////////////////
+	size_t json_cursor::depth() const
+	{
+		return m_impl->frames.size();
+	}
+
+	////////////////////////////////////////////////////////////////
+	const parse_result& json_cursor::result() const
+	{
+		return m_impl->result;
+	}
+}
@@ -0,0 +1,325 @@
+#include "json_lite.hpp"
+#include "json_lite_internal.hpp"
+
+// Deep equality and structural hashing.
+// The hash uses the wyhash mixing function: a 64×64 → 128 bit multiplication folded to 64 bits.
+
+namespace json_lite
+{
+	namespace
+	{
+		const uint64_t secret[4] = { 0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL, 0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL };
+
+		// seeds that separate the types
+		const uint64_t null_seed = 0x1d8e4e27c47d124fULL;
+		const uint64_t true_seed = 0x2f7a2b3c4d5e6f71ULL;
+		const uint64_t false_seed = 0x3e8b9c0d1f2a3b4cULL;
+		const uint64_t number_seed = 0x4a5b6c7d8e9f0a1bULL;
+		const uint64_t string_seed = 0x5c6d7e8f9a0b1c2dULL;
+		const uint64_t array_seed = 0x6e7f8091a2b3c4d5ULL;
+		const uint64_t object_seed = 0x7f8091a2b3c4d5e6ULL;
+
+		inline void multiply(uint64_t& a, uint64_t& b)
+		{
+#ifdef __SIZEOF_INT128__
+			const __uint128_t product = static_cast<__uint128_t>(a) * b;
+			a = static_cast<uint64_t>(product);
+			b = static_cast<uint64_t>(product >> 64);
+#else
+			// 32-bit targets (e.g. the ESP32)
+			const uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+			const uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+			const uint64_t t = rl + (rm0 << 32);
+			const uint64_t lo = t + (rm1 << 32);
+			const uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + (t < rl) + (lo < t);
+			a = lo;
+			b = hi;
+#endif
+		}
+
+		inline uint64_t mix(uint64_t a, uint64_t b)
+		{
+			multiply(a, b);
+			return a ^ b;
+		}
+
+		inline uint64_t read64(const unsigned char* p)
+		{
+			uint64_t value;
+			memcpy(&value, p, sizeof(value));
+			return value;
+		}
+
+		inline uint64_t read32(const unsigned char* p)
+		{
+			uint32_t value;
+			memcpy(&value, p, sizeof(value));
+			return value;
+		}
+
+		// wyhash of a byte string
+		uint64_t hash_bytes(const void* data, size_t size, uint64_t seed)
+		{
+			const unsigned char* p = static_cast<const unsigned char*>(data);
+			seed ^= mix(seed ^ secret[0], secret[1]);
+			uint64_t a;
+			uint64_t b;
+			if (size <= 16)
+			{
+				if (size >= 4)
+				{
+					a = (read32(p) << 32) | read32(p + ((size >> 3) << 2));
+					b = (read32(p + size - 4) << 32) | read32(p + size - 4 - ((size >> 3) << 2));
+				}
+				else if (size > 0)
+				{
+					a = (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[size >> 1]) << 8) | p[size - 1];
+					b = 0;
+				}
+				else
+					a = b = 0;
+			}
+			else
+			{
+				size_t i = size;
+				if (i > 48)
+				{
+					uint64_t seed1 = seed;
+					uint64_t seed2 = seed;
+					do
+					{
+						seed = mix(read64(p) ^ secret[1], read64(p + 8) ^ seed);
+						seed1 = mix(read64(p + 16) ^ secret[2], read64(p + 24) ^ seed1);
+						seed2 = mix(read64(p + 32) ^ secret[3], read64(p + 40) ^ seed2);
+						p += 48;
+						i -= 48;
+					} while (i > 48);
+					seed ^= seed1 ^ seed2;
+				}
+				while (i > 16)
+				{
+					seed = mix(read64(p) ^ secret[1], read64(p + 8) ^ seed);
+					i -= 16;
+					p += 16;
+				}
+				a = read64(p + i - 16);
+				b = read64(p + i - 8);
+			}
+			a ^= secret[1];
+			b ^= seed;
+			multiply(a, b);
+			return mix(a ^ secret[0] ^ size, b ^ secret[1]);
+		}
+
+		uint64_t hash_integer(Json::Int value)
+		{
+			return mix(static_cast<uint64_t>(value) ^ secret[0], number_seed ^ secret[1]);
+		}
+
+		// integral values hash as the integers, so that `1.0` and `1` have the same hash
+		uint64_t hash_floating(Json::Float value)
+		{
+			if (value >= -9223372036854775808.0 && value < 9223372036854775808.0 && static_cast<Json::Float>(static_cast<Json::Int>(value)) == value)
+				return hash_integer(static_cast<Json::Int>(value));
+			return mix(detail::double_to_bits(value) ^ secret[2], number_seed ^ secret[3]);
+		}
+
+		// the elements are combined in order
+		inline uint64_t combine(uint64_t hash, uint64_t element)
+		{
+			return mix(hash ^ element, secret[1]);
+		}
+
+		// an integer and a floating point number with the same value
+		bool equal_numbers(Json::Int integer, Json::Float floating)
+		{
+			return floating >= -9223372036854775808.0 && floating < 9223372036854775808.0 &&
+				static_cast<Json::Float>(integer) == floating && static_cast<Json::Int>(floating) == integer;
+		}
+
+		// the value of a raw number, as the parser would have stored it
+		Json raw_value(const Json& json)
+		{
+			const json_raw_number& number = json.get<json_data_type::raw_number>();
+			return number.is_integer() ? Json(number.integer()) : Json(number.floating_point());
+		}
+
+		// an element of a generic array and an element of a packed one
+		bool equal_element(const Json& element, Json::Int value)
+		{
+			switch (element.data_type())
+			{
+			case json_data_type::integer:
+				return element.get<json_data_type::integer>() == value;
+			case json_data_type::floating_point:
+				return equal_numbers(value, element.get<json_data_type::floating_point>());
+			case json_data_type::raw_number:
+				return equal_element(raw_value(element), value);
+			default:
+				return false;
+			}
+		}
+
+		bool equal_element(const Json& element, Json::Float value)
+		{
+			switch (element.data_type())
+			{
+			case json_data_type::integer:
+				return equal_numbers(element.get<json_data_type::integer>(), value);
+			case json_data_type::floating_point:
+				return element.get<json_data_type::floating_point>() == value;
+			case json_data_type::raw_number:
+				return equal_element(raw_value(element), value);
+			default:
+				return false;
+			}
+		}
+
+		bool equal_element(Json::Int element, Json::Float value) { return equal_numbers(element, value); }
+
+		template <class X, class Y>
+		bool equal_sequences(const std::vector<X>& x, const std::vector<Y>& y)
+		{
+			if (x.size() != y.size())
+				return false;
+			for (size_t i = 0; i < x.size(); ++i)
+				if (!equal_element(x[i], y[i]))
+					return false;
+			return true;
+		}
+
+		// the elements of arrays with different data types (packed and generic), one by one
+		// The packed side is read as numbers, nothing is copied or unpacked.
+		bool equal_elements(const Json& a, const Json& b)
+		{
+			switch (a.data_type())
+			{
+			case json_data_type::array:
+				return b.is(json_data_type::integer_array) ?
+					equal_sequences(a.get<json_data_type::array>(), b.get<json_data_type::integer_array>()) :
+					equal_sequences(a.get<json_data_type::array>(), b.get<json_data_type::floating_point_array>());
+			case json_data_type::integer_array:
+				return b.is(json_data_type::array) ?
+					equal_sequences(b.get<json_data_type::array>(), a.get<json_data_type::integer_array>()) :
+					equal_sequences(a.get<json_data_type::integer_array>(), b.get<json_data_type::floating_point_array>());
+			default:
+				return b.is(json_data_type::array) ?
+					equal_sequences(b.get<json_data_type::array>(), a.get<json_data_type::floating_point_array>()) :
+					equal_sequences(b.get<json_data_type::integer_array>(), a.get<json_data_type::floating_point_array>());
+			}
+		}
+	}
+
+	////////////////////////////////////////////////////////////////
+	uint64_t Json::hash() const
+	{
+		switch (m_data_type)
+		{
+		case json_data_type::null:
+			return null_seed;
+		case json_data_type::boolean:
+			return m_value.boolean ? true_seed : false_seed;
+		case json_data_type::integer:
+			return hash_integer(m_value.integer);
+		case json_data_type::floating_point:
+			return hash_floating(m_value.floating);
+		case json_data_type::raw_number:
+			return m_value.raw_number.is_integer() ? hash_integer(m_value.raw_number.integer()) : hash_floating(m_value.raw_number.floating_point());
+		case json_data_type::string:
+			return hash_bytes(m_value.string.data(), m_value.string.size(), string_seed);
+		case json_data_type::array:
+		{
+			uint64_t hash = array_seed;
+			for (const Json& element : m_value.array)
+				hash = combine(hash, element.hash());
+			return mix(hash ^ m_value.array.size(), secret[2]);
+		}
+		case json_data_type::integer_array:
+		{
+			uint64_t hash = array_seed;
+			for (Int element : m_value.integer_array)
+				hash = combine(hash, hash_integer(element));
+			return mix(hash ^ m_value.integer_array.size(), secret[2]);
+		}
+		case json_data_type::floating_point_array:
+		{
+			uint64_t hash = array_seed;
+			for (Float element : m_value.floating_array)
+				hash = combine(hash, hash_floating(element));
+			return mix(hash ^ m_value.floating_array.size(), secret[2]);
+		}
+		case json_data_type::object:
+		{
+			// a sum of the member hashes, independent of the order
+			uint64_t sum = 0;
+			for (const auto& member : m_value.object)
+				sum += mix(hash_bytes(member.first.data(), member.first.size(), object_seed), member.second.hash() ^ secret[3]);
+			return mix(sum ^ object_seed ^ m_value.object.size(), secret[2]);
+		}
+		default:
+			return 0;
+		}
+	}
+
+	////////////////////////////////////////////////////////////////
+	bool operator==(const Json& a, const Json& b)
+	{
+		if (&a == &b)
+			return true;
+		if (a.is(json_data_type::raw_number))
+			return raw_value(a) == b;
+		if (b.is(json_data_type::raw_number))
+			return a == raw_value(b);
+		if (a.data_type() != b.data_type())
+		{
+			if (a.is(json_data_type::integer) && b.is(json_data_type::floating_point))
+				return equal_numbers(a.get<json_data_type::integer>(), b.get<json_data_type::floating_point>());
+			if (a.is(json_data_type::floating_point) && b.is(json_data_type::integer))
+				return equal_numbers(b.get<json_data_type::integer>(), a.get<json_data_type::floating_point>());
+			if (a.type() == json_type::array && b.type() == json_type::array)
+				return equal_elements(a, b);
+			return false;
+		}
+		switch (a.data_type())
+		{
+		case json_data_type::null:
+			return true;
+		case json_data_type::boolean:
+			return a.get<json_data_type::boolean>() == b.get<json_data_type::boolean>();
+		case json_data_type::integer:
+			return a.get<json_data_type::integer>() == b.get<json_data_type::integer>();
+		case json_data_type::floating_point:
+			return a.get<json_data_type::floating_point>() == b.get<json_data_type::floating_point>();
+		case json_data_type::string:
+			return a.get<json_data_type::string>() == b.get<json_data_type::string>();
+		case json_data_type::integer_array:
+			return a.get<json_data_type::integer_array>() == b.get<json_data_type::integer_array>();
+		case json_data_type::floating_point_array:
+			return a.get<json_data_type::floating_point_array>() == b.get<json_data_type::floating_point_array>();
+		case json_data_type::array:
+		{
+			const auto& x = a.get<json_data_type::array>();
+			const auto& y = b.get<json_data_type::array>();
+			if (x.size() != y.size())
+				return false;
+			for (size_t i = 0; i < x.size(); ++i)
+				if (x[i] != y[i])
+					return false;
+			return true;
+		}
+		case json_data_type::object:
+		{
+			const auto& x = a.get<json_data_type::object>();
+			const auto& y = b.get<json_data_type::object>();
+			if (x.size() != y.size())
+				return false;
+			for (auto i = x.begin(), j = y.begin(); i != x.end(); ++i, ++j)
+				if (i->first != j->first || i->second != j->second)
+					return false;
+			return true;
+		}
+		default:
+			return false;
+		}
+	}
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+// Internal utilities shared between the translation units of the library, not part of the public API.
+
+#include "json_lite.hpp"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#ifdef JSON_LITE_INSTRUMENTATION
+	#include <chrono>
+#endif
+
+// scoped timing probe, adds the time spent in the current scope to `json_stats::<probe>_ns`
+#ifdef JSON_LITE_INSTRUMENTATION
+	#define JSON_LITE_PROBE(probe) ::json_lite::detail::scoped_probe json_lite_probe_( \
+		::json_lite::detail::current_stats.probe##_ns, ::json_lite::detail::current_stats.probe##_calls)
+#else
+	#define JSON_LITE_PROBE(probe) ((void)0)
+#endif
+
+namespace json_lite
+{
+	namespace detail
+	{
+#ifdef JSON_LITE_INSTRUMENTATION
+		class scoped_probe
+		{
+		public:
+			scoped_probe(uint64_t& ns, uint64_t& calls) : m_ns(ns), m_start(std::chrono::steady_clock::now()) { ++calls; }
+
+			~scoped_probe()
+			{
+				m_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+			}
+
+		private:
+			uint64_t& m_ns;
+			std::chrono::steady_clock::time_point m_start;
+		};
+#endif
+
+		// Error policy used by the throwing API: errors throw `Json::parsing_error`
+		// and `failed()` is constant false, so the checks after each step are
+		// removed by the compiler and the success path has no extra branches.
+		struct throwing_policy
+		{
+			static bool failed(const char*) { return false; }
+
+			[[noreturn]] const char* fail(parse_error error, const char*)
+			{
+				(void)error; // unused without exceptions, `JSON_LITE_THROW` aborts
+				JSON_LITE_THROW(Json::parsing_error(to_string(error)));
+			}
+		};
+
+		// Error policy used by the non-throwing API: the error and its position
+		// are recorded and a null pointer is propagated up to the caller.
+		struct status_policy
+		{
+			parse_error error = parse_error::none;
+			const char* where = nullptr;
+
+			static bool failed(const char* p) { return p == nullptr; }
+
+			const char* fail(parse_error e, const char* w)
+			{
+				error = e;
+				where = w;
+				return nullptr;
+			}
+		};
+
+		// fills the position fields of `result` for the given byte of the input
+		inline void locate(parse_result& result, const char* begin, const char* where)
+		{
+			result.offset = where - begin;
+			result.line = 1;
+			result.column = 1;
+			for (const char* p = begin; p != where; ++p)
+			{
+				if (*p == '\n')
+				{
+					++result.line;
+					result.column = 1;
+				}
+				else
+					++result.column;
+			}
+		}
+
+		// append the serialization of `json` to `str`, the implementation of `Json::dump()`
+		void dump_to_string(const Json& json, std::string& str);
+
+		// append the quoted and escaped string to `result`
+		void append_escaped(std::string& result, const char* data, size_t size);
+
+		// write the `size` least significant bytes of `value` in big endian order
+		inline void put_big_endian(buffered_sink& out, uint64_t value, size_t size)
+		{
+			char bytes[8];
+			for (size_t i = 0; i < size; ++i)
+				bytes[i] = static_cast<char>(value >> (8 * (size - 1 - i)));
+			out.write(bytes, size);
+		}
+
+		// read a big endian unsigned integer of `size` bytes
+		inline uint64_t read_big_endian(const char* p, size_t size)
+		{
+			uint64_t value = 0;
+			for (size_t i = 0; i < size; ++i)
+				value = (value << 8) | static_cast<unsigned char>(p[i]);
+			return value;
+		}
+
+		inline uint64_t double_to_bits(double value)
+		{
+			uint64_t bits;
+			memcpy(&bits, &value, sizeof(bits));
+			return bits;
+		}
+
+		inline double bits_to_double(uint64_t bits)
+		{
+			double value;
+			memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+
+		inline uint32_t float_to_bits(float value)
+		{
+			uint32_t bits;
+			memcpy(&bits, &value, sizeof(bits));
+			return bits;
+		}
+
+		inline float bits_to_float(uint32_t bits)
+		{
+			float value;
+			memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+
+		// checks if `value` can be stored as a `float` without losing precision
+		inline bool is_exact_float(double value)
+		{
+			if (std::isnan(value))
+				return false; // keep the payload
+			if (std::isinf(value))
+				return true;
+			if (std::fabs(value) > FLT_MAX)
+				return false;
+			return static_cast<double>(static_cast<float>(value)) == value;
+		}
+	}
+}
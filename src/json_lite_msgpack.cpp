@@ -0,0 +1,463 @@
+#include "json_lite.hpp"
+#include "json_lite_internal.hpp"
+
+#include <algorithm>
+
+// MessagePack support, see https://github.com/msgpack/msgpack/blob/master/spec.md
+
+namespace json_lite
+{
+	using namespace detail;
+
+	namespace
+	{
+		void write_msgpack_header(buffered_sink& out, size_t size, uint8_t fix, size_t fix_max, uint8_t base8, uint8_t base16)
+		{
+			// `base8` is the 8 bit variant, the 16 and 32 bit ones follow it
+			if (size <= fix_max)
+				out.put(static_cast<char>(fix | size));
+			else if (base8 != 0 && size <= 0xff)
+			{
+				out.put(static_cast<char>(base8));
+				put_big_endian(out, size, 1);
+			}
+			else if (size <= 0xffff)
+			{
+				out.put(static_cast<char>(base16));
+				put_big_endian(out, size, 2);
+			}
+			else
+			{
+				out.put(static_cast<char>(base16 + 1));
+				put_big_endian(out, size, 4);
+			}
+		}
+
+		void write_msgpack_string(buffered_sink& out, const std::string& str)
+		{
+			write_msgpack_header(out, str.size(), 0xa0, 31, 0xd9, 0xda);
+			out.write(str.data(), str.size());
+		}
+
+		void write_msgpack_integer(buffered_sink& out, Json::Int value)
+		{
+			if (value >= 0)
+			{
+				const uint64_t u = static_cast<uint64_t>(value);
+				if (u < 0x80)
+					out.put(static_cast<char>(u));
+				else if (u <= 0xff)
+				{
+					out.put(static_cast<char>(0xcc));
+					put_big_endian(out, u, 1);
+				}
+				else if (u <= 0xffff)
+				{
+					out.put(static_cast<char>(0xcd));
+					put_big_endian(out, u, 2);
+				}
+				else if (u <= 0xffffffff)
+				{
+					out.put(static_cast<char>(0xce));
+					put_big_endian(out, u, 4);
+				}
+				else
+				{
+					out.put(static_cast<char>(0xcf));
+					put_big_endian(out, u, 8);
+				}
+			}
+			else
+			{
+				const uint64_t u = static_cast<uint64_t>(value);
+				if (value >= -32)
+					out.put(static_cast<char>(value));
+				else if (value >= -128)
+				{
+					out.put(static_cast<char>(0xd0));
+					put_big_endian(out, u, 1);
+				}
+				else if (value >= -32768)
+				{
+					out.put(static_cast<char>(0xd1));
+					put_big_endian(out, u, 2);
+				}
+				else if (value >= -2147483647LL - 1)
+				{
+					out.put(static_cast<char>(0xd2));
+					put_big_endian(out, u, 4);
+				}
+				else
+				{
+					out.put(static_cast<char>(0xd3));
+					put_big_endian(out, u, 8);
+				}
+			}
+		}
+
+		void write_msgpack_float(buffered_sink& out, Json::Float value)
+		{
+			if (is_exact_float(value))
+			{
+				out.put(static_cast<char>(0xca));
+				put_big_endian(out, float_to_bits(static_cast<float>(value)), 4);
+			}
+			else
+			{
+				out.put(static_cast<char>(0xcb));
+				put_big_endian(out, double_to_bits(value), 8);
+			}
+		}
+
+		void write_msgpack(const Json& json, buffered_sink& out)
+		{
+			switch (json.data_type())
+			{
+			case json_data_type::null:
+				out.put(static_cast<char>(0xc0));
+				break;
+			case json_data_type::boolean:
+				out.put(static_cast<char>(json.get<json_data_type::boolean>() ? 0xc3 : 0xc2));
+				break;
+			case json_data_type::integer:
+				write_msgpack_integer(out, json.get<json_data_type::integer>());
+				break;
+			case json_data_type::floating_point:
+				write_msgpack_float(out, json.get<json_data_type::floating_point>());
+				break;
+			case json_data_type::raw_number:
+			{
+				const json_raw_number& number = json.get<json_data_type::raw_number>();
+				if (number.is_integer())
+					write_msgpack_integer(out, number.integer());
+				else
+					write_msgpack_float(out, number.floating_point());
+				break;
+			}
+			case json_data_type::string:
+				write_msgpack_string(out, json.get<json_data_type::string>());
+				break;
+			case json_data_type::array:
+			{
+				const auto& array = json.get<json_data_type::array>();
+				write_msgpack_header(out, array.size(), 0x90, 15, 0, 0xdc);
+				for (const Json& value : array)
+					write_msgpack(value, out);
+				break;
+			}
+			case json_data_type::object:
+			{
+				const auto& object = json.get<json_data_type::object>();
+				write_msgpack_header(out, object.size(), 0x80, 15, 0, 0xde);
+				for (const auto& pair : object)
+				{
+					write_msgpack_string(out, pair.first);
+					write_msgpack(pair.second, out);
+				}
+				break;
+			}
+			case json_data_type::integer_array:
+			{
+				const auto& array = json.get<json_data_type::integer_array>();
+				write_msgpack_header(out, array.size(), 0x90, 15, 0, 0xdc);
+				for (Json::Int value : array)
+					write_msgpack_integer(out, value);
+				break;
+			}
+			case json_data_type::floating_point_array:
+			{
+				const auto& array = json.get<json_data_type::floating_point_array>();
+				write_msgpack_header(out, array.size(), 0x90, 15, 0, 0xdc);
+				for (Json::Float value : array)
+					write_msgpack_float(out, value);
+				break;
+			}
+			}
+		}
+
+		// an open array or map while decoding
+		struct msgpack_frame
+		{
+			Json* container;
+			size_t remaining;
+			bool is_object;
+		};
+
+		// Iterative MessagePack decoder, the same structure of the JSON parser:
+		// open containers are kept on an explicit stack.
+		template <class ErrorPolicy>
+		class msgpack_decoder : public ErrorPolicy
+		{
+		public:
+
+			explicit msgpack_decoder(const parse_limits& limits) : m_limits(limits) {}
+
+			const char* decode(const char* begin, const char* end, Json& out)
+			{
+				if (static_cast<size_t>(end - begin) > m_limits.max_input_size)
+					return this->fail(parse_error::input_too_large, begin + m_limits.max_input_size);
+
+				std::vector<msgpack_frame> frames;
+				size_t nodes = 0;
+				Json* target = &out;
+				const char* p = begin;
+				while (true)
+				{
+					// decode a value into `target`
+					if (++nodes > m_limits.max_nodes)
+						return this->fail(parse_error::node_limit_exceeded, p);
+					if (p == end)
+						return this->fail(parse_error::unexpected_end, p);
+
+					const char* item = p;
+					const uint8_t type = static_cast<uint8_t>(*p++);
+					size_t size = 0;
+					int container = 0; // 1 = array, 2 = object
+					if (type <= 0x7f)
+						*target = (Json::Int)type;
+					else if (type >= 0xe0)
+						*target = (Json::Int)static_cast<int8_t>(type);
+					else if (type <= 0x8f)
+					{
+						container = 2;
+						size = type & 0x0f;
+					}
+					else if (type <= 0x9f)
+					{
+						container = 1;
+						size = type & 0x0f;
+					}
+					else if (type <= 0xbf)
+					{
+						p = read_string(item, p, end, type & 0x1f, *target);
+						if (ErrorPolicy::failed(p))
+							return p;
+					}
+					else
+					{
+						switch (type)
+						{
+						case 0xc0:
+							*target = nullptr;
+							break;
+						case 0xc2:
+							*target = false;
+							break;
+						case 0xc3:
+							*target = true;
+							break;
+						case 0xc4: // bin 8
+						case 0xd9: // str 8
+						case 0xc5: // bin 16
+						case 0xda: // str 16
+						case 0xc6: // bin 32
+						case 0xdb: // str 32
+						{
+							const size_t n = (type == 0xc4 || type == 0xd9) ? 1 : (type == 0xc5 || type == 0xda) ? 2 : 4;
+							if (static_cast<size_t>(end - p) < n)
+								return this->fail(parse_error::unexpected_end, end);
+							const size_t length = static_cast<size_t>(read_big_endian(p, n));
+							p = read_string(item, p + n, end, length, *target);
+							if (ErrorPolicy::failed(p))
+								return p;
+							break;
+						}
+						case 0xca:
+							if (end - p < 4)
+								return this->fail(parse_error::unexpected_end, end);
+							*target = (Json::Float)bits_to_float(static_cast<uint32_t>(read_big_endian(p, 4)));
+							p += 4;
+							break;
+						case 0xcb:
+							if (end - p < 8)
+								return this->fail(parse_error::unexpected_end, end);
+							*target = (Json::Float)bits_to_double(read_big_endian(p, 8));
+							p += 8;
+							break;
+						case 0xcc:
+						case 0xcd:
+						case 0xce:
+						case 0xcf:
+						{
+							const size_t n = size_t(1) << (type - 0xcc);
+							if (static_cast<size_t>(end - p) < n)
+								return this->fail(parse_error::unexpected_end, end);
+							const uint64_t value = read_big_endian(p, n);
+							if (value > static_cast<uint64_t>(INT64_MAX))
+								// does not fit our integer type
+								*target = (Json::Float)value;
+							else
+								*target = (Json::Int)value;
+							p += n;
+							break;
+						}
+						case 0xd0:
+						case 0xd1:
+						case 0xd2:
+						case 0xd3:
+						{
+							const size_t n = size_t(1) << (type - 0xd0);
+							if (static_cast<size_t>(end - p) < n)
+								return this->fail(parse_error::unexpected_end, end);
+							// sign extend
+							const uint64_t value = read_big_endian(p, n);
+							const unsigned shift = static_cast<unsigned>(64 - 8 * n);
+							*target = (Json::Int)(static_cast<int64_t>(value << shift) >> shift);
+							p += n;
+							break;
+						}
+						case 0xdc:
+						case 0xdd:
+						case 0xde:
+						case 0xdf:
+						{
+							const size_t n = (type == 0xdc || type == 0xde) ? 2 : 4;
+							if (static_cast<size_t>(end - p) < n)
+								return this->fail(parse_error::unexpected_end, end);
+							container = (type <= 0xdd) ? 1 : 2;
+							size = static_cast<size_t>(read_big_endian(p, n));
+							p += n;
+							break;
+						}
+						default:
+							// extensions and reserved
+							return this->fail(parse_error::unsupported_type, item);
+						}
+					}
+
+					if (container != 0)
+					{
+						if (frames.size() >= m_limits.max_depth)
+							return this->fail(parse_error::depth_limit_exceeded, item);
+						if (container == 1)
+						{
+							*target = Json::make_array_t();
+							// every element takes at least one byte, do not trust the size more than that
+							target->get<json_data_type::array>().reserve(std::min<size_t>(size, end - p));
+						}
+						else
+							*target = Json::make_object_t();
+						if (size != 0)
+							frames.push_back({ target, size, container == 2 });
+					}
+
+					// find where the next value goes
+					while (true)
+					{
+						if (frames.empty())
+							return p;
+						msgpack_frame& frame = frames.back();
+						if (frame.remaining == 0)
+						{
+							frames.pop_back();
+							continue;
+						}
+						--frame.remaining;
+						if (frame.is_object)
+						{
+							p = read_key(p, end);
+							if (ErrorPolicy::failed(p))
+								return p;
+							target = &frame.container->get<json_data_type::object>()[std::move(m_key)];
+							JSON_LITE_STAT_ADD(map_insertions, 1);
+						}
+						else
+						{
+							auto& array = frame.container->get<json_data_type::array>();
+							array.emplace_back();
+							target = &array.back();
+						}
+						break;
+					}
+				}
+			}
+
+		private:
+
+			// read `length` bytes of string data into `target`, `item` is the beginning of the value
+			const char* read_string(const char* item, const char* p, const char* end, size_t length, Json& target)
+			{
+				if (length > m_limits.max_string_length)
+					return this->fail(parse_error::string_too_long, item);
+				if (static_cast<size_t>(end - p) < length)
+					return this->fail(parse_error::unexpected_end, end);
+				target = std::string(p, length);
+				return p + length;
+			}
+
+			// read a map key into `m_key`, keys must be strings
+			const char* read_key(const char* p, const char* end)
+			{
+				if (p == end)
+					return this->fail(parse_error::unexpected_end, p);
+				const uint8_t type = static_cast<uint8_t>(*p);
+				size_t length = 0;
+				size_t n = 0;
+				if (type >= 0xa0 && type <= 0xbf)
+					length = type & 0x1f;
+				else if (type == 0xd9 || type == 0xc4)
+					n = 1;
+				else if (type == 0xda || type == 0xc5)
+					n = 2;
+				else if (type == 0xdb || type == 0xc6)
+					n = 4;
+				else
+					return this->fail(parse_error::unsupported_type, p);
+				if (static_cast<size_t>(end - p - 1) < n)
+					return this->fail(parse_error::unexpected_end, end);
+				if (n != 0)
+					length = static_cast<size_t>(read_big_endian(p + 1, n));
+				if (length > m_limits.max_string_length)
+					return this->fail(parse_error::string_too_long, p);
+				const char* data = p + 1 + n;
+				if (static_cast<size_t>(end - data) < length)
+					return this->fail(parse_error::unexpected_end, end);
+				m_key.assign(data, length);
+				return data + length;
+			}
+
+			const parse_limits& m_limits;
+			std::string m_key;
+		};
+	}
+
+	////////////////////////////////////////////////////////////////
+	void Json::to_msgpack(output_sink& sink) const
+	{
+		buffered_sink out(sink);
+		write_msgpack(*this, out);
+	}
+
+	////////////////////////////////////////////////////////////////
+	std::string Json::to_msgpack() const
+	{
+		std::string str;
+		string_sink sink(str);
+		this->to_msgpack(sink);
+		return str;
+	}
+
+	////////////////////////////////////////////////////////////////
+	Json Json::from_msgpack(const char* begin, const char* end, const parse_limits& limits)
+	{
+		Json obj;
+		msgpack_decoder<throwing_policy>(limits).decode(begin, end, obj);
+		return obj;
+	}
+
+	////////////////////////////////////////////////////////////////
+	parse_result Json::from_msgpack(const char* begin, const char* end, Json& out, const parse_limits& limits)
+	{
+		parse_result result;
+		msgpack_decoder<status_policy> decoder(limits);
+		const char* last = decoder.decode(begin, end, out);
+		if (status_policy::failed(last))
+		{
+			result.error = decoder.error;
+			result.offset = decoder.where - begin;
+		}
+		else
+			result.offset = last - begin;
+		return result;
+	}
+}
@@ -0,0 +1,423 @@
+#include "json_lite.hpp"
+#include "json_lite_internal.hpp"
+#include "json_lite_parser.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Parallel parsing of a single document.
+//
+// The content of the top level container is cut in chunks, one per thread. The lexical
+// state at the beginning of a chunk (outside of strings, inside a string, right after a
+// backslash in a string) depends on everything before it, so each chunk is first scanned
+// once for each possible entry state, recording the exit state and the change of the
+// nesting depth. Composing these summaries in order gives the exact state and depth at
+// the beginning of every chunk, then each chunk looks for its first top level comma
+// (outside of strings at depth 1): the parts between these commas are made of whole
+// elements (or members) and are parsed concurrently by the normal parser.
+//
+// Parallel dumping splits the top level elements (or members) in chunks, the worker
+// threads serialize them into separate buffers while the calling thread writes the
+// finished buffers to the sink in order.
+
+namespace json_lite
+{
+	using namespace detail;
+
+	namespace
+	{
+		enum class scan_state { outside, string, escape };
+
+		const int scan_states = 3;
+
+		// the effect of a chunk for each entry state
+		struct chunk_summary
+		{
+			scan_state exit[scan_states];
+			long long depth[scan_states];     // depth change
+			long long min_depth[scan_states]; // minimum depth reached, relative to the entry
+		};
+
+		inline scan_state scan(scan_state state, char c, long long& depth)
+		{
+			switch (state)
+			{
+			case scan_state::outside:
+				if (c == '\"')
+					return scan_state::string;
+				if (c == '[' || c == '{')
+					++depth;
+				else if (c == ']' || c == '}')
+					--depth;
+				return scan_state::outside;
+			case scan_state::string:
+				if (c == '\\')
+					return scan_state::escape;
+				return c == '\"' ? scan_state::outside : scan_state::string;
+			default:
+				return scan_state::string;
+			}
+		}
+
+		void summarize(const char* begin, const char* end, chunk_summary& summary)
+		{
+			for (int entry = 0; entry < scan_states; ++entry)
+			{
+				scan_state state = static_cast<scan_state>(entry);
+				long long depth = 0;
+				long long min_depth = 0;
+				for (const char* p = begin; p != end; ++p)
+				{
+					state = scan(state, *p, depth);
+					if (depth < min_depth)
+						min_depth = depth;
+				}
+				summary.exit[entry] = state;
+				summary.depth[entry] = depth;
+				summary.min_depth[entry] = min_depth;
+			}
+		}
+
+		// Finds, from the given state and depth, the first top level comma (`closes` is false)
+		// or the end of the top level container (`closes` is true) in [begin, end).
+		// Returns `end` if there are none.
+		const char* find_boundary(const char* begin, const char* end, scan_state state, long long depth, bool& closes)
+		{
+			for (const char* p = begin; p != end; ++p)
+			{
+				if (state == scan_state::outside && depth == 1 && *p == ',')
+				{
+					closes = false;
+					return p;
+				}
+				state = scan(state, *p, depth);
+				if (depth == 0)
+				{
+					closes = true;
+					return p;
+				}
+			}
+			return end;
+		}
+
+		// runs `function(i)` for i in [0, count), each on its own thread (0 on the calling one)
+		template <class Function>
+		void run_parallel(size_t count, const Function& function)
+		{
+			std::vector<std::thread> threads;
+			threads.reserve(count - 1);
+			for (size_t i = 1; i < count; ++i)
+				threads.emplace_back([&function, i]() { function(i); });
+			function(0);
+			for (std::thread& thread : threads)
+				thread.join();
+		}
+
+		// a part of the top level container, parsed by one thread
+		struct segment
+		{
+			const char* begin;
+			const char* end;
+			std::vector<Json> elements;
+			std::vector<std::pair<std::string, Json>> members;
+			bool ok;
+		};
+
+		// the serialization of the top level elements [first, last) (or of the members from `member`),
+		// preceded by a comma unless they are the first ones
+		void dump_chunk(const Json& json, size_t first, size_t last, std::map<std::string, Json>::const_iterator member, std::string& str)
+		{
+			for (size_t i = first; i < last; ++i)
+			{
+				if (i != 0)
+					str += ',';
+				switch (json.data_type())
+				{
+				case json_data_type::array:
+					dump_to_string(json.get<json_data_type::array>()[i], str);
+					break;
+				case json_data_type::integer_array:
+					dump_to_string(Json(json.get<json_data_type::integer_array>()[i]), str);
+					break;
+				case json_data_type::floating_point_array:
+					dump_to_string(Json(json.get<json_data_type::floating_point_array>()[i]), str);
+					break;
+				default:
+					append_escaped(str, member->first.data(), member->first.size());
+					str += ':';
+					dump_to_string(member->second, str);
+					++member;
+					break;
+				}
+			}
+		}
+
+		size_t element_count(const Json& json)
+		{
+			switch (json.data_type())
+			{
+			case json_data_type::array: return json.get<json_data_type::array>().size();
+			case json_data_type::integer_array: return json.get<json_data_type::integer_array>().size();
+			case json_data_type::floating_point_array: return json.get<json_data_type::floating_point_array>().size();
+			case json_data_type::object: return json.get<json_data_type::object>().size();
+			default: return 0;
+			}
+		}
+
+		// the number of threads used to dump `json`, one per chunk at most
+		size_t dump_threads(const Json& json, const parallel_options& parallel)
+		{
+			const size_t chunk_elements = parallel.chunk_elements != 0 ? parallel.chunk_elements : 1;
+			const size_t chunks = (element_count(json) + chunk_elements - 1) / chunk_elements;
+			const size_t threads = parallel.threads != 0 ? parallel.threads : std::thread::hardware_concurrency();
+			return threads < chunks ? threads : chunks;
+		}
+	}
+
+	////////////////////////////////////////////////////////////////
+	Json Json::parse_parallel(const char* begin, const char* end, const parse_options& options, const parallel_options& parallel)
+	{
+		Json obj;
+		const parse_result result = parse_parallel(begin, end, obj, options, parallel);
+		if (!result)
+			JSON_LITE_THROW(parsing_error(to_string(result.error)));
+		return obj;
+	}
+
+	////////////////////////////////////////////////////////////////
+	parse_result Json::parse_parallel(const char* begin, const char* end, Json& out, const parse_options& options, const parallel_options& parallel)
+	{
+		const size_t size = end - begin;
+		size_t threads = parallel.threads != 0 ? parallel.threads : std::thread::hardware_concurrency();
+		const size_t min_chunk_size = parallel.min_chunk_size != 0 ? parallel.min_chunk_size : 1;
+		if (threads > size / min_chunk_size)
+			threads = size / min_chunk_size;
+
+		const char* first = skip_whitespace(begin, end);
+		if (threads < 2 || first == end || (*first != '[' && *first != '{') ||
+			options.max_nodes != parse_limits().max_nodes || options.max_depth == 0 || size > options.max_input_size)
+			return parse(begin, end, out, options);
+		const bool is_object = *first == '{';
+
+		// 1. summaries of the chunks of the content
+		const char* content = first + 1;
+		const size_t content_size = end - content;
+		std::vector<const char*> bounds(threads + 1);
+		for (size_t i = 0; i <= threads; ++i)
+			bounds[i] = content + content_size * i / threads;
+		std::vector<chunk_summary> summaries(threads);
+		run_parallel(threads, [&](size_t i) {
+			summarize(bounds[i], bounds[i + 1], summaries[i]);
+		});
+
+		// 2. state and depth at the beginning of each chunk, and the chunk where the top level container ends
+		std::vector<scan_state> states(threads + 1);
+		std::vector<long long> depths(threads + 1);
+		states[0] = scan_state::outside;
+		depths[0] = 1;
+		size_t last_chunk = threads;
+		for (size_t i = 0; i < threads; ++i)
+		{
+			const int entry = static_cast<int>(states[i]);
+			if (last_chunk == threads && depths[i] + summaries[i].min_depth[entry] <= 0)
+				last_chunk = i;
+			states[i + 1] = summaries[i].exit[entry];
+			depths[i + 1] = depths[i] + summaries[i].depth[entry];
+		}
+		if (last_chunk == threads)
+			// not terminated, let the sequential parser report the error
+			return parse(begin, end, out, options);
+
+		// 3. the first top level comma of each chunk, and the end of the container
+		std::vector<const char*> commas(last_chunk + 1, nullptr);
+		const char* close = nullptr;
+		run_parallel(last_chunk + 1, [&](size_t i) {
+			const char* chunk_end = bounds[i + 1];
+			bool closes = false;
+			const char* boundary = find_boundary(bounds[i], chunk_end, states[i], depths[i], closes);
+			if (boundary != chunk_end && !closes)
+				commas[i] = boundary;
+			if (i == last_chunk)
+			{
+				// continue up to the end of the container, the scan restarts after the comma
+				// (a comma does not change the state and the depth)
+				while (boundary != chunk_end && !closes)
+					boundary = find_boundary(boundary + 1, chunk_end, scan_state::outside, 1, closes);
+				if (closes)
+					close = boundary;
+			}
+		});
+		if (close == nullptr || *close != (is_object ? '}' : ']'))
+			// mismatched brackets, the depth does not tell `]` from `}`
+			return parse(begin, end, out, options);
+
+		// 4. the segments between the commas, parsed concurrently
+		std::vector<segment> segments;
+		const char* segment_begin = content;
+		for (size_t i = 1; i <= last_chunk; ++i)
+		{
+			if (commas[i] == nullptr || commas[i] > close)
+				continue;
+			segments.push_back({ segment_begin, commas[i], {}, {}, false });
+			segment_begin = commas[i] + 1;
+		}
+		segments.push_back({ segment_begin, close, {}, {}, false });
+
+		parse_options segment_options = options;
+		segment_options.max_depth = options.max_depth - 1; // the elements are inside the top level container
+		segment_options.recycle = false; // the elements are parsed into new values
+		run_parallel(segments.size(), [&](size_t i) {
+			segment& part = segments[i];
+			const bool last = i + 1 == segments.size();
+			parser<status_policy> json_parser(segment_options);
+			part.ok = !status_policy::failed(json_parser.parse_sequence(part.begin, part.end, is_object,
+				segments.size() == 1 || last, last, part.elements, part.members));
+		});
+		for (const segment& part : segments)
+			if (!part.ok)
+				// let the sequential parser report the first error with its exact position
+				return parse(begin, end, out, options);
+
+		// 5. join the segments
+		if (is_object)
+		{
+			out = make_object_t();
+			auto& object = out.get<json_data_type::object>();
+			for (segment& part : segments)
+				for (auto& member : part.members)
+					// the last duplicated key wins, as in `parse()`
+					object[std::move(member.first)] = std::move(member.second);
+		}
+		else
+		{
+			size_t count = 0;
+			for (const segment& part : segments)
+				count += part.elements.size();
+			std::vector<Json> array;
+			array.reserve(count);
+			for (segment& part : segments)
+				for (Json& element : part.elements)
+					array.push_back(std::move(element));
+			out = make_array_t();
+			out.get<json_data_type::array>().swap(array);
+			if (options.pack_numeric_arrays)
+				out.pack();
+		}
+
+		parse_result result;
+		result.offset = close + 1 - begin;
+		return result;
+	}
+
+	////////////////////////////////////////////////////////////////
+	void Json::dump_parallel(output_sink& sink, const parallel_options& parallel) const
+	{
+		const size_t count = element_count(*this);
+		const size_t chunk_elements = parallel.chunk_elements != 0 ? parallel.chunk_elements : 1;
+		const size_t chunks = (count + chunk_elements - 1) / chunk_elements;
+		const size_t threads = dump_threads(*this, parallel);
+		if (threads < 2)
+		{
+			std::string str;
+			dump_to_string(*this, str);
+			sink.write(str.data(), str.size());
+			return;
+		}
+
+		// the first member of each chunk
+		std::vector<std::map<std::string, Json>::const_iterator> members;
+		if (is(json_data_type::object))
+		{
+			members.reserve(chunks);
+			auto it = get<json_data_type::object>().begin();
+			for (size_t i = 0; i < count; ++i, ++it)
+				if (i % chunk_elements == 0)
+					members.push_back(it);
+		}
+
+		// A window of buffers: chunk `i` uses slot `i % window`, a worker takes a new
+		// chunk only when its slot has been written, bounding the memory in use.
+		const size_t window = 2 * threads;
+		std::vector<std::string> buffers(window);
+		std::vector<bool> ready(window, false);
+		size_t next = 0;
+		size_t written = 0;
+		std::mutex mutex;
+		std::condition_variable changed;
+
+		const auto worker = [&]() {
+			std::unique_lock<std::mutex> lock(mutex);
+			for (;;)
+			{
+				changed.wait(lock, [&]() { return next == chunks || next < written + window; });
+				if (next == chunks)
+					return;
+				const size_t chunk = next++;
+				lock.unlock();
+
+				std::string str;
+				const size_t first = chunk * chunk_elements;
+				const size_t last = first + chunk_elements < count ? first + chunk_elements : count;
+				dump_chunk(*this, first, last, members.empty() ? std::map<std::string, Json>::const_iterator() : members[chunk], str);
+
+				lock.lock();
+				buffers[chunk % window].swap(str);
+				ready[chunk % window] = true;
+				changed.notify_all();
+			}
+		};
+		// stops and joins the workers when leaving the scope, also if the sink throws
+		struct worker_guard
+		{
+			std::vector<std::thread> threads;
+			std::mutex& mutex;
+			std::condition_variable& changed;
+			size_t& next;
+			size_t chunks;
+
+			~worker_guard()
+			{
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					next = chunks;
+				}
+				changed.notify_all();
+				for (std::thread& thread : threads)
+					thread.join();
+			}
+		} workers{ {}, mutex, changed, next, chunks };
+		workers.threads.reserve(threads);
+		for (size_t i = 0; i < threads; ++i)
+			workers.threads.emplace_back(worker);
+
+		const char open = is(json_data_type::object) ? '{' : '[';
+		sink.write(&open, 1);
+		for (size_t chunk = 0; chunk < chunks; ++chunk)
+		{
+			std::string str;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				changed.wait(lock, [&]() { return ready[chunk % window]; });
+				str.swap(buffers[chunk % window]);
+				ready[chunk % window] = false;
+				written = chunk + 1;
+				changed.notify_all();
+			}
+			sink.write(str.data(), str.size());
+		}
+		const char close = is(json_data_type::object) ? '}' : ']';
+		sink.write(&close, 1);
+	}
+
+	////////////////////////////////////////////////////////////////
+	std::string Json::dump_parallel(const parallel_options& parallel) const
+	{
+		if (dump_threads(*this, parallel) < 2)
+			return dump();
+		std::string str;
+		string_sink sink(str);
+		dump_parallel(sink, parallel);
+		return str;
+	}
+}
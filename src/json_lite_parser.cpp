@@ -0,0 +1,53 @@
+#include "json_lite.hpp"
+#include "json_lite_parser.hpp"
+
+// The reusable parser: the internal parser lives as long as the `json_parser`, so its stacks
+// and buffers keep their capacity between calls.
+
+namespace json_lite
+{
+	using namespace detail;
+
+	struct json_parser::impl
+	{
+		explicit impl(const parse_options& options) :
+			options(options),
+			parser(this->options)
+		{
+		}
+
+		const parse_options options;
+		detail::parser<status_policy> parser;
+	};
+
+	////////////////////////////////////////////////////////////////
+	json_parser::json_parser(const parse_options& options) :
+		m_impl(new impl(options))
+	{
+	}
+
+	////////////////////////////////////////////////////////////////
+	json_parser::~json_parser() = default;
+
+	////////////////////////////////////////////////////////////////
+	parse_result json_parser::parse(const char* begin, const char* end, Json& out)
+	{
+		return parse_document(m_impl->parser, begin, end, out);
+	}
+
+	////////////////////////////////////////////////////////////////
+	Json json_parser::parse(const char* begin, const char* end)
+	{
+		Json json;
+		const parse_result result = parse(begin, end, json);
+		if (!result)
+			JSON_LITE_THROW(Json::parsing_error(to_string(result.error)));
+		return json;
+	}
+
+	////////////////////////////////////////////////////////////////
+	const parse_options& json_parser::options() const
+	{
+		return m_impl->options;
+	}
+}
@@ -0,0 +1,671 @@
+#pragma once
+
+// The JSON text parser, shared between the translation units of the library, not part of the public API.
+
+#include "json_lite.hpp"
+#include "json_lite_internal.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+namespace json_lite
+{
+	namespace detail
+	{
+		inline const char* skip_whitespace(const char* p, const char* end)
+		{
+			while (p != end && isspace(static_cast<unsigned char>(*p)))
+				++p;
+			return p;
+		}
+
+		inline bool matches_literal(const char* begin, const char* end, const char* literal, size_t size)
+		{
+			return static_cast<size_t>(end - begin) >= size && strncmp(begin, literal, size) == 0;
+		}
+
+		// checks if [begin, end) is a number of the JSON grammar, without the leniencies of the parser
+		inline bool is_strict_number(const char* p, const char* end)
+		{
+			if (p != end && *p == '-')
+				++p;
+			if (p == end || !isdigit(static_cast<unsigned char>(*p)))
+				return false;
+			if (*p++ != '0')
+				while (p != end && isdigit(static_cast<unsigned char>(*p)))
+					++p;
+			if (p != end && *p == '.')
+			{
+				if (++p == end || !isdigit(static_cast<unsigned char>(*p)))
+					return false;
+				while (p != end && isdigit(static_cast<unsigned char>(*p)))
+					++p;
+			}
+			if (p != end && (*p == 'e' || *p == 'E'))
+			{
+				if (++p != end && (*p == '+' || *p == '-'))
+					++p;
+				if (p == end || !isdigit(static_cast<unsigned char>(*p)))
+					return false;
+				while (p != end && isdigit(static_cast<unsigned char>(*p)))
+					++p;
+			}
+			return p == end;
+		}
+
+		// The JSON tokenizer, parses the scalar tokens.
+		// `ErrorPolicy` decides how errors are reported (see `throwing_policy` and `status_policy`).
+		// Every function returns the position right after the parsed token, or
+		// whatever `ErrorPolicy::fail()` returns on error.
+		template <class ErrorPolicy>
+		class tokenizer : public ErrorPolicy
+		{
+		public:
+
+			explicit tokenizer(const parse_limits& limits) : m_limits(limits) {}
+
+			// parse a scalar value (null, boolean, number or string) starting at `begin`
+			// `begin` must not be at the end of the input
+			const char* parse_scalar(const char* begin, const char* end, Json& obj)
+			{
+				switch (*begin)
+				{
+				case 'n':
+					return parse_json_null(begin, end, obj);
+				case 't':
+				case 'f':
+					return parse_json_boolean(begin, end, obj);
+				case '"':
+				{
+					std::string str;
+					const char* p = parse_json_string(begin, end, str);
+					if (!ErrorPolicy::failed(p))
+					{
+						JSON_LITE_STAT_ADD(bytes_allocated, str.capacity());
+						obj = std::move(str);
+					}
+					return p;
+				}
+				case '-':
+				case '.':
+				case '0': case '1': case '2': case '3': case '4':
+				case '5': case '6': case '7': case '8': case '9':
+					return parse_json_number(begin, end, obj);
+				default:
+					return this->fail(parse_error::unexpected_character, begin);
+				}
+			}
+
+			// parse a string starting at the opening quote and append its content to `str`
+			const char* parse_json_string(const char* begin, const char* end, std::string& str)
+			{
+				const char* start = begin;
+				++begin; // skip the opening quote
+				const char* p = begin;
+				while (p != end)
+				{
+					if (*p == '\"')
+					{
+						if (str.size() + (p - begin) > m_limits.max_string_length)
+							return this->fail(parse_error::string_too_long, start);
+						str.append(begin, p);
+						return p + 1;
+					}
+					else if (*p == '\\')
+					{
+						if (str.size() + (p - begin) + 1 > m_limits.max_string_length)
+							return this->fail(parse_error::string_too_long, start);
+						str.append(begin, p);
+						++p;
+						if (p == end)
+							return this->fail(parse_error::unexpected_end, p);
+						switch (*p)
+						{
+						case '\"':
+							str.push_back('\"');
+							break;
+						case '\\':
+							str.push_back('\\');
+							break;
+						case '/':
+							str.push_back('/');
+							break;
+						case 'b':
+							str.push_back('\b');
+							break;
+						case 'f':
+							str.push_back('\f');
+							break;
+						case 'n':
+							str.push_back('\n');
+							break;
+						case 'r':
+							str.push_back('\r');
+							break;
+						case 't':
+							str.push_back('\t');
+							break;
+						case 'u':
+							return this->fail(parse_error::unsupported_unicode, p - 1);
+						default:
+							return this->fail(parse_error::invalid_escape, p - 1);
+						}
+						++p;
+						begin = p;
+					}
+					else
+					{
+						++p;
+					}
+				}
+				return this->fail(parse_error::unexpected_end, p);
+			}
+
+		protected:
+
+			const parse_limits& m_limits;
+			bool m_raw_numbers = false; // see `parse_options::raw_numbers`
+
+		private:
+
+			const char* parse_json_null(const char* begin, const char* end, Json& obj)
+			{
+				if (!matches_literal(begin, end, "null", 4))
+					return this->fail(parse_error::invalid_literal, begin);
+				obj = nullptr;
+				return begin + 4;
+			}
+
+			const char* parse_json_boolean(const char* begin, const char* end, Json& obj)
+			{
+				if (matches_literal(begin, end, "true", 4))
+				{
+					obj = true;
+					return begin + 4;
+				}
+
+				if (matches_literal(begin, end, "false", 5))
+				{
+					obj = false;
+					return begin + 5;
+				}
+
+				return this->fail(parse_error::invalid_literal, begin);
+			}
+
+			const char* parse_json_number(const char* begin, const char* end, Json& obj)
+			{
+				JSON_LITE_PROBE(number);
+				const char* p = begin;
+				bool is_float = false;
+				if (*p == '-')
+					++p;
+				while (p != end)
+				{
+					if (*p == '.')
+						is_float = true;
+					else if (*p == 'e' || *p == 'E')
+					{
+						is_float = true;
+						if (p + 1 != end && (p[1] == '+' || p[1] == '-'))
+							++p;
+					}
+					else if (!isdigit(static_cast<unsigned char>(*p)))
+						break;
+					++p;
+				}
+
+				if (m_raw_numbers && is_strict_number(begin, p))
+				{
+					obj = Json(json_raw_number(std::string(begin, p)));
+					return p;
+				}
+
+				// the input is not required to be null terminated, so we convert
+				// from a terminated copy of the number
+				const size_t size = p - begin;
+				char buffer[64];
+				std::string long_buffer;
+				const char* str = buffer;
+				if (size < sizeof(buffer))
+				{
+					memcpy(buffer, begin, size);
+					buffer[size] = '\0';
+				}
+				else
+				{
+					long_buffer.assign(begin, p);
+					str = long_buffer.c_str();
+				}
+
+				char* str_end = nullptr;
+				if (!is_float)
+				{
+					errno = 0;
+					const long long value = strtoll(str, &str_end, 10);
+					if (str_end == str + size && errno != ERANGE)
+					{
+						obj = (Json::Int)value;
+						return p;
+					}
+					// out of range integers are stored as floating point
+				}
+				const double value = strtod(str, &str_end);
+				if (size == 0 || str_end != str + size)
+					return this->fail(parse_error::invalid_number, begin);
+				obj = (Json::Float)value;
+				return p;
+			}
+		};
+
+		// an open array or object while parsing
+		struct parse_frame
+		{
+			Json* container; // the container, if it is not on the element stack
+			size_t slot;     // the index of the container on the element stack, or `no_slot`
+			size_t first;    // arrays: the index of the first element on the element stack (recycling: the number of elements parsed)
+			                 // objects when recycling: the index of the first parsed member on the member stack
+			bool is_object;
+		};
+
+		const size_t no_slot = static_cast<size_t>(-1);
+
+		// The JSON parser.
+		// This is an iterative state machine: open arrays and objects are kept on an
+		// explicit heap allocated stack instead of recursing, so hostile inputs
+		// like `[[[[...` cannot overflow the call stack, they can only hit `parse_limits::max_depth`.
+		// The elements of the open arrays are collected on a shared element stack and moved
+		// into an exactly sized vector when the array is closed: every array costs a single
+		// allocation of the right size instead of a chain of reallocations as it grows.
+		// This is also where homogeneous numeric arrays are packed, if requested.
+		// When recycling (`parse_options::recycle`) the arrays and objects already in the output are
+		// parsed into directly instead: elements and members are reused and the leftovers removed.
+		template <class ErrorPolicy>
+		class parser : public tokenizer<ErrorPolicy>
+		{
+		public:
+
+			explicit parser(const parse_options& options) :
+				tokenizer<ErrorPolicy>(options),
+				m_pack_numeric_arrays(options.pack_numeric_arrays),
+				m_recycle(options.recycle)
+			{
+				this->m_raw_numbers = options.raw_numbers;
+			}
+
+			// parse a JSON value into `out`, returns the position right after the value
+			const char* parse(const char* begin, const char* end, Json& out)
+			{
+				JSON_LITE_PROBE(parse);
+				const parse_limits& limits = this->m_limits;
+				if (static_cast<size_t>(end - begin) > limits.max_input_size)
+					return this->fail(parse_error::input_too_large, begin + limits.max_input_size);
+
+				enum class state { value, key, after_value };
+
+				m_frames.clear();
+				m_elements.clear();
+				m_members.clear();
+				size_t nodes = 0;
+				Json* target = &out;
+				size_t target_slot = no_slot;
+				const char* p = begin;
+				state s = state::value;
+				while (true)
+				{
+					switch (s)
+					{
+					case state::value:
+						// parse a value into `target`
+						if (++nodes > limits.max_nodes)
+							return this->fail(parse_error::node_limit_exceeded, p);
+						p = skip_whitespace(p, end);
+						if (p == end)
+							return this->fail(parse_error::unexpected_end, p);
+						if (*p == '[' || *p == '{')
+						{
+							const bool is_object = *p == '{';
+							if (m_frames.size() >= limits.max_depth)
+								return this->fail(parse_error::depth_limit_exceeded, p);
+							if (m_recycle)
+								open_recycled(*target, is_object);
+							else
+							{
+								if (is_object)
+									*target = Json::make_object_t();
+								m_frames.push_back({ target_slot == no_slot ? target : nullptr, target_slot, m_elements.size(), is_object });
+							}
+							p = skip_whitespace(p + 1, end);
+							if (p != end && *p == (is_object ? '}' : ']'))
+							{
+								// empty container
+								close_container();
+								++p;
+								s = state::after_value;
+							}
+							else if (is_object)
+								s = state::key;
+							else
+								target = next_element(target_slot);
+						}
+						else
+						{
+							if (m_recycle && *p == '\"' && target->is(json_data_type::string))
+							{
+								// reuse the buffer of the string
+								std::string& str = target->get<json_data_type::string>();
+								str.clear();
+								p = this->parse_json_string(p, end, str);
+							}
+							else
+								p = this->parse_scalar(p, end, *target);
+							if (ErrorPolicy::failed(p))
+								return p;
+							s = state::after_value;
+						}
+						break;
+
+					case state::key:
+						// parse `"key":` and make `target` the corresponding value
+						p = skip_whitespace(p, end);
+						if (p == end)
+							return this->fail(parse_error::unexpected_end, p);
+						if (*p != '\"')
+							return this->fail(parse_error::unexpected_character, p);
+						m_key.clear();
+						p = this->parse_json_string(p, end, m_key);
+						if (ErrorPolicy::failed(p))
+							return p;
+						p = skip_whitespace(p, end);
+						if (p == end)
+							return this->fail(parse_error::unexpected_end, p);
+						if (*p != ':')
+							return this->fail(parse_error::unexpected_character, p);
+						++p;
+						{
+							Json& object = container(m_frames.back());
+							if (m_recycle)
+								target = &recycled_member(object.get<json_data_type::object>());
+							else
+							{
+								target = &object.get<json_data_type::object>()[std::move(m_key)];
+								JSON_LITE_STAT_ADD(map_insertions, 1);
+							}
+						}
+						target_slot = no_slot;
+						s = state::value;
+						break;
+
+					case state::after_value:
+						// a value was just completed, continue or close the current container
+						if (m_frames.empty())
+							return p;
+						p = skip_whitespace(p, end);
+						if (p == end)
+							return this->fail(parse_error::unexpected_end, p);
+						{
+							const parse_frame& frame = m_frames.back();
+							const char closing = frame.is_object ? '}' : ']';
+							if (*p == ',')
+							{
+								p = skip_whitespace(p + 1, end);
+								if (p != end && *p == closing)
+								{
+									// trailing comma, accepted
+									close_container();
+									++p;
+								}
+								else if (frame.is_object)
+									s = state::key;
+								else
+								{
+									target = next_element(target_slot);
+									s = state::value;
+								}
+							}
+							else if (*p == closing)
+							{
+								close_container();
+								++p;
+							}
+							else
+								return this->fail(parse_error::unexpected_character, p);
+						}
+						break;
+					}
+				}
+			}
+
+			// Parse a part of the content of an array (or object): a comma separated sequence
+			// of values (or `"key": value` members) between `begin` and `end`, appended to
+			// `elements` (or `members`). This is used to parse a container split at its top level commas.
+			// An empty sequence is accepted if `allow_empty`, a final comma if `allow_trailing_comma`.
+			const char* parse_sequence(const char* begin, const char* end, bool is_object, bool allow_empty, bool allow_trailing_comma,
+				std::vector<Json>& elements, std::vector<std::pair<std::string, Json>>& members)
+			{
+				const char* p = skip_whitespace(begin, end);
+				if (p == end)
+					return allow_empty ? p : this->fail(parse_error::unexpected_character, p);
+				while (true)
+				{
+					Json* target;
+					if (is_object)
+					{
+						if (*p != '\"')
+							return this->fail(parse_error::unexpected_character, p);
+						m_key.clear();
+						p = this->parse_json_string(p, end, m_key);
+						if (ErrorPolicy::failed(p))
+							return p;
+						p = skip_whitespace(p, end);
+						if (p == end)
+							return this->fail(parse_error::unexpected_end, p);
+						if (*p != ':')
+							return this->fail(parse_error::unexpected_character, p);
+						++p;
+						members.emplace_back(std::move(m_key), Json());
+						target = &members.back().second;
+					}
+					else
+					{
+						elements.emplace_back();
+						target = &elements.back();
+					}
+
+					p = parse(p, end, *target);
+					if (ErrorPolicy::failed(p))
+						return p;
+					p = skip_whitespace(p, end);
+					if (p == end)
+						return p;
+					if (*p != ',')
+						return this->fail(parse_error::unexpected_character, p);
+					p = skip_whitespace(p + 1, end);
+					if (p == end)
+						return allow_trailing_comma ? p : this->fail(parse_error::unexpected_end, p);
+				}
+			}
+
+		private:
+
+			// the container of an open frame
+			Json& container(const parse_frame& frame)
+			{
+				return frame.slot == no_slot ? *frame.container : m_elements[frame.slot];
+			}
+
+			// adds a new element to the array on top of the stack
+			Json* next_element(size_t& slot)
+			{
+				if (m_recycle)
+				{
+					// the next element of the array itself, an existing one if possible
+					parse_frame& frame = m_frames.back();
+					std::vector<Json>& array = frame.container->get<json_data_type::array>();
+					slot = no_slot;
+					if (frame.first < array.size())
+						return &array[frame.first++];
+					++frame.first;
+					array.emplace_back();
+					return &array.back();
+				}
+				m_elements.emplace_back();
+				slot = m_elements.size() - 1;
+				return &m_elements.back();
+			}
+
+			// closes the container on top of the stack, arrays take their elements from the element stack
+			void close_container()
+			{
+				const parse_frame frame = m_frames.back();
+				m_frames.pop_back();
+				if (m_recycle)
+				{
+					close_recycled(frame);
+					return;
+				}
+				if (frame.is_object)
+					return;
+
+				if (m_pack_numeric_arrays && pack_elements(frame))
+					return;
+
+				std::vector<Json> array;
+				array.reserve(m_elements.size() - frame.first);
+				JSON_LITE_STAT_ADD(bytes_allocated, (m_elements.size() - frame.first) * sizeof(Json));
+				for (size_t i = frame.first; i < m_elements.size(); ++i)
+					array.push_back(std::move(m_elements[i]));
+				m_elements.erase(m_elements.begin() + frame.first, m_elements.end());
+
+				Json& json = container(frame);
+				json = Json::make_array_t();
+				json.get<json_data_type::array>().swap(array);
+			}
+
+			// opens an array or object parsed directly into `json`, reusing it if it has the same type
+			void open_recycled(Json& json, bool is_object)
+			{
+				if (is_object && !json.is(json_data_type::object))
+					json = Json::make_object_t();
+				else if (!is_object && !json.is(json_data_type::array))
+					json = Json::make_array_t();
+				m_frames.push_back({ &json, no_slot, is_object ? m_members.size() : 0, is_object });
+			}
+
+			// the member of a recycled object with the key just parsed, an existing one if possible
+			Json& recycled_member(std::map<std::string, Json>& object)
+			{
+				auto it = object.find(m_key);
+				if (it == object.end())
+				{
+					it = object.emplace(std::move(m_key), Json()).first;
+					JSON_LITE_STAT_ADD(map_insertions, 1);
+				}
+				m_members.push_back(&it->second);
+				return it->second;
+			}
+
+			// removes what was not parsed again from a recycled container
+			void close_recycled(const parse_frame& frame)
+			{
+				Json& json = *frame.container;
+				if (!frame.is_object)
+				{
+					std::vector<Json>& array = json.get<json_data_type::array>();
+					array.erase(array.begin() + frame.first, array.end());
+					if (m_pack_numeric_arrays)
+						json.pack();
+					return;
+				}
+
+				// the parsed members, sorted to find the stale ones (keys may be repeated)
+				std::map<std::string, Json>& object = json.get<json_data_type::object>();
+				const auto first = m_members.begin() + frame.first;
+				std::sort(first, m_members.end(), std::less<const Json*>());
+				const auto last = std::unique(first, m_members.end());
+				if (static_cast<size_t>(last - first) != object.size())
+				{
+					for (auto it = object.begin(); it != object.end();)
+					{
+						if (std::binary_search(first, last, &it->second, std::less<const Json*>()))
+							++it;
+						else
+							it = object.erase(it);
+					}
+				}
+				m_members.erase(first, m_members.end());
+			}
+
+			// stores the elements of a closing array as a packed array, if they are all
+			// integers or all floating point numbers
+			bool pack_elements(const parse_frame& frame)
+			{
+				if (frame.first == m_elements.size())
+					return false;
+				const json_data_type element_type = m_elements[frame.first].data_type();
+				if (element_type != json_data_type::integer && element_type != json_data_type::floating_point)
+					return false;
+				for (size_t i = frame.first + 1; i < m_elements.size(); ++i)
+					if (m_elements[i].data_type() != element_type)
+						return false;
+
+				Json packed;
+				if (element_type == json_data_type::integer)
+				{
+					std::vector<Json::Int> values;
+					values.reserve(m_elements.size() - frame.first);
+					for (size_t i = frame.first; i < m_elements.size(); ++i)
+						values.push_back(m_elements[i].get<json_data_type::integer>());
+					JSON_LITE_STAT_ADD(bytes_allocated, values.size() * sizeof(Json::Int));
+					packed = Json(std::move(values));
+				}
+				else
+				{
+					std::vector<Json::Float> values;
+					values.reserve(m_elements.size() - frame.first);
+					for (size_t i = frame.first; i < m_elements.size(); ++i)
+						values.push_back(m_elements[i].get<json_data_type::floating_point>());
+					JSON_LITE_STAT_ADD(bytes_allocated, values.size() * sizeof(Json::Float));
+					packed = Json(std::move(values));
+				}
+				m_elements.erase(m_elements.begin() + frame.first, m_elements.end());
+				container(frame) = std::move(packed);
+				return true;
+			}
+
+			std::vector<parse_frame> m_frames;
+			std::vector<Json> m_elements;
+			std::vector<const Json*> m_members; // the members parsed into the open recycled objects
+			std::string m_key;
+			bool m_pack_numeric_arrays;
+			bool m_recycle;
+		};
+
+		// parse a whole input into `out`, the implementation of the non-throwing `parse()` functions
+		inline parse_result parse_document(parser<status_policy>& json_parser, const char* begin, const char* end, Json& out)
+		{
+			parse_result result;
+			if (skip_whitespace(begin, end) == end)
+			{
+				result.error = parse_error::empty_input;
+				locate(result, begin, end);
+				return result;
+			}
+
+			const char* last = json_parser.parse(begin, end, out);
+			if (status_policy::failed(last))
+			{
+				result.error = json_parser.error;
+				locate(result, begin, json_parser.where);
+			}
+			else
+				// on success we only report the offset, line and column are left to 0
+				// since computing them would mean scanning the whole input again
+				result.offset = last - begin;
+			return result;
+		}
+	}
+}
@@ -0,0 +1,781 @@
+#include "json_lite.hpp"
+#include "json_lite_internal.hpp"
+
+#include <algorithm>
+
+// JSON Patch (RFC 6902) generation and application, JSON Merge Patch (RFC 7396).
+
+namespace json_lite
+{
+	namespace
+	{
+		// append `/token` to a JSON Pointer (RFC 6901), escaping `~` and `/`
+		void append_token(std::string& path, const std::string& token)
+		{
+			path += '/';
+			for (char c : token)
+			{
+				if (c == '~')
+					path += "~0";
+				else if (c == '/')
+					path += "~1";
+				else
+					path += c;
+			}
+		}
+
+		// Deep equality with the same data types, unlike `operator==` (which compares numbers
+		// by value and packed arrays as generic ones): `diff()` must preserve the serialization.
+		bool equal(const Json& a, const Json& b)
+		{
+			if (&a == &b)
+				return true;
+			if (a.data_type() != b.data_type())
+				return false;
+			switch (a.data_type())
+			{
+			case json_data_type::array:
+			{
+				const auto& x = a.get<json_data_type::array>();
+				const auto& y = b.get<json_data_type::array>();
+				if (x.size() != y.size())
+					return false;
+				for (size_t i = 0; i < x.size(); ++i)
+					if (!equal(x[i], y[i]))
+						return false;
+				return true;
+			}
+			case json_data_type::object:
+			{
+				const auto& x = a.get<json_data_type::object>();
+				const auto& y = b.get<json_data_type::object>();
+				if (x.size() != y.size())
+					return false;
+				for (auto i = x.begin(), j = y.begin(); i != x.end(); ++i, ++j)
+					if (i->first != j->first || !equal(i->second, j->second))
+						return false;
+				return true;
+			}
+			case json_data_type::raw_number:
+				// `1.0` and `1.00` are dumped differently
+				return a.get<json_data_type::raw_number>().text() == b.get<json_data_type::raw_number>().text();
+			default:
+				// same data type, scalars and packed arrays
+				return a == b;
+			}
+		}
+
+		class differ
+		{
+		public:
+
+			differ(const diff_options& options, std::vector<Json>& operations) : m_options(options), m_operations(operations) {}
+
+			// append the operations transforming `a` into `b`, `path` is the pointer to `a`
+			void diff(const Json& a, const Json& b, std::string& path)
+			{
+				if (&a == &b)
+					return;
+				if (a.type() == json_type::array && b.type() == json_type::array)
+				{
+					if (a.data_type() == json_data_type::array && b.data_type() == json_data_type::array)
+						diff_arrays(a.get<json_data_type::array>(), b.get<json_data_type::array>(), path);
+					else if (!equal(a, b))
+					{
+						// packed arrays are compared as generic ones: only their numbers are converted,
+						// a generic array is used in place
+						std::vector<Json> x;
+						std::vector<Json> y;
+						diff_arrays(elements(a, x), elements(b, y), path);
+					}
+					return;
+				}
+				if (a.is(json_data_type::object) && b.is(json_data_type::object))
+				{
+					diff_objects(a.get<json_data_type::object>(), b.get<json_data_type::object>(), path);
+					return;
+				}
+				if (!equal(a, b))
+					add_operation("replace", path, &b);
+			}
+
+		private:
+
+			// the elements of an array, the ones of a packed array are converted into `storage`
+			static const std::vector<Json>& elements(const Json& array, std::vector<Json>& storage)
+			{
+				if (array.is(json_data_type::integer_array))
+					storage.assign(array.get<json_data_type::integer_array>().begin(), array.get<json_data_type::integer_array>().end());
+				else if (array.is(json_data_type::floating_point_array))
+					storage.assign(array.get<json_data_type::floating_point_array>().begin(), array.get<json_data_type::floating_point_array>().end());
+				else
+					return array.get<json_data_type::array>();
+				return storage;
+			}
+
+			void add_operation(const char* op, const std::string& path, const Json* value)
+			{
+				m_operations.push_back(Json::make_object());
+				auto& operation = m_operations.back().get<json_data_type::object>();
+				operation["op"] = Json(op);
+				operation["path"] = Json(path);
+				if (value != nullptr)
+					operation["value"] = *value;
+			}
+
+			// the keys are sorted, a single merge finds the removed, added and common ones
+			void diff_objects(const std::map<std::string, Json>& a, const std::map<std::string, Json>& b, std::string& path)
+			{
+				const size_t length = path.size();
+				auto i = a.begin();
+				auto j = b.begin();
+				while (i != a.end() || j != b.end())
+				{
+					if (j == b.end() || (i != a.end() && i->first < j->first))
+					{
+						append_token(path, i->first);
+						add_operation("remove", path, nullptr);
+						++i;
+					}
+					else if (i == a.end() || j->first < i->first)
+					{
+						append_token(path, j->first);
+						add_operation("add", path, &j->second);
+						++j;
+					}
+					else
+					{
+						append_token(path, i->first);
+						diff(i->second, j->second, path);
+						++i;
+						++j;
+					}
+					path.resize(length);
+				}
+			}
+
+			void diff_arrays(const std::vector<Json>& a, const std::vector<Json>& b, std::string& path)
+			{
+				// common prefix and suffix
+				size_t prefix = 0;
+				while (prefix < a.size() && prefix < b.size() && equal(a[prefix], b[prefix]))
+					++prefix;
+				size_t suffix = 0;
+				while (suffix < a.size() - prefix && suffix < b.size() - prefix && equal(a[a.size() - 1 - suffix], b[b.size() - 1 - suffix]))
+					++suffix;
+				const size_t n = a.size() - prefix - suffix;
+				const size_t m = b.size() - prefix - suffix;
+
+				// the edit script of the middle part: 'k'eep, 'c'hange (a nested diff at the same index), 'r'emove, 'a'dd
+				std::vector<char> script;
+				if (n != 0 && m != 0 && n <= m_options.max_lcs_size / m)
+					lcs_script(a, b, prefix, n, m, script);
+				else
+				{
+					// index by index
+					script.insert(script.end(), n, 'r');
+					script.insert(script.end(), m, 'a');
+				}
+				pair_changes(script);
+
+				const size_t length = path.size();
+				size_t index = prefix; // in the array being patched
+				size_t i = prefix;
+				size_t j = prefix;
+				for (char step : script)
+				{
+					if (step == 'k')
+					{
+						++i;
+						++j;
+						++index;
+						continue;
+					}
+					append_token(path, std::to_string(index));
+					if (step == 'c')
+					{
+						diff(a[i++], b[j++], path);
+						++index;
+					}
+					else if (step == 'r')
+					{
+						add_operation("remove", path, nullptr);
+						++i;
+					}
+					else
+					{
+						add_operation("add", path, &b[j++]);
+						++index;
+					}
+					path.resize(length);
+				}
+			}
+
+			// Between two kept elements the order of the removals and insertions is free:
+			// each removal is paired with an insertion as a change (a nested diff, usually
+			// smaller than replacing the element), then the remaining ones follow.
+			static void pair_changes(std::vector<char>& script)
+			{
+				std::vector<char> paired;
+				paired.reserve(script.size());
+				size_t k = 0;
+				while (k < script.size())
+				{
+					if (script[k] == 'k')
+					{
+						paired.push_back(script[k++]);
+						continue;
+					}
+					size_t removed = 0;
+					size_t added = 0;
+					for (; k < script.size() && script[k] != 'k'; ++k)
+						++(script[k] == 'r' ? removed : added);
+					const size_t changed = std::min(removed, added);
+					paired.insert(paired.end(), changed, 'c');
+					paired.insert(paired.end(), removed - changed, 'r');
+					paired.insert(paired.end(), added - changed, 'a');
+				}
+				script.swap(paired);
+			}
+
+			// the edit script of the longest common subsequence of a[offset, offset + n) and b[offset, offset + m)
+			void lcs_script(const std::vector<Json>& a, const std::vector<Json>& b, size_t offset, size_t n, size_t m, std::vector<char>& script)
+			{
+				std::vector<uint64_t> ha(n);
+				std::vector<uint64_t> hb(m);
+				for (size_t i = 0; i < n; ++i)
+					ha[i] = a[offset + i].hash();
+				for (size_t j = 0; j < m; ++j)
+					hb[j] = b[offset + j].hash();
+				const auto same = [&](size_t i, size_t j) {
+					return ha[i] == hb[j] && equal(a[offset + i], b[offset + j]);
+				};
+
+				// table[i][j]: length of the LCS of the suffixes starting at i and j
+				std::vector<uint32_t> table((n + 1) * (m + 1), 0);
+				for (size_t i = n; i-- > 0;)
+					for (size_t j = m; j-- > 0;)
+						table[i * (m + 1) + j] = same(i, j) ? table[(i + 1) * (m + 1) + j + 1] + 1 :
+							std::max(table[(i + 1) * (m + 1) + j], table[i * (m + 1) + j + 1]);
+
+				size_t i = 0;
+				size_t j = 0;
+				while (i < n || j < m)
+				{
+					if (i < n && j < m && same(i, j))
+					{
+						script.push_back('k');
+						++i;
+						++j;
+					}
+					else if (j == m || (i < n && table[(i + 1) * (m + 1) + j] >= table[i * (m + 1) + j + 1]))
+					{
+						script.push_back('r');
+						++i;
+					}
+					else
+					{
+						script.push_back('a');
+						++j;
+					}
+				}
+			}
+
+			const diff_options& m_options;
+			std::vector<Json>& m_operations;
+		};
+
+		// split a JSON Pointer in its unescaped tokens, returns false if it is not valid
+		bool parse_pointer(const std::string& pointer, std::vector<std::string>& tokens)
+		{
+			if (!pointer.empty() && pointer[0] != '/')
+				return false;
+			for (size_t i = 0; i < pointer.size(); ++i)
+			{
+				char c = pointer[i];
+				if (c == '/')
+				{
+					tokens.emplace_back();
+					continue;
+				}
+				if (c == '~')
+				{
+					if (i + 1 == pointer.size() || (pointer[i + 1] != '0' && pointer[i + 1] != '1'))
+						return false;
+					c = pointer[++i] == '0' ? '~' : '/';
+				}
+				tokens.back() += c;
+			}
+			return true;
+		}
+
+		// an array index token: digits without leading zeros, or `-` (the end) when `allow_end`
+		bool parse_index(const std::string& token, size_t size, bool allow_end, size_t& index)
+		{
+			if (token == "-")
+			{
+				index = size;
+				return allow_end;
+			}
+			if (token.empty() || token.size() > 18 || (token[0] == '0' && token.size() > 1))
+				return false;
+			index = 0;
+			for (char c : token)
+			{
+				if (c < '0' || c > '9')
+					return false;
+				index = index * 10 + static_cast<size_t>(c - '0');
+			}
+			return allow_end ? index <= size : index < size;
+		}
+
+		// number of elements of an array, packed or not
+		size_t array_size(const Json& array)
+		{
+			switch (array.data_type())
+			{
+			case json_data_type::integer_array:
+				return array.get<json_data_type::integer_array>().size();
+			case json_data_type::floating_point_array:
+				return array.get<json_data_type::floating_point_array>().size();
+			default:
+				return array.get<json_data_type::array>().size();
+			}
+		}
+
+		// The value at the first `count` tokens, `nullptr` if it does not exist.
+		// The document is not changed: the elements of packed arrays are numbers (nothing can be
+		// below them), the one found is stored in `element`.
+		const Json* find(const Json& root, const std::vector<std::string>& tokens, size_t count, Json& element)
+		{
+			const Json* json = &root;
+			for (size_t i = 0; i < count; ++i)
+			{
+				size_t index = 0;
+				if (json->is(json_data_type::object))
+				{
+					const auto& object = json->get<json_data_type::object>();
+					const auto it = object.find(tokens[i]);
+					if (it == object.end())
+						return nullptr;
+					json = &it->second;
+				}
+				else if (json->type() != json_type::array || !parse_index(tokens[i], array_size(*json), false, index))
+					return nullptr;
+				else if (json->is(json_data_type::array))
+					json = &json->get<json_data_type::array>()[index];
+				else
+				{
+					element = json->is(json_data_type::integer_array) ? Json(json->get<json_data_type::integer_array>()[index]) :
+						Json(json->get<json_data_type::floating_point_array>()[index]);
+					json = &element;
+				}
+			}
+			return json;
+		}
+
+		// the container at the first `count` tokens to modify, `nullptr` if it does not exist
+		// (it is not below a packed array: their elements are numbers)
+		Json* resolve(Json& root, const std::vector<std::string>& tokens, size_t count)
+		{
+			Json element;
+			const Json* json = find(root, tokens, count, element);
+			return json != &element ? const_cast<Json*>(json) : nullptr;
+		}
+
+		// the value of a patch member, moved out of the patch when it is owned
+		Json take(const Json& value, bool movable)
+		{
+			return movable ? std::move(const_cast<Json&>(value)) : Json(value);
+		}
+
+		// Applies the operations of a JSON Patch. Every change is recorded in an undo log
+		// (the replaced or removed values are moved there, nothing is copied up front) and
+		// `rollback()` restores the document by undoing them in reverse order.
+		class patcher
+		{
+		public:
+
+			explicit patcher(Json& root) : m_root(root) {}
+
+			patch_error apply(const Json& operation, bool movable)
+			{
+				if (!operation.is(json_data_type::object))
+					return patch_error::invalid_operation;
+				const Json* op = member(operation, "op");
+				const Json* path = member(operation, "path");
+				if (op == nullptr || path == nullptr || !op->is(json_data_type::string) || !path->is(json_data_type::string))
+					return patch_error::invalid_operation;
+				const std::string& name = op->get<json_data_type::string>();
+				std::vector<std::string> tokens;
+				if (!parse_pointer(path->get<json_data_type::string>(), tokens))
+					return patch_error::invalid_pointer;
+
+				if (name == "remove")
+					return remove(std::move(tokens), false);
+
+				if (name == "move" || name == "copy")
+				{
+					const Json* from = member(operation, "from");
+					if (from == nullptr || !from->is(json_data_type::string))
+						return patch_error::invalid_operation;
+					std::vector<std::string> from_tokens;
+					if (!parse_pointer(from->get<json_data_type::string>(), from_tokens))
+						return patch_error::invalid_pointer;
+					Json element;
+					if (name == "copy")
+					{
+						const Json* source = find(m_root, from_tokens, from_tokens.size(), element);
+						if (source == nullptr)
+							return patch_error::path_not_found;
+						return add(std::move(tokens), Json(*source));
+					}
+					if (from_tokens == tokens)
+						return find(m_root, tokens, tokens.size(), element) != nullptr ? patch_error::none : patch_error::path_not_found;
+					if (from_tokens.size() < tokens.size() && std::equal(from_tokens.begin(), from_tokens.end(), tokens.begin()))
+						return patch_error::invalid_move;
+					const patch_error error = remove(std::move(from_tokens), true);
+					if (error != patch_error::none)
+						return error;
+					// the removed value is the one to add, on rollback the removal gets it back
+					const patch_error add_error = add(std::move(tokens), std::move(m_moved));
+					if (add_error != patch_error::none)
+					{
+						m_log.back().value = std::move(m_moved);
+						m_log.back().moved = false;
+					}
+					return add_error;
+				}
+
+				const Json* value = member(operation, "value");
+				if (value == nullptr)
+					return patch_error::invalid_operation;
+				if (name == "add")
+					return add(std::move(tokens), take(*value, movable));
+				if (name == "replace")
+				{
+					Json* target = modify(tokens);
+					if (target == nullptr)
+						return patch_error::path_not_found;
+					log(undo_action::set, std::move(tokens), std::move(*target));
+					*target = take(*value, movable);
+					return patch_error::none;
+				}
+				if (name == "test")
+				{
+					Json element;
+					const Json* target = find(m_root, tokens, tokens.size(), element);
+					if (target == nullptr)
+						return patch_error::path_not_found;
+					return *target == *value ? patch_error::none : patch_error::test_failed;
+				}
+				return patch_error::invalid_operation;
+			}
+
+			void rollback()
+			{
+				// the value displaced by an undone `move` destination goes back to its source
+				Json displaced;
+				for (auto it = m_log.rbegin(); it != m_log.rend(); ++it)
+				{
+					if (it->action == undo_action::pack)
+					{
+						// the array is back to the elements it had when it was unpacked
+						Json& array = *resolve(m_root, it->path, it->path.size());
+						if (!array.pack())
+							array = std::move(it->value); // an empty packed array
+						continue;
+					}
+					if (it->moved)
+						it->value = std::move(displaced);
+					displaced = undo(*it);
+				}
+				m_log.clear();
+			}
+
+		private:
+
+			enum class undo_action { set, erase, insert, pack };
+
+			struct undo_entry
+			{
+				undo_action action;
+				std::vector<std::string> path; // the parent is resolved again, pointers may be stale
+				Json value;                    // the value to restore for `set` and `insert`, an empty packed array for `pack`
+				bool moved;                    // the value is the one displaced when undoing the next entry (a `move`)
+			};
+
+			static const Json* member(const Json& object, const char* key)
+			{
+				const auto& members = object.get<json_data_type::object>();
+				const auto it = members.find(key);
+				return it != members.end() ? &it->second : nullptr;
+			}
+
+			void log(undo_action action, std::vector<std::string>&& path, Json&& value, bool moved = false)
+			{
+				m_log.push_back({ action, std::move(path), std::move(value), moved });
+			}
+
+			// the elements of an array to modify: a packed array is unpacked, `rollback()` packs it again
+			std::vector<Json>& elements(Json& array, const std::vector<std::string>& tokens, size_t count)
+			{
+				if (array.is_packed())
+				{
+					Json empty = array.is(json_data_type::integer_array) ? Json(std::vector<Json::Int>()) : Json(std::vector<Json::Float>());
+					array.unpack();
+					log(undo_action::pack, std::vector<std::string>(tokens.begin(), tokens.begin() + count), std::move(empty));
+				}
+				return array.get<json_data_type::array>();
+			}
+
+			// the value at `tokens` to replace, `nullptr` if it does not exist
+			Json* modify(const std::vector<std::string>& tokens)
+			{
+				if (tokens.empty())
+					return &m_root;
+				Json* parent = resolve(m_root, tokens, tokens.size() - 1);
+				if (parent == nullptr)
+					return nullptr;
+				if (parent->is(json_data_type::object))
+				{
+					auto& object = parent->get<json_data_type::object>();
+					const auto it = object.find(tokens.back());
+					return it != object.end() ? &it->second : nullptr;
+				}
+				size_t index = 0;
+				if (parent->type() != json_type::array || !parse_index(tokens.back(), array_size(*parent), false, index))
+					return nullptr;
+				return &elements(*parent, tokens, tokens.size() - 1)[index];
+			}
+
+			patch_error add(std::vector<std::string>&& tokens, Json&& value)
+			{
+				if (tokens.empty())
+				{
+					log(undo_action::set, std::move(tokens), std::move(m_root));
+					m_root = std::move(value);
+					return patch_error::none;
+				}
+				Json* parent = resolve(m_root, tokens, tokens.size() - 1);
+				if (parent == nullptr)
+					return patch_error::path_not_found;
+				if (parent->is(json_data_type::object))
+				{
+					auto& object = parent->get<json_data_type::object>();
+					const auto it = object.find(tokens.back());
+					if (it != object.end())
+					{
+						log(undo_action::set, std::move(tokens), std::move(it->second));
+						it->second = std::move(value);
+					}
+					else
+					{
+						object.emplace(tokens.back(), std::move(value));
+						log(undo_action::erase, std::move(tokens), Json());
+					}
+					return patch_error::none;
+				}
+				size_t index = 0;
+				if (parent->type() != json_type::array || !parse_index(tokens.back(), array_size(*parent), true, index))
+					return patch_error::path_not_found;
+				auto& array = elements(*parent, tokens, tokens.size() - 1);
+				array.insert(array.begin() + index, std::move(value));
+				tokens.back() = std::to_string(index);
+				log(undo_action::erase, std::move(tokens), Json());
+				return patch_error::none;
+			}
+
+			// removes the value, keeping it in `m_moved` for `move` instead of the undo log
+			patch_error remove(std::vector<std::string>&& tokens, bool move)
+			{
+				if (tokens.empty())
+					return patch_error::path_not_found; // the document itself cannot be removed
+				Json* parent = resolve(m_root, tokens, tokens.size() - 1);
+				if (parent == nullptr)
+					return patch_error::path_not_found;
+				Json removed;
+				undo_action action;
+				if (parent->is(json_data_type::object))
+				{
+					auto& object = parent->get<json_data_type::object>();
+					const auto it = object.find(tokens.back());
+					if (it == object.end())
+						return patch_error::path_not_found;
+					removed = std::move(it->second);
+					object.erase(it);
+					action = undo_action::set;
+				}
+				else if (parent->type() == json_type::array)
+				{
+					size_t index = 0;
+					if (!parse_index(tokens.back(), array_size(*parent), false, index))
+						return patch_error::path_not_found;
+					auto& array = elements(*parent, tokens, tokens.size() - 1);
+					removed = std::move(array[index]);
+					array.erase(array.begin() + index);
+					action = undo_action::insert;
+				}
+				else
+					return patch_error::path_not_found;
+				if (move)
+				{
+					m_moved = std::move(removed);
+					log(action, std::move(tokens), Json(), true);
+				}
+				else
+					log(action, std::move(tokens), std::move(removed));
+				return patch_error::none;
+			}
+
+			// undoes a change, returns the value it displaced
+			Json undo(undo_entry& entry)
+			{
+				Json displaced;
+				if (entry.path.empty())
+				{
+					displaced = std::move(m_root);
+					m_root = std::move(entry.value);
+					return displaced;
+				}
+				Json& parent = *resolve(m_root, entry.path, entry.path.size() - 1);
+				const std::string& token = entry.path.back();
+				if (parent.is(json_data_type::object))
+				{
+					auto& object = parent.get<json_data_type::object>();
+					if (entry.action == undo_action::erase)
+					{
+						const auto it = object.find(token);
+						displaced = std::move(it->second);
+						object.erase(it);
+					}
+					else
+					{
+						Json& value = object[token];
+						displaced = std::move(value);
+						value = std::move(entry.value);
+					}
+					return displaced;
+				}
+				auto& array = parent.get<json_data_type::array>();
+				size_t index = 0;
+				parse_index(token, array.size(), true, index);
+				if (entry.action == undo_action::erase)
+				{
+					displaced = std::move(array[index]);
+					array.erase(array.begin() + index);
+				}
+				else if (entry.action == undo_action::insert)
+					array.insert(array.begin() + index, std::move(entry.value));
+				else
+				{
+					displaced = std::move(array[index]);
+					array[index] = std::move(entry.value);
+				}
+				return displaced;
+			}
+
+			Json& m_root;
+			std::vector<undo_entry> m_log;
+			Json m_moved;
+		};
+
+		patch_result apply_patch(Json& root, const Json& patch, bool movable)
+		{
+			patch_result result;
+			if (!patch.is(json_data_type::array))
+			{
+				result.error = patch_error::invalid_operation;
+				return result;
+			}
+			patcher applier(root);
+			const auto& operations = patch.get<json_data_type::array>();
+			for (size_t i = 0; i < operations.size(); ++i)
+			{
+				const patch_error error = applier.apply(operations[i], movable);
+				if (error != patch_error::none)
+				{
+					applier.rollback();
+					result.error = error;
+					result.operation = i;
+					break;
+				}
+			}
+			return result;
+		}
+
+		void merge_patch(Json& target, const Json& patch, bool movable)
+		{
+			if (!patch.is(json_data_type::object))
+			{
+				target = take(patch, movable);
+				return;
+			}
+			if (!target.is(json_data_type::object))
+				target = Json::make_object();
+			auto& object = target.get<json_data_type::object>();
+			for (const auto& member : patch.get<json_data_type::object>())
+			{
+				if (member.second.is(json_data_type::null))
+					object.erase(member.first);
+				else
+					merge_patch(object[member.first], member.second, movable);
+			}
+		}
+	}
+
+	////////////////////////////////////////////////////////////////
+	Json Json::diff(const Json& from, const Json& to, const diff_options& options)
+	{
+		Json patch = Json::make_array();
+		std::string path;
+		differ(options, patch.get<json_data_type::array>()).diff(from, to, path);
+		return patch;
+	}
+
+	////////////////////////////////////////////////////////////////
+	patch_result Json::apply_patch(const Json& patch)
+	{
+		return json_lite::apply_patch(*this, patch, false);
+	}
+
+	////////////////////////////////////////////////////////////////
+	patch_result Json::apply_patch(Json&& patch)
+	{
+		return json_lite::apply_patch(*this, patch, true);
+	}
+
+	////////////////////////////////////////////////////////////////
+	void Json::apply_merge_patch(const Json& patch)
+	{
+		merge_patch(*this, patch, false);
+	}
+
+	////////////////////////////////////////////////////////////////
+	void Json::apply_merge_patch(Json&& patch)
+	{
+		merge_patch(*this, patch, true);
+	}
+
+	////////////////////////////////////////////////////////////////
+	const char* to_string(patch_error error)
+	{
+		switch (error)
+		{
+		case patch_error::none:
+			return "no error";
+		case patch_error::invalid_operation:
+			return "invalid operation";
+		case patch_error::invalid_pointer:
+			return "invalid JSON pointer";
+		case patch_error::path_not_found:
+			return "path not found";
+		case patch_error::invalid_move:
+			return "cannot move a value inside itself";
+		case patch_error::test_failed:
+			return "test failed";
+		default:
+			return "unknown error";
+		}
+	}
+}
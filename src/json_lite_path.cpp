@@ -0,0 +1,241 @@
+#include "json_lite.hpp"
+
+// Streaming JSONPath queries.
+// The path is a list of steps, evaluated as a nondeterministic automaton over the tokens of a cursor:
+// each open container keeps the set of steps that its children can match (the states),
+// the children whose set is empty are skipped without being parsed.
+
+namespace json_lite
+{
+	namespace
+	{
+		// parse the selector in brackets at `p`, returns the position after it or nullptr if it is not valid
+		template <class Step>
+		const char* parse_brackets(const char* p, Step& step)
+		{
+			++p; // [
+			if (*p == '*')
+			{
+				step.selector = Step::kind::wildcard;
+				++p;
+			}
+			else if (*p >= '0' && *p <= '9')
+			{
+				step.selector = Step::kind::index;
+				step.index = 0;
+				for (; *p >= '0' && *p <= '9'; ++p)
+				{
+					const size_t digit = static_cast<size_t>(*p - '0');
+					if (step.index > (static_cast<size_t>(-1) - digit) / 10)
+						return nullptr;
+					step.index = step.index * 10 + digit;
+				}
+			}
+			else if (*p == '\'' || *p == '"')
+			{
+				const char quote = *p++;
+				step.selector = Step::kind::name;
+				for (; *p != quote; ++p)
+				{
+					if (*p == '\\')
+						++p;
+					if (*p == '\0')
+						return nullptr;
+					step.name += *p;
+				}
+				++p;
+			}
+			else
+				return nullptr;
+			return *p == ']' ? p + 1 : nullptr;
+		}
+
+		// add `state` to the states from `first` on, if it is not there yet
+		void add_state(std::vector<size_t>& states, size_t first, size_t state)
+		{
+			for (size_t i = first; i < states.size(); ++i)
+				if (states[i] == state)
+					return;
+			states.push_back(state);
+		}
+	}
+
+	////////////////////////////////////////////////////////////////
+	json_path::json_path(const char* expression)
+	{
+		if (!parse(expression, *this))
+			JSON_LITE_THROW(std::invalid_argument(std::string("json_path: invalid expression ") + expression));
+	}
+
+	////////////////////////////////////////////////////////////////
+	bool json_path::parse(const char* expression, json_path& out)
+	{
+		std::vector<step> steps;
+		const char* p = expression;
+		if (*p++ != '$')
+			return false;
+		while (*p != '\0')
+		{
+			step s;
+			s.selector = step::kind::name;
+			s.descendant = false;
+			s.index = 0;
+			if (*p == '.')
+			{
+				s.descendant = *++p == '.';
+				if (s.descendant)
+					++p;
+				if (*p == '[' && s.descendant)
+					p = parse_brackets(p, s);
+				else if (*p == '*')
+				{
+					s.selector = step::kind::wildcard;
+					++p;
+				}
+				else
+				{
+					for (; *p != '\0' && *p != '.' && *p != '['; ++p)
+						s.name += *p;
+					if (s.name.empty())
+						return false;
+				}
+			}
+			else if (*p == '[')
+				p = parse_brackets(p, s);
+			else
+				return false;
+			if (p == nullptr)
+				return false;
+			steps.push_back(std::move(s));
+		}
+		out.m_steps = std::move(steps);
+		return true;
+	}
+
+	////////////////////////////////////////////////////////////////
+	bool json_query::next(Json& out)
+	{
+		while (find())
+		{
+			if (m_cursor.read_value(out))
+				return true;
+			if (!close_array())
+				return false;
+		}
+		return false;
+	}
+
+	////////////////////////////////////////////////////////////////
+	bool json_query::next_raw(const char*& begin, const char*& end)
+	{
+		while (find())
+		{
+			if (m_cursor.read_raw(begin, end))
+				return true;
+			if (!close_array())
+				return false;
+		}
+		return false;
+	}
+
+	////////////////////////////////////////////////////////////////
+	bool json_query::find()
+	{
+		const std::vector<json_path::step>& steps = m_path.m_steps;
+		if (!m_started)
+		{
+			m_started = true;
+			if (steps.empty())
+				return true; // the root
+			const json_token token = m_cursor.next();
+			if (token != json_token::begin_array && token != json_token::begin_object)
+				return false;
+			m_states.assign(1, 0);
+			m_frames.push_back(frame{ 0, 1, 0, token == json_token::begin_object });
+		}
+
+		while (!m_frames.empty())
+		{
+			// the next member or element
+			const std::string* key = nullptr;
+			size_t index = 0;
+			if (m_frames.back().object)
+			{
+				const json_token token = m_cursor.next();
+				if (token == json_token::end_object)
+				{
+					pop();
+					continue;
+				}
+				if (token != json_token::key)
+					return false;
+				key = &m_cursor.string();
+			}
+			else
+				index = m_frames.back().index++;
+
+			// the steps it matches and the ones to apply to its children
+			const size_t children = m_states.size();
+			bool matched = false;
+			for (size_t i = m_frames.back().states_begin; i != m_frames.back().states_end; ++i)
+			{
+				const size_t state = m_states[i];
+				const json_path::step& step = steps[state];
+				const bool selected =
+					step.selector == json_path::step::kind::wildcard ||
+					(step.selector == json_path::step::kind::name && key != nullptr && *key == step.name) ||
+					(step.selector == json_path::step::kind::index && key == nullptr && index == step.index);
+				if (selected)
+				{
+					if (state + 1 == steps.size())
+						matched = true;
+					else
+						add_state(m_states, children, state + 1);
+				}
+				if (step.descendant)
+					add_state(m_states, children, state);
+			}
+			if (matched)
+			{
+				m_states.resize(children);
+				return true;
+			}
+
+			if (m_states.size() == children)
+			{
+				// nothing can match inside it
+				if (!m_cursor.skip_value() && !close_array())
+					return false;
+				continue;
+			}
+			const json_token token = m_cursor.next();
+			if (token == json_token::begin_array || token == json_token::begin_object)
+				m_frames.push_back(frame{ children, m_states.size(), 0, token == json_token::begin_object });
+			else
+			{
+				m_states.resize(children);
+				if (token == json_token::end_array)
+					pop();
+				else if (token == json_token::error)
+					return false;
+			}
+		}
+		return false;
+	}
+
+	////////////////////////////////////////////////////////////////
+	bool json_query::close_array()
+	{
+		if (!m_cursor.result() || m_frames.empty() || m_cursor.next() != json_token::end_array)
+			return false;
+		pop();
+		return true;
+	}
+
+	////////////////////////////////////////////////////////////////
+	void json_query::pop()
+	{
+		m_states.resize(m_frames.back().states_begin);
+		m_frames.pop_back();
+	}
+}
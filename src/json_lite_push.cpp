@@ -0,0 +1,503 @@
+#include "json_lite.hpp"
+#include "json_lite_parser.hpp"
+
+// Push parser over a JSON text fed in chunks.
+// The structure is parsed byte by byte with the grammar of the parser, the scalar tokens are
+// collected (they may be split between chunks) and converted by the tokenizer once complete.
+
+namespace json_lite
+{
+	using namespace detail;
+
+	namespace
+	{
+		// a position in the text, line and column are derived from the beginning of the line
+		struct text_position
+		{
+			size_t offset = 0;
+			size_t line = 1;
+			size_t line_start = 0;
+		};
+
+		void advance(text_position& position, const char* from, const char* to)
+		{
+			const char* p = from;
+			while ((p = static_cast<const char*>(memchr(p, '\n', to - p))) != nullptr)
+			{
+				++p;
+				++position.line;
+				position.line_start = position.offset + (p - from);
+			}
+			position.offset += to - from;
+		}
+
+		bool is_number_character(char c)
+		{
+			return (c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E';
+		}
+	}
+
+	struct json_push_parser::impl
+	{
+		// `start`, `first` (after an opening bracket) and `after_comma` are the places where
+		// a container can still be closed or where the parser counts the next value
+		enum class state { start, value, first, key, colon, after_value, after_comma, string, number, literal, done, failed };
+
+		impl(json_sax& handler, const parse_limits& limits) :
+			handler(handler),
+			limits(limits),
+			scanner(this->limits)
+		{
+		}
+
+		// the position of `p`, in the chunk being fed
+		const text_position& position_at(const char* p)
+		{
+			advance(position, scanned, p);
+			scanned = p;
+			return position;
+		}
+
+		bool fail(parse_error error, const text_position& where)
+		{
+			s = state::failed;
+			result.error = error;
+			result.offset = where.offset;
+			result.line = where.line;
+			result.column = where.offset - where.line_start + 1;
+			return false;
+		}
+
+		bool fail(parse_error error, const char* where)
+		{
+			return fail(error, position_at(where));
+		}
+
+		// an error of the tokenizer inside the current token
+		bool fail_in_token()
+		{
+			text_position where = token_position;
+			advance(where, token.data(), scanner.where);
+			return fail(scanner.error, where);
+		}
+
+		// a value will be parsed, check the node limit
+		bool count_node(const text_position& where)
+		{
+			if (++nodes > limits.max_nodes)
+				return fail(parse_error::node_limit_exceeded, where);
+			return true;
+		}
+
+		char closing() const
+		{
+			return frames.back() ? '}' : ']';
+		}
+
+		void value_done()
+		{
+			if (!frames.empty())
+			{
+				s = state::after_value;
+				return;
+			}
+			s = state::done;
+			result.offset = position.offset;
+		}
+
+		// close the container on top of the stack, `p` is after the closing bracket
+		void close(const char* p)
+		{
+			position_at(p);
+			const bool is_object = frames.back();
+			frames.pop_back();
+			if (is_object)
+				handler.end_object();
+			else
+				handler.end_array();
+			value_done();
+		}
+
+		void begin_token(const char* p, state token_state)
+		{
+			token_position = position_at(p);
+			token.clear();
+			s = token_state;
+		}
+
+		// begin the string (or key) token at the opening quote `p`
+		const char* begin_string(const char* p, bool key)
+		{
+			begin_token(p, state::string);
+			token.push_back('"');
+			is_key = key;
+			string_length = 0;
+			escaped = false;
+			return p + 1;
+		}
+
+		// begin the value starting at `p`, returns the position after what was consumed
+		const char* begin_value(const char* p)
+		{
+			switch (*p)
+			{
+			case '[':
+			case '{':
+			{
+				const bool is_object = *p == '{';
+				if (frames.size() >= limits.max_depth)
+				{
+					fail(parse_error::depth_limit_exceeded, p);
+					return p;
+				}
+				frames.push_back(is_object);
+				if (is_object)
+					handler.begin_object(json_sax::unknown_size);
+				else
+					handler.begin_array(json_sax::unknown_size);
+				s = state::first;
+				return p + 1;
+			}
+			case '"':
+				return begin_string(p, false);
+			case 'n':
+			case 't':
+			case 'f':
+				begin_token(p, state::literal);
+				literal_size = *p == 'f' ? 5 : 4;
+				return p;
+			case '-':
+			case '.':
+			case '0': case '1': case '2': case '3': case '4':
+			case '5': case '6': case '7': case '8': case '9':
+				begin_token(p, state::number);
+				exponent = false;
+				return p;
+			default:
+				fail(parse_error::unexpected_character, p);
+				return p;
+			}
+		}
+
+		// continue the string (or key) token, returns the position after what was consumed
+		const char* read_string(const char* p, const char* end)
+		{
+			while (p != end)
+			{
+				if (escaped)
+				{
+					// the character after a backslash, the escapes are checked here because
+					// the parser stops at the first invalid one
+					escaped = false;
+					switch (*p)
+					{
+					case '"': case '\\': case '/':
+					case 'b': case 'f': case 'n': case 'r': case 't':
+						break;
+					default:
+						token.push_back(*p);
+						scanner.where = token.data() + token.size() - 2;
+						scanner.error = *p == 'u' ? parse_error::unsupported_unicode : parse_error::invalid_escape;
+						fail_in_token();
+						return p;
+					}
+					token.push_back(*p++);
+					continue;
+				}
+
+				const char* q = p;
+				while (q != end && *q != '"' && *q != '\\')
+					++q;
+				string_length += q - p;
+				token.append(p, q);
+				p = q;
+				if (string_length > limits.max_string_length)
+				{
+					fail(parse_error::string_too_long, token_position);
+					return p;
+				}
+				if (p == end)
+					break;
+				if (*p == '\\')
+				{
+					if (++string_length > limits.max_string_length)
+					{
+						fail(parse_error::string_too_long, token_position);
+						return p;
+					}
+					escaped = true;
+					token.push_back(*p++);
+					continue;
+				}
+
+				// the closing quote, the content is reported as it is when there are no escapes
+				token.push_back(*p++);
+				const char* data = token.data() + 1;
+				size_t size = token.size() - 2;
+				if (string_length != size)
+				{
+					string.clear();
+					if (status_policy::failed(scanner.parse_json_string(token.data(), token.data() + token.size(), string)))
+					{
+						fail_in_token();
+						return p;
+					}
+					data = string.data();
+					size = string.size();
+				}
+				if (is_key)
+				{
+					handler.key(data, size);
+					s = state::colon;
+				}
+				else
+				{
+					// the value ends after the quote
+					position_at(p);
+					handler.string_value(data, size);
+					value_done();
+				}
+				return p;
+			}
+			return p;
+		}
+
+		// convert the collected number or literal
+		bool finish_scalar()
+		{
+			if (status_policy::failed(scanner.parse_scalar(token.data(), token.data() + token.size(), scalar)))
+				return fail_in_token();
+			switch (scalar.data_type())
+			{
+			case json_data_type::boolean:
+				handler.boolean_value(scalar.get<json_data_type::boolean>());
+				break;
+			case json_data_type::integer:
+				handler.integer_value(scalar.get<json_data_type::integer>());
+				break;
+			case json_data_type::floating_point:
+				handler.floating_point_value(scalar.get<json_data_type::floating_point>());
+				break;
+			default:
+				handler.null_value();
+				break;
+			}
+			value_done();
+			return true;
+		}
+
+		// continue the number token, the same characters as the tokenizer
+		const char* read_number(const char* p, const char* end)
+		{
+			const char* q = p;
+			for (; q != end; ++q)
+			{
+				if (exponent && (*q == '+' || *q == '-'))
+					exponent = false;
+				else if (is_number_character(*q) || (*q == '-' && q == p && token.empty()))
+					exponent = *q == 'e' || *q == 'E';
+				else
+					break;
+			}
+			token.append(p, q);
+			if (q != end)
+			{
+				position_at(q);
+				finish_scalar();
+			}
+			return q;
+		}
+
+		// continue the literal token, the length of the literal is collected before matching it
+		const char* read_literal(const char* p, const char* end)
+		{
+			while (p != end && token.size() < literal_size)
+				token.push_back(*p++);
+			if (token.size() == literal_size)
+			{
+				position_at(p);
+				finish_scalar();
+			}
+			return p;
+		}
+
+		// process the bytes of a chunk, returns the position after what was consumed
+		const char* process(const char* p, const char* end)
+		{
+			while (p != end && s != state::done && s != state::failed)
+			{
+				switch (s)
+				{
+				case state::string:
+					p = read_string(p, end);
+					continue;
+				case state::number:
+					p = read_number(p, end);
+					continue;
+				case state::literal:
+					p = read_literal(p, end);
+					continue;
+				default:
+					break;
+				}
+
+				p = skip_whitespace(p, end);
+				if (p == end)
+					break;
+				switch (s)
+				{
+				case state::start:
+					if (count_node(item_start))
+						p = begin_value(p);
+					break;
+				case state::value:
+					p = begin_value(p);
+					break;
+				case state::first:
+				case state::after_comma:
+					if (*p == closing())
+					{
+						// empty container or trailing comma
+						close(++p);
+					}
+					else if (frames.back())
+						s = state::key;
+					else if (count_node(position_at(p)))
+						p = begin_value(p);
+					break;
+				case state::key:
+					if (*p != '"')
+					{
+						fail(parse_error::unexpected_character, p);
+						break;
+					}
+					p = begin_string(p, true);
+					break;
+				case state::colon:
+					if (*p != ':')
+					{
+						fail(parse_error::unexpected_character, p);
+						break;
+					}
+					++p;
+					if (count_node(position_at(p)))
+						s = state::value;
+					break;
+				case state::after_value:
+					if (*p == ',')
+					{
+						s = state::after_comma;
+						++p;
+					}
+					else if (*p == closing())
+						close(++p);
+					else
+						fail(parse_error::unexpected_character, p);
+					break;
+				default:
+					break;
+				}
+			}
+			return p;
+		}
+
+		json_sax& handler;
+		const parse_limits limits;
+		tokenizer<status_policy> scanner;
+		state s = state::start;
+		std::vector<bool> frames; // the open containers, true for objects
+		size_t nodes = 0;
+		// the position of `scanned`, the processed part of the current chunk is counted lazily
+		text_position position;
+		const char* scanned = nullptr;
+		text_position item_start;
+		// the token being collected: raw text and where it begins
+		std::string token;
+		text_position token_position;
+		bool is_key = false;
+		bool escaped = false;  // strings: the last character was a backslash
+		bool exponent = false; // numbers: the last character was an exponent, a sign may follow
+		size_t string_length = 0; // strings: the length after unescaping
+		size_t literal_size = 0;
+		std::string string;
+		Json scalar;
+		parse_result result;
+	};
+
+	////////////////////////////////////////////////////////////////
+	json_push_parser::json_push_parser(json_sax& handler, const parse_limits& limits) :
+		m_impl(new impl(handler, limits))
+	{
+	}
+
+	////////////////////////////////////////////////////////////////
+	json_push_parser::~json_push_parser() = default;
+
+	////////////////////////////////////////////////////////////////
+	size_t json_push_parser::feed(const char* data, size_t size)
+	{
+		impl& c = *m_impl;
+		if (c.s == impl::state::done || c.s == impl::state::failed)
+			return 0;
+
+		// the bytes past the input size limit are not processed
+		const size_t available = c.limits.max_input_size - c.position.offset;
+		const char* end = data + (size < available ? size : available);
+		c.scanned = data;
+		const char* p = c.process(data, end);
+		if (p == end && end != data + size && c.s != impl::state::done && c.s != impl::state::failed)
+			c.fail(parse_error::input_too_large, end);
+		c.position_at(p);
+		c.scanned = nullptr;
+		return p - data;
+	}
+
+	////////////////////////////////////////////////////////////////
+	void json_push_parser::finish()
+	{
+		impl& c = *m_impl;
+		switch (c.s)
+		{
+		case impl::state::done:
+		case impl::state::failed:
+			return;
+		case impl::state::start:
+			c.fail(parse_error::empty_input, c.position);
+			return;
+		case impl::state::number:
+		case impl::state::literal:
+			// a number ends with the input, an incomplete literal is invalid
+			if (!c.finish_scalar() || c.s == impl::state::done)
+				return;
+			break;
+		default:
+			break;
+		}
+		c.fail(parse_error::unexpected_end, c.position);
+	}
+
+	////////////////////////////////////////////////////////////////
+	bool json_push_parser::done() const
+	{
+		return m_impl->s == impl::state::done;
+	}
+
+	////////////////////////////////////////////////////////////////
+	const parse_result& json_push_parser::result() const
+	{
+		return m_impl->result;
+	}
+
+	////////////////////////////////////////////////////////////////
+	void json_push_parser::reset()
+	{
+		impl& c = *m_impl;
+		c.s = impl::state::start;
+		c.frames.clear();
+		c.nodes = 0;
+		c.position = text_position();
+		c.item_start = text_position();
+		c.token.clear();
+		c.result = parse_result();
+	}
+}
@@ -0,0 +1,692 @@
+#include "json_lite.hpp"
+#include "json_lite_internal.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+#if defined(__unix__) || defined(__APPLE__)
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+	#define JSON_LITE_MMAP
+#endif
+
+// Snapshot layout:
+//  - header: magic, version, byte order marker, number of nodes and size of the string table
+//  - nodes: 16 bytes each, in breadth first order
+//  - string table: null terminated strings
+// A node is { uint8 data type, 3 reserved bytes, uint32 count, uint64 payload }:
+//  - null, boolean: payload is 0 or 1
+//  - integer, floating point: payload holds the value bits
+//  - string: count is the length, payload the offset in the string table
+//  - array: count is the number of elements, payload the index of the first one
+//  - object: count is the number of members, payload the index of the first key,
+//    keys and values are interleaved and sorted by key
+
+namespace json_lite
+{
+	using namespace detail;
+
+	namespace
+	{
+		const char snapshot_magic[8] = { 'J', 'L', 'S', 'N', 'A', 'P', '\0', '\0' };
+		const uint32_t snapshot_version = 1;
+		const uint32_t snapshot_byte_order = 0x01020304;
+
+		struct snapshot_header
+		{
+			char magic[8];
+			uint32_t version;
+			uint32_t byte_order;
+			uint64_t node_count;
+			uint64_t strings_size;
+		};
+
+		struct snapshot_node
+		{
+			uint8_t type;
+			uint8_t reserved[3];
+			uint32_t count;
+			uint64_t payload;
+		};
+
+		static_assert(sizeof(snapshot_header) == 32, "unexpected snapshot header size");
+		static_assert(sizeof(snapshot_node) == 16, "unexpected snapshot node size");
+
+		// an entry of the breadth first visit: a value, an object key or
+		// the element `index` of a packed array (packed arrays are stored as arrays)
+		struct snapshot_entry
+		{
+			const Json* json;
+			const std::string* key;
+			const Json* packed;
+			size_t index;
+		};
+
+		snapshot_node read_node(const char* p)
+		{
+			// the snapshot might not be aligned if it comes from user memory
+			snapshot_node node;
+			memcpy(&node, p, sizeof(node));
+			return node;
+		}
+
+		// One pass over the nodes, so that a corrupted or hostile image cannot be read out of bounds
+		// or loop: the children of the containers must be assigned in order, after their parent, as
+		// `save_snapshot()` does (every node but the root is the child of exactly one container),
+		// the strings must be null terminated inside the string table and the keys must be strings.
+		bool valid_nodes(const char* nodes, uint64_t node_count, const char* strings, uint64_t strings_size)
+		{
+			uint64_t next_child = 1;
+			for (uint64_t i = 0; i < node_count; ++i)
+			{
+				const snapshot_node node = read_node(nodes + i * sizeof(snapshot_node));
+				switch (node.type)
+				{
+				case static_cast<uint8_t>(json_data_type::null):
+				case static_cast<uint8_t>(json_data_type::boolean):
+				case static_cast<uint8_t>(json_data_type::integer):
+				case static_cast<uint8_t>(json_data_type::floating_point):
+					break;
+				case static_cast<uint8_t>(json_data_type::string):
+					if (node.payload >= strings_size || strings_size - node.payload <= node.count ||
+						strings[node.payload + node.count] != '\0')
+						return false;
+					break;
+				case static_cast<uint8_t>(json_data_type::array):
+				case static_cast<uint8_t>(json_data_type::object):
+				{
+					const uint64_t children = node.type == static_cast<uint8_t>(json_data_type::object) ? uint64_t(node.count) * 2 : node.count;
+					if (node.payload != next_child || node.payload <= i || node_count - node.payload < children)
+						return false;
+					next_child += children;
+					if (node.type == static_cast<uint8_t>(json_data_type::object))
+						for (uint64_t key = node.payload; key < next_child; key += 2)
+							if (read_node(nodes + key * sizeof(snapshot_node)).type != static_cast<uint8_t>(json_data_type::string))
+								return false;
+					break;
+				}
+				default:
+					return false;
+				}
+			}
+			return next_child == node_count;
+		}
+
+		uint32_t checked_count(size_t count)
+		{
+			if (count > 0xffffffff)
+				JSON_LITE_THROW(std::runtime_error("save_snapshot() - container or string too large"));
+			return static_cast<uint32_t>(count);
+		}
+	}
+
+	////////////////////////////////////////////////////////////////
+	void save_snapshot(const Json& json, output_sink& sink)
+	{
+		// breadth first visit, the children of each container are contiguous
+		std::vector<snapshot_entry> entries;
+		entries.push_back({ &json, nullptr, nullptr, 0 });
+		uint64_t strings_size = 0;
+		for (size_t i = 0; i < entries.size(); ++i)
+		{
+			const snapshot_entry entry = entries[i];
+			if (entry.key != nullptr)
+			{
+				strings_size += entry.key->size() + 1;
+				continue;
+			}
+			if (entry.packed != nullptr)
+				continue;
+			switch (entry.json->data_type())
+			{
+			case json_data_type::string:
+				strings_size += entry.json->get<json_data_type::string>().size() + 1;
+				break;
+			case json_data_type::array:
+				for (const Json& value : entry.json->get<json_data_type::array>())
+					entries.push_back({ &value, nullptr, nullptr, 0 });
+				break;
+			case json_data_type::object:
+				for (const auto& pair : entry.json->get<json_data_type::object>())
+				{
+					entries.push_back({ nullptr, &pair.first, nullptr, 0 });
+					entries.push_back({ &pair.second, nullptr, nullptr, 0 });
+				}
+				break;
+			case json_data_type::integer_array:
+				for (size_t j = 0; j < entry.json->get<json_data_type::integer_array>().size(); ++j)
+					entries.push_back({ nullptr, nullptr, entry.json, j });
+				break;
+			case json_data_type::floating_point_array:
+				for (size_t j = 0; j < entry.json->get<json_data_type::floating_point_array>().size(); ++j)
+					entries.push_back({ nullptr, nullptr, entry.json, j });
+				break;
+			default:
+				break;
+			}
+		}
+
+		buffered_sink out(sink);
+
+		snapshot_header header;
+		memcpy(header.magic, snapshot_magic, sizeof(header.magic));
+		header.version = snapshot_version;
+		header.byte_order = snapshot_byte_order;
+		header.node_count = entries.size();
+		header.strings_size = strings_size;
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		// the children are assigned in the same order of the visit
+		uint64_t next_child = 1;
+		uint64_t next_string = 0;
+		for (const snapshot_entry& entry : entries)
+		{
+			snapshot_node node;
+			memset(&node, 0, sizeof(node));
+			if (entry.key != nullptr)
+			{
+				node.type = static_cast<uint8_t>(json_data_type::string);
+				node.count = checked_count(entry.key->size());
+				node.payload = next_string;
+				next_string += entry.key->size() + 1;
+			}
+			else if (entry.packed != nullptr)
+			{
+				if (entry.packed->is(json_data_type::integer_array))
+				{
+					node.type = static_cast<uint8_t>(json_data_type::integer);
+					node.payload = static_cast<uint64_t>(entry.packed->get<json_data_type::integer_array>()[entry.index]);
+				}
+				else
+				{
+					node.type = static_cast<uint8_t>(json_data_type::floating_point);
+					node.payload = double_to_bits(entry.packed->get<json_data_type::floating_point_array>()[entry.index]);
+				}
+			}
+			else
+			{
+				const Json& value = *entry.json;
+				node.type = static_cast<uint8_t>(value.data_type());
+				switch (value.data_type())
+				{
+				case json_data_type::null:
+					break;
+				case json_data_type::boolean:
+					node.payload = value.get<json_data_type::boolean>() ? 1 : 0;
+					break;
+				case json_data_type::integer:
+					node.payload = static_cast<uint64_t>(value.get<json_data_type::integer>());
+					break;
+				case json_data_type::floating_point:
+					node.payload = double_to_bits(value.get<json_data_type::floating_point>());
+					break;
+				case json_data_type::raw_number:
+				{
+					// stored converted, the format has no raw numbers
+					const json_raw_number& number = value.get<json_data_type::raw_number>();
+					node.type = static_cast<uint8_t>(number.is_integer() ? json_data_type::integer : json_data_type::floating_point);
+					node.payload = number.is_integer() ? static_cast<uint64_t>(number.integer()) : double_to_bits(number.floating_point());
+					break;
+				}
+				case json_data_type::string:
+					node.count = checked_count(value.get<json_data_type::string>().size());
+					node.payload = next_string;
+					next_string += node.count + 1;
+					break;
+				case json_data_type::array:
+					node.count = checked_count(value.get<json_data_type::array>().size());
+					node.payload = next_child;
+					next_child += node.count;
+					break;
+				case json_data_type::object:
+					node.count = checked_count(value.get<json_data_type::object>().size());
+					node.payload = next_child;
+					next_child += uint64_t(node.count) * 2;
+					break;
+				case json_data_type::integer_array:
+				case json_data_type::floating_point_array:
+					node.type = static_cast<uint8_t>(json_data_type::array);
+					node.count = checked_count(value.is(json_data_type::integer_array) ?
+						value.get<json_data_type::integer_array>().size() :
+						value.get<json_data_type::floating_point_array>().size());
+					node.payload = next_child;
+					next_child += node.count;
+					break;
+				}
+			}
+			out.write(reinterpret_cast<const char*>(&node), sizeof(node));
+		}
+
+		// string table, same order
+		for (const snapshot_entry& entry : entries)
+		{
+			const std::string* str = entry.key;
+			if (str == nullptr && entry.json != nullptr && entry.json->is(json_data_type::string))
+				str = &entry.json->get<json_data_type::string>();
+			if (str != nullptr)
+				out.write(str->c_str(), str->size() + 1);
+		}
+	}
+
+	namespace
+	{
+		// an `output_sink` writing to a file
+		class file_sink : public output_sink
+		{
+		public:
+			explicit file_sink(FILE* file) : m_file(file), m_ok(true) {}
+
+			void write(const char* data, size_t size) override
+			{
+				if (m_ok && fwrite(data, 1, size, m_file) != size)
+					m_ok = false;
+			}
+
+			bool ok() const { return m_ok; }
+
+		private:
+			FILE* m_file;
+			bool m_ok;
+		};
+	}
+
+	////////////////////////////////////////////////////////////////
+	bool save_snapshot(const Json& json, const char* path)
+	{
+		FILE* file = fopen(path, "wb");
+		if (file == nullptr)
+			return false;
+		file_sink sink(file);
+		save_snapshot(json, sink);
+		const bool ok = sink.ok();
+		return fclose(file) == 0 && ok;
+	}
+
+	// ================================================================
+	//                            snapshot
+	// ================================================================
+
+	////////////////////////////////////////////////////////////////
+	snapshot::snapshot(const char* path)
+	{
+		if (!open(path))
+			JSON_LITE_THROW(std::runtime_error("snapshot::open() - cannot load snapshot"));
+	}
+
+	////////////////////////////////////////////////////////////////
+	snapshot::snapshot(const char* data, size_t size) : snapshot(data, size, true)
+	{
+	}
+
+	////////////////////////////////////////////////////////////////
+	snapshot::snapshot(const char* data, size_t size, bool check_nodes)
+	{
+		if (!open(data, size, check_nodes))
+			JSON_LITE_THROW(std::runtime_error("snapshot::open() - invalid snapshot"));
+	}
+
+	////////////////////////////////////////////////////////////////
+	snapshot::~snapshot()
+	{
+		close();
+	}
+
+	////////////////////////////////////////////////////////////////
+	bool snapshot::open(const char* path)
+	{
+		close();
+#ifdef JSON_LITE_MMAP
+		const int fd = ::open(path, O_RDONLY);
+		if (fd < 0)
+			return false;
+		struct stat info;
+		if (fstat(fd, &info) != 0 || info.st_size <= 0)
+		{
+			::close(fd);
+			return false;
+		}
+		const size_t size = static_cast<size_t>(info.st_size);
+		void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		if (mapping == MAP_FAILED)
+			return false;
+		if (!open(static_cast<const char*>(mapping), size))
+		{
+			munmap(mapping, size);
+			return false;
+		}
+		m_mapping = mapping;
+		return true;
+#else
+		FILE* file = fopen(path, "rb");
+		if (file == nullptr)
+			return false;
+		std::vector<char> buffer;
+		char block[512];
+		size_t n;
+		while ((n = fread(block, 1, sizeof(block), file)) != 0)
+			buffer.insert(buffer.end(), block, block + n);
+		fclose(file);
+		if (buffer.empty() || !open(buffer.data(), buffer.size()))
+			return false;
+		// the vector buffer does not move when the vector is moved
+		m_buffer = std::move(buffer);
+		return true;
+#endif
+	}
+
+	////////////////////////////////////////////////////////////////
+	bool snapshot::open(const char* data, size_t size)
+	{
+		return open(data, size, true);
+	}
+
+	////////////////////////////////////////////////////////////////
+	bool snapshot::open(const char* data, size_t size, bool check_nodes)
+	{
+		close();
+		if (size < sizeof(snapshot_header))
+			return false;
+		snapshot_header header;
+		memcpy(&header, data, sizeof(header));
+		if (memcmp(header.magic, snapshot_magic, sizeof(header.magic)) != 0 ||
+			header.version != snapshot_version ||
+			header.byte_order != snapshot_byte_order ||
+			header.node_count == 0)
+			return false;
+		const uint64_t available = size - sizeof(header);
+		if (header.node_count > available / sizeof(snapshot_node) ||
+			header.strings_size != available - header.node_count * sizeof(snapshot_node))
+			return false;
+		const char* nodes = data + sizeof(header);
+		if (check_nodes && !valid_nodes(nodes, header.node_count, nodes + header.node_count * sizeof(snapshot_node), header.strings_size))
+			return false;
+
+		m_data = data;
+		m_size = size;
+		m_nodes = data + sizeof(header);
+		m_node_count = header.node_count;
+		m_strings = m_nodes + header.node_count * sizeof(snapshot_node);
+		m_strings_size = header.strings_size;
+		return true;
+	}
+
+	////////////////////////////////////////////////////////////////
+	void snapshot::close()
+	{
+#ifdef JSON_LITE_MMAP
+		if (m_mapping != nullptr)
+			munmap(m_mapping, m_size);
+#endif
+		m_mapping = nullptr;
+		m_buffer.clear();
+		m_data = nullptr;
+		m_size = 0;
+		m_nodes = nullptr;
+		m_node_count = 0;
+		m_strings = nullptr;
+		m_strings_size = 0;
+	}
+
+	////////////////////////////////////////////////////////////////
+	snapshot_value snapshot::root() const
+	{
+		if (!is_open())
+			JSON_LITE_THROW(std::runtime_error("snapshot::root() - no snapshot loaded"));
+		return snapshot_value(this, 0);
+	}
+
+	////////////////////////////////////////////////////////////////
+	const char* snapshot::node(uint64_t index) const
+	{
+		if (index >= m_node_count)
+			JSON_LITE_THROW(std::runtime_error("snapshot - corrupted snapshot"));
+		return m_nodes + index * sizeof(snapshot_node);
+	}
+
+	////////////////////////////////////////////////////////////////
+	const char* snapshot::string(const char* p, size_t& size) const
+	{
+		const snapshot_node node = read_node(p);
+		if (node.payload >= m_strings_size || m_strings_size - node.payload <= node.count)
+			JSON_LITE_THROW(std::runtime_error("snapshot - corrupted snapshot"));
+		size = node.count;
+		return m_strings + node.payload;
+	}
+
+	// ================================================================
+	//                         snapshot_value
+	// ================================================================
+
+	////////////////////////////////////////////////////////////////
+	json_data_type snapshot_value::data_type() const
+	{
+		const uint8_t type = read_node(m_owner->node(m_index)).type;
+		if (type > static_cast<uint8_t>(json_data_type::object))
+			JSON_LITE_THROW(std::runtime_error("snapshot - corrupted snapshot"));
+		return static_cast<json_data_type>(type);
+	}
+
+	////////////////////////////////////////////////////////////////
+	json_type snapshot_value::type() const
+	{
+		switch (data_type())
+		{
+		case json_data_type::null:
+			return json_type::null;
+		case json_data_type::boolean:
+			return json_type::boolean;
+		case json_data_type::integer:
+		case json_data_type::floating_point:
+			return json_type::number;
+		case json_data_type::string:
+			return json_type::string;
+		case json_data_type::array:
+			return json_type::array;
+		default:
+			return json_type::object;
+		}
+	}
+
+	////////////////////////////////////////////////////////////////
+	size_t snapshot_value::size() const
+	{
+		const json_data_type type = data_type();
+		if (type != json_data_type::string && type != json_data_type::array && type != json_data_type::object)
+			JSON_LITE_THROW(std::runtime_error("snapshot_value::size() - wrong type"));
+		return read_node(m_owner->node(m_index)).count;
+	}
+
+	////////////////////////////////////////////////////////////////
+	snapshot_value snapshot_value::operator[](size_t index) const
+	{
+		if (data_type() != json_data_type::array)
+			JSON_LITE_THROW(std::runtime_error("snapshot_value::operator[]() - wrong type"));
+		return snapshot_value(m_owner, read_node(m_owner->node(m_index)).payload + index);
+	}
+
+	////////////////////////////////////////////////////////////////
+	snapshot_value snapshot_value::at(size_t index) const
+	{
+		if (index >= size())
+			JSON_LITE_THROW(std::out_of_range("snapshot_value::at() - index out of range"));
+		return (*this)[index];
+	}
+
+	namespace
+	{
+		int compare_keys(const char* a, size_t a_size, const char* b, size_t b_size)
+		{
+			// same ordering as std::string::compare
+			const int result = memcmp(a, b, a_size < b_size ? a_size : b_size);
+			if (result != 0)
+				return result;
+			return a_size < b_size ? -1 : (a_size > b_size ? 1 : 0);
+		}
+	}
+
+	////////////////////////////////////////////////////////////////
+	snapshot_value snapshot_value::at(const char* key, size_t size) const
+	{
+		if (data_type() != json_data_type::object)
+			JSON_LITE_THROW(std::runtime_error("snapshot_value::at() - wrong type"));
+		const snapshot_node node = read_node(m_owner->node(m_index));
+		// binary search on the sorted keys
+		uint64_t low = 0;
+		uint64_t high = node.count;
+		while (low < high)
+		{
+			const uint64_t middle = low + (high - low) / 2;
+			size_t middle_size;
+			const char* middle_key = m_owner->string(m_owner->node(node.payload + 2 * middle), middle_size);
+			const int result = compare_keys(middle_key, middle_size, key, size);
+			if (result == 0)
+				return snapshot_value(m_owner, node.payload + 2 * middle + 1);
+			if (result < 0)
+				low = middle + 1;
+			else
+				high = middle;
+		}
+		JSON_LITE_THROW(std::out_of_range("snapshot_value::at() - key not found"));
+	}
+
+	////////////////////////////////////////////////////////////////
+	bool snapshot_value::has_key(const std::string& key) const
+	{
+		if (data_type() != json_data_type::object)
+			JSON_LITE_THROW(std::runtime_error("snapshot_value::has_key() - wrong type"));
+		const snapshot_node node = read_node(m_owner->node(m_index));
+		uint64_t low = 0;
+		uint64_t high = node.count;
+		while (low < high)
+		{
+			const uint64_t middle = low + (high - low) / 2;
+			size_t middle_size;
+			const char* middle_key = m_owner->string(m_owner->node(node.payload + 2 * middle), middle_size);
+			const int result = compare_keys(middle_key, middle_size, key.c_str(), key.size());
+			if (result == 0)
+				return true;
+			if (result < 0)
+				low = middle + 1;
+			else
+				high = middle;
+		}
+		return false;
+	}
+
+	////////////////////////////////////////////////////////////////
+	const char* snapshot_value::key(size_t index) const
+	{
+		if (index >= size() || data_type() != json_data_type::object)
+			JSON_LITE_THROW(std::out_of_range("snapshot_value::key() - index out of range"));
+		size_t size;
+		return m_owner->string(m_owner->node(read_node(m_owner->node(m_index)).payload + 2 * index), size);
+	}
+
+	////////////////////////////////////////////////////////////////
+	snapshot_value snapshot_value::value(size_t index) const
+	{
+		if (index >= size() || data_type() != json_data_type::object)
+			JSON_LITE_THROW(std::out_of_range("snapshot_value::value() - index out of range"));
+		return snapshot_value(m_owner, read_node(m_owner->node(m_index)).payload + 2 * index + 1);
+	}
+
+	////////////////////////////////////////////////////////////////
+	snapshot_value::operator bool() const
+	{
+		return data_type() != json_data_type::null;
+	}
+
+	////////////////////////////////////////////////////////////////
+	bool snapshot_value::as_bool() const
+	{
+		if (data_type() != json_data_type::boolean)
+			JSON_LITE_THROW(std::runtime_error("snapshot_value::as_bool() - wrong type"));
+		return read_node(m_owner->node(m_index)).payload != 0;
+	}
+
+	////////////////////////////////////////////////////////////////
+	snapshot_value::operator json_int() const
+	{
+		if (data_type() != json_data_type::integer)
+			JSON_LITE_THROW(std::runtime_error("snapshot_value - wrong type"));
+		return static_cast<json_int>(read_node(m_owner->node(m_index)).payload);
+	}
+
+	////////////////////////////////////////////////////////////////
+	snapshot_value::operator json_float() const
+	{
+		if (data_type() != json_data_type::floating_point)
+			JSON_LITE_THROW(std::runtime_error("snapshot_value - wrong type"));
+		return bits_to_double(read_node(m_owner->node(m_index)).payload);
+	}
+
+	////////////////////////////////////////////////////////////////
+	snapshot_value::operator std::string() const
+	{
+		if (data_type() != json_data_type::string)
+			JSON_LITE_THROW(std::runtime_error("snapshot_value - wrong type"));
+		size_t size;
+		const char* str = m_owner->string(m_owner->node(m_index), size);
+		return std::string(str, size);
+	}
+
+	////////////////////////////////////////////////////////////////
+	snapshot_value::operator const char*() const
+	{
+		if (data_type() != json_data_type::string)
+			JSON_LITE_THROW(std::runtime_error("snapshot_value - wrong type"));
+		size_t size;
+		return m_owner->string(m_owner->node(m_index), size);
+	}
+
+	////////////////////////////////////////////////////////////////
+	Json snapshot_value::to_json() const
+	{
+		switch (data_type())
+		{
+		case json_data_type::null:
+			return Json();
+		case json_data_type::boolean:
+			return Json(as_bool());
+		case json_data_type::integer:
+			return Json(static_cast<json_int>(*this));
+		case json_data_type::floating_point:
+			return Json(static_cast<json_float>(*this));
+		case json_data_type::string:
+			return Json(static_cast<std::string>(*this));
+		case json_data_type::array:
+		{
+			const size_t n = size();
+			std::vector<Json> array;
+			// `open()` checked that the children are nodes of the image, never reserve more than them
+			array.reserve(std::min<size_t>(n, m_owner->m_node_count));
+			for (size_t i = 0; i < n; ++i)
+				array.push_back((*this)[i].to_json());
+			return Json(std::move(array));
+		}
+		default:
+		{
+			const size_t n = size();
+			const uint64_t first = read_node(m_owner->node(m_index)).payload;
+			std::map<std::string, Json> object;
+			for (size_t i = 0; i < n; ++i)
+			{
+				size_t key_size;
+				const char* key = m_owner->string(m_owner->node(first + 2 * i), key_size);
+				// keys are sorted, hint the insertion at the end
+				object.emplace_hint(object.end(), std::string(key, key_size), snapshot_value(m_owner, first + 2 * i + 1).to_json());
+			}
+			return Json(std::move(object));
+		}
+		}
+	}
+
+	////////////////////////////////////////////////////////////////
+	std::string snapshot_value::dump() const
+	{
+		return to_json().dump();
+	}
+}
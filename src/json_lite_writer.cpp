@@ -0,0 +1,153 @@
+#include "json_lite.hpp"
+#include "json_lite_internal.hpp"
+
+// Streaming JSON text writer, the output is the same of `Json::dump()`.
+
+namespace json_lite
+{
+	using namespace detail;
+
+	////////////////////////////////////////////////////////////////
+	void json_writer::before_value()
+	{
+		if (m_stack.empty())
+		{
+			if (m_done)
+				JSON_LITE_THROW(std::runtime_error("json_writer: the document is already complete"));
+			m_done = true;
+			return;
+		}
+		frame& current = m_stack.back();
+		if (current.object)
+		{
+			if (!current.after_key)
+				JSON_LITE_THROW(std::runtime_error("json_writer: a value in an object must follow a key"));
+			current.after_key = false;
+			return;
+		}
+		if (!current.empty)
+			m_out.put(',');
+		current.empty = false;
+	}
+
+	////////////////////////////////////////////////////////////////
+	void json_writer::end_container(bool object)
+	{
+		if (m_stack.empty() || m_stack.back().object != object)
+			JSON_LITE_THROW(std::runtime_error(object ? "json_writer: end_object() without an open object" : "json_writer: end_array() without an open array"));
+		if (m_stack.back().after_key)
+			JSON_LITE_THROW(std::runtime_error("json_writer: a key without a value"));
+		m_stack.pop_back();
+		m_out.put(object ? '}' : ']');
+	}
+
+	////////////////////////////////////////////////////////////////
+	void json_writer::null_value()
+	{
+		before_value();
+		m_out.write("null", 4);
+	}
+
+	////////////////////////////////////////////////////////////////
+	void json_writer::boolean_value(bool value)
+	{
+		before_value();
+		if (value)
+			m_out.write("true", 4);
+		else
+			m_out.write("false", 5);
+	}
+
+	////////////////////////////////////////////////////////////////
+	void json_writer::integer_value(json_int value)
+	{
+		before_value();
+		const std::string str = std::to_string(value);
+		m_out.write(str.data(), str.size());
+	}
+
+	////////////////////////////////////////////////////////////////
+	void json_writer::floating_point_value(json_float value)
+	{
+		before_value();
+		const std::string str = std::to_string(value);
+		m_out.write(str.data(), str.size());
+	}
+
+	////////////////////////////////////////////////////////////////
+	void json_writer::string_value(const char* data, size_t size)
+	{
+		before_value();
+		m_scratch.clear();
+		append_escaped(m_scratch, data, size);
+		m_out.write(m_scratch.data(), m_scratch.size());
+	}
+
+	////////////////////////////////////////////////////////////////
+	void json_writer::begin_array(size_t)
+	{
+		before_value();
+		m_stack.push_back({ false, true, false });
+		m_out.put('[');
+	}
+
+	////////////////////////////////////////////////////////////////
+	void json_writer::end_array()
+	{
+		end_container(false);
+	}
+
+	////////////////////////////////////////////////////////////////
+	void json_writer::begin_object(size_t)
+	{
+		before_value();
+		m_stack.push_back({ true, true, false });
+		m_out.put('{');
+	}
+
+	////////////////////////////////////////////////////////////////
+	void json_writer::before_key()
+	{
+		if (m_stack.empty() || !m_stack.back().object || m_stack.back().after_key)
+			JSON_LITE_THROW(std::runtime_error("json_writer: a key must be written in an object, before its value"));
+		frame& current = m_stack.back();
+		if (!current.empty)
+			m_out.put(',');
+		current.empty = false;
+		current.after_key = true;
+	}
+
+	////////////////////////////////////////////////////////////////
+	void json_writer::key(const char* data, size_t size)
+	{
+		before_key();
+		m_scratch.clear();
+		append_escaped(m_scratch, data, size);
+		m_scratch += ':';
+		m_out.write(m_scratch.data(), m_scratch.size());
+	}
+
+	////////////////////////////////////////////////////////////////
+	void json_writer::clean_key(const char* data, size_t size)
+	{
+		before_key();
+		m_out.put('"');
+		m_out.write(data, size);
+		m_out.write("\":", 2);
+	}
+
+	////////////////////////////////////////////////////////////////
+	void json_writer::end_object()
+	{
+		end_container(true);
+	}
+
+	////////////////////////////////////////////////////////////////
+	void json_writer::value(const Json& json)
+	{
+		before_value();
+		m_scratch.clear();
+		dump_to_string(json, m_scratch);
+		m_out.write(m_scratch.data(), m_scratch.size());
+	}
+}